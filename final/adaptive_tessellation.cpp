@@ -0,0 +1,520 @@
+#include <cassert>
+
+#include "adaptive_tessellation.h"
+#include "check_gl.h"
+#include "render_stats.h"
+#include "shader_programs.h"
+#include "surface.h"
+
+//
+// rebuildIndices() compacts the vertex cache when it holds more than
+// this many times as many vertices as the leaves use
+//
+static const int MAX_VERTEX_CACHE_SLACK = 2;
+
+
+AdaptiveTessellation::AdaptiveTessellation(const Surface *surface_,
+                                           const int nRootsI_,
+                                           const int nRootsJ_,
+                                           const bool wrapI_,
+                                           const bool wrapJ_,
+                                           const double maxScreenError_)
+    : surface(surface_), nRootsI(nRootsI_), nRootsJ(nRootsJ_),
+      wrapI(wrapI_), wrapJ(wrapJ_), maxScreenError(maxScreenError_),
+      isDirty(true)
+{
+    assert(nRootsI > 0 && nRootsJ > 0);
+    for (int j = 0; j < nRootsJ; j++) {
+        for (int i = 0; i < nRootsI; i++)
+            createCell(0, i, j);
+    }
+    allocateBuffers();
+}
+
+
+AdaptiveTessellation::~AdaptiveTessellation()
+{
+    CHECK_GL(glDeleteBuffers(1, &vertexPositionsBufferId));
+    CHECK_GL(glDeleteBuffers(1, &vertexNormalBufferId));
+    CHECK_GL(glDeleteBuffers(1, &indexBufferId));
+}
+
+
+void AdaptiveTessellation::addLeafTriangles(const int level, const int i,
+                                            const int j)
+//
+// helper: appends the triangles of leaf cell (`level`, `i`, `j`) to
+// `vertexIndices`
+//
+{
+    // corners, CCW in (u, v) from (i, j)
+    int corners[4] = {
+        vertex(level, i,     j),
+        vertex(level, i + 1, j),
+        vertex(level, i + 1, j + 1),
+        vertex(level, i,     j + 1),
+    };
+    // the edge that follows each corner (CCW) and that edge's midpoint
+    // (at the next level)
+    static const int edgeDirection[4][2] = {
+        { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 }
+    };
+    static const int edgeMidpoint[4][2] = {
+        { 1, 0 }, { 2, 1 }, { 1, 2 }, { 0, 1 }
+    };
+    int boundary[8];
+    int nBoundary = 0;
+
+    for (int k = 0; k < 4; k++) {
+        boundary[nBoundary++] = corners[k];
+
+        int iNeighbor = i + edgeDirection[k][0];
+        int jNeighbor = j + edgeDirection[k][1];
+        Cell *neighbor = findCell(level, iNeighbor, jNeighbor);
+        if (neighbor && neighbor->isSplit)
+            boundary[nBoundary++] = vertex(level + 1,
+                                           2*i + edgeMidpoint[k][0],
+                                           2*j + edgeMidpoint[k][1]);
+    }
+
+    if (nBoundary == 4) {
+        // two triangles, wound as RegularMesh's strips are
+        const int triangles[2][3] = {
+            { corners[0], corners[2], corners[3] },
+            { corners[0], corners[1], corners[2] },
+        };
+        for (int t = 0; t < 2; t++) {
+            for (int k = 0; k < 3; k++)
+                vertexIndices.push_back(triangles[t][k]);
+        }
+    } else {
+        // a fan around the center that includes the edge midpoints
+        int center = vertex(level + 1, 2*i + 1, 2*j + 1);
+
+        for (int k = 0; k < nBoundary; k++) {
+            vertexIndices.push_back(center);
+            vertexIndices.push_back(boundary[k]);
+            vertexIndices.push_back(boundary[(k + 1) % nBoundary]);
+        }
+    }
+}
+
+
+void AdaptiveTessellation::allocateBuffers(void)
+{
+    CHECK_GL(glGenBuffers(1, &vertexPositionsBufferId));
+    CHECK_GL(glGenBuffers(1, &vertexNormalBufferId));
+    CHECK_GL(glGenBuffers(1, &indexBufferId));
+}
+
+
+const unsigned long long AdaptiveTessellation::cellKey(const int level,
+                                                       const int i,
+                                                       const int j) const
+//
+// helper: returns the key of cell (`level`, `i`, `j`) in `cells`
+//
+{
+    return (static_cast<unsigned long long>(level) << 58)
+        | (static_cast<unsigned long long>(i) << 29)
+        | static_cast<unsigned long long>(j);
+}
+
+
+void AdaptiveTessellation::compactVertices(void)
+//
+// helper: drops the vertices no leaf uses from the vertex cache
+//
+{
+    const int noVertex = -1;
+    vector<int> newIndexOf(vertexPositions.size(), noVertex);
+    vector<unsigned long long> newKeyOfVertex;
+    vector<Point3f> newVertexPositions;
+    vector<Vector3f> newVertexNormals;
+
+    vertexOfKey.clear();
+    for (unsigned int k = 0; k < vertexIndices.size(); k++) {
+        int iVertex = vertexIndices[k];
+
+        if (newIndexOf[iVertex] == noVertex) {
+            newIndexOf[iVertex] = newVertexPositions.size();
+            vertexOfKey[keyOfVertex[iVertex]] = newIndexOf[iVertex];
+            newKeyOfVertex.push_back(keyOfVertex[iVertex]);
+            newVertexPositions.push_back(vertexPositions[iVertex]);
+            newVertexNormals.push_back(vertexNormals[iVertex]);
+        }
+        vertexIndices[k] = newIndexOf[iVertex];
+    }
+    keyOfVertex.swap(newKeyOfVertex);
+    vertexPositions.swap(newVertexPositions);
+    vertexNormals.swap(newVertexNormals);
+}
+
+
+void AdaptiveTessellation::createCell(const int level, const int i,
+                                      const int j)
+//
+// helper: adds leaf cell (`level`, `i`, `j`), estimating its error
+// and bounds
+//
+{
+    Cell cell;
+    const int nPoints = (level < ADAPTIVE_MAX_LEVEL) ? 9 : 4;
+    Point3 p[9];
+
+    p[0] = Point3(vertexPositions[vertex(level, i,     j)]);
+    p[1] = Point3(vertexPositions[vertex(level, i + 1, j)]);
+    p[2] = Point3(vertexPositions[vertex(level, i + 1, j + 1)]);
+    p[3] = Point3(vertexPositions[vertex(level, i,     j + 1)]);
+    cell.error = 0.0;
+    if (nPoints == 9) {
+        //
+        // The error is how far the surface is from the bilinear patch
+        // through the corners at the edge midpoints and the center
+        // (all of which become vertices if the cell is split).
+        //
+        p[4] = Point3(vertexPositions[vertex(level + 1, 2*i + 1, 2*j)]);
+        p[5] = Point3(vertexPositions[vertex(level + 1, 2*i + 2, 2*j + 1)]);
+        p[6] = Point3(vertexPositions[vertex(level + 1, 2*i + 1, 2*j + 2)]);
+        p[7] = Point3(vertexPositions[vertex(level + 1, 2*i,     2*j + 1)]);
+        p[8] = Point3(vertexPositions[vertex(level + 1, 2*i + 1, 2*j + 1)]);
+
+        const Point3 bilinear[5] = {
+            (p[0] + p[1]) / 2.0,
+            (p[1] + p[2]) / 2.0,
+            (p[2] + p[3]) / 2.0,
+            (p[3] + p[0]) / 2.0,
+            (p[0] + p[1] + p[2] + p[3]) / 4.0,
+        };
+        for (int k = 0; k < 5; k++) {
+            double error = (p[4 + k] - bilinear[k]).mag();
+            if (error > cell.error)
+                cell.error = error;
+        }
+    }
+
+    Point3 sum;
+    for (int k = 0; k < nPoints; k++)
+        sum += p[k];
+    cell.center = sum / nPoints;
+    cell.radius = 0.0;
+    for (int k = 0; k < nPoints; k++) {
+        double distance = (p[k] - cell.center).mag();
+        if (distance > cell.radius)
+            cell.radius = distance;
+    }
+    cell.radius += cell.error;
+    cell.isSplit = false;
+
+    cells[cellKey(level, i, j)] = cell;
+}
+
+
+AdaptiveTessellation::Cell *AdaptiveTessellation::findCell(const int level,
+                                                           int i, int j)
+//
+// helper: returns cell (`level`, `i`, `j`) (with `i` and `j` wrapped,
+// if the Surface wraps) or NULL if there's no such cell
+//
+{
+    if (!wrapIndices(level, i, j))
+        return NULL;
+
+    unordered_map<unsigned long long, Cell>::iterator it
+        = cells.find(cellKey(level, i, j));
+    if (it == cells.end())
+        return NULL;
+    return &it->second;
+}
+
+
+void AdaptiveTessellation::merge(const int level, const int i, const int j)
+//
+// helper: makes split cell (`level`, `i`, `j`), whose children are
+// all leaves, a leaf (if that keeps the quadtree restricted)
+//
+{
+    static const int directions[4][2] = {
+        { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 }
+    };
+
+    // A neighbor with split children would be two levels finer.
+    for (int k = 0; k < 4; k++) {
+        int iNeighbor = i + directions[k][0];
+        int jNeighbor = j + directions[k][1];
+        Cell *neighbor = findCell(level, iNeighbor, jNeighbor);
+
+        if (neighbor == NULL || !neighbor->isSplit)
+            continue;
+        wrapIndices(level, iNeighbor, jNeighbor);
+        for (int dj = 0; dj < 2; dj++) {
+            for (int di = 0; di < 2; di++) {
+                if (findCell(level + 1, 2*iNeighbor + di,
+                             2*jNeighbor + dj)->isSplit)
+                    return;
+            }
+        }
+    }
+
+    for (int dj = 0; dj < 2; dj++) {
+        for (int di = 0; di < 2; di++)
+            cells.erase(cellKey(level + 1, 2*i + di, 2*j + dj));
+    }
+    findCell(level, i, j)->isSplit = false;
+    isDirty = true;
+}
+
+
+void AdaptiveTessellation::rebuildIndices(void)
+//
+// helper: recreates `vertexIndices` from the current leaves
+//
+{
+    vertexIndices.clear();
+    for (unordered_map<unsigned long long, Cell>::iterator it = cells.begin();
+         it != cells.end(); ++it) {
+        if (it->second.isSplit)
+            continue;
+
+        const unsigned long long key = it->first;
+        const unsigned long long mask = (1ULL << 29) - 1;
+        addLeafTriangles(key >> 58, (key >> 29) & mask, key & mask);
+    }
+
+    int nVerticesUsed = 0;
+    vector<bool> isUsed(vertexPositions.size(), false);
+    for (unsigned int k = 0; k < vertexIndices.size(); k++) {
+        if (!isUsed[vertexIndices[k]]) {
+            isUsed[vertexIndices[k]] = true;
+            nVerticesUsed++;
+        }
+    }
+    if ((int) vertexPositions.size()
+            > MAX_VERTEX_CACHE_SLACK * nVerticesUsed)
+        compactVertices();
+}
+
+
+const void AdaptiveTessellation::render(void)
+{
+    GLint vpai = ShaderProgram::getCurrentAttributeIndex("vertexPosition");
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
+    CHECK_GL(glEnableVertexAttribArray(vpai));
+    CHECK_GL(glVertexAttribPointer(
+                 vpai, // index of attribute
+                 3, // # of elements per attribute
+                 GL_FLOAT, // type of each component
+                 GL_FALSE,  // don't normalized fixed-point values
+                 0, // offset between consecutive generic vertex attributes
+                 BUFFER_OFFSET(0)));
+
+    GLint vnai = ShaderProgram::getCurrentAttributeIndex("vertexNormal");
+
+    if (vnai != NO_SUCH_ATTRIBUTE) {
+        CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexNormalBufferId));
+        CHECK_GL(glEnableVertexAttribArray(vnai));
+        CHECK_GL(glVertexAttribPointer(
+                     vnai, // index of attribute
+                     3, // # of elements per attribute
+                     GL_FLOAT, // type of each component
+                     GL_FALSE,  // don't normalized fixed-point values
+                     0, // offset between consecutive generic vertex attributes
+                     BUFFER_OFFSET(0)));
+    }
+
+    CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId));
+    CHECK_GL(glDrawElements(GL_TRIANGLES, vertexIndices.size(),
+                            GL_UNSIGNED_INT, BUFFER_OFFSET(0)));
+
+    renderStats.ctVertices += vertexIndices.size();
+    renderStats.ctTrianglesInIndexedMeshes += nTriangles();
+}
+
+
+void AdaptiveTessellation::refine(const int level, const int i, const int j,
+                                  const FrameContext &frameContext,
+                                  const Transform &worldTransform,
+                                  const double worldScale)
+//
+// helper: splits and merges the cells of the quadtree rooted at cell
+// (`level`, `i`, `j`) as the view requires
+//
+{
+    Cell *cell = findCell(level, i, j);
+    double error = screenError(*cell, frameContext, worldTransform,
+                               worldScale);
+
+    if (!cell->isSplit) {
+        if (level == ADAPTIVE_MAX_LEVEL || error <= maxScreenError)
+            return;
+        split(level, i, j);
+    }
+
+    bool childrenAreLeaves = true;
+    for (int dj = 0; dj < 2; dj++) {
+        for (int di = 0; di < 2; di++) {
+            refine(level + 1, 2*i + di, 2*j + dj,
+                   frameContext, worldTransform, worldScale);
+            if (findCell(level + 1, 2*i + di, 2*j + dj)->isSplit)
+                childrenAreLeaves = false;
+        }
+    }
+    if (childrenAreLeaves && error < ADAPTIVE_MERGE_HYSTERESIS * maxScreenError)
+        merge(level, i, j);
+}
+
+
+const double AdaptiveTessellation::screenError(
+    const Cell &cell, const FrameContext &frameContext,
+    const Transform &worldTransform, const double worldScale) const
+//
+// helper: returns the (approximate) error, in pixels, of drawing
+// `cell` as a bilinear patch (0 if the cell isn't visible)
+//
+{
+    Point3 worldCenter = worldTransform * cell.center;
+    double worldRadius = worldScale * cell.radius;
+
+    if (!frameContext.sphereIsVisible(worldCenter, worldRadius))
+        return 0.0;
+
+    // (pixelsPerUnit() is huge if the eye is in the cell's bounding
+    // sphere, so it's refined fully.)
+    return worldScale * cell.error
+        * frameContext.pixelsPerUnit(worldCenter, worldRadius);
+}
+
+
+void AdaptiveTessellation::split(const int level, const int i, const int j)
+//
+// helper: splits leaf cell (`level`, `i`, `j`) into four, first
+// splitting any coarser neighbors so the quadtree stays restricted
+//
+{
+    static const int directions[4][2] = {
+        { 0, -1 }, { 1, 0 }, { 0, 1 }, { -1, 0 }
+    };
+
+    assert(level < ADAPTIVE_MAX_LEVEL);
+    if (level > 0) {
+        for (int k = 0; k < 4; k++) {
+            int iNeighbor = i + directions[k][0];
+            int jNeighbor = j + directions[k][1];
+
+            if (!wrapIndices(level, iNeighbor, jNeighbor))
+                continue; // (on the boundary of the domain)
+            if (findCell(level, iNeighbor, jNeighbor) == NULL)
+                split(level - 1, iNeighbor / 2, jNeighbor / 2);
+        }
+    }
+
+    for (int dj = 0; dj < 2; dj++) {
+        for (int di = 0; di < 2; di++)
+            createCell(level + 1, 2*i + di, 2*j + dj);
+    }
+    findCell(level, i, j)->isSplit = true;
+    isDirty = true;
+}
+
+
+void AdaptiveTessellation::update(const FrameContext &frameContext,
+                                  const Transform &worldTransform)
+//
+// adapts the tessellation to the view in `frameContext` of the
+// Surface, drawn with `worldTransform`, and sends it to the GPU if it
+// has changed
+//
+{
+    double worldScale = worldTransform.maxScale();
+
+    for (int j = 0; j < nRootsJ; j++) {
+        for (int i = 0; i < nRootsI; i++)
+            refine(0, i, j, frameContext, worldTransform, worldScale);
+    }
+    if (isDirty) {
+        rebuildIndices();
+        updateBuffers();
+        isDirty = false;
+    }
+}
+
+
+void AdaptiveTessellation::updateBuffers(void)
+{
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                          sizeof(Point3f) * vertexPositions.size(),
+                          vertexPositions.data(), GL_DYNAMIC_DRAW));
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexNormalBufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                          sizeof(Vector3f) * vertexNormals.size(),
+                          vertexNormals.data(), GL_DYNAMIC_DRAW));
+
+    CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId));
+    CHECK_GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                          sizeof(unsigned int) * vertexIndices.size(),
+                          vertexIndices.data(), GL_DYNAMIC_DRAW));
+}
+
+
+const int AdaptiveTessellation::vertex(const int level, int i, int j)
+//
+// helper: returns the index of the mesh vertex at grid point (`i`,
+// `j`) of `level`, evaluating the Surface there if it isn't cached
+//
+{
+    const int nI = nRootsI << ADAPTIVE_MAX_LEVEL;
+    const int nJ = nRootsJ << ADAPTIVE_MAX_LEVEL;
+
+    // Vertices are identified by their position on the finest grid.
+    i <<= ADAPTIVE_MAX_LEVEL - level;
+    j <<= ADAPTIVE_MAX_LEVEL - level;
+    assert(0 <= i && i <= nI && 0 <= j && j <= nJ);
+    if (wrapI && i == nI)
+        i = 0;
+    if (wrapJ && j == nJ)
+        j = 0;
+
+    unsigned long long key = (static_cast<unsigned long long>(i) << 32) | j;
+    unordered_map<unsigned long long, int>::iterator it
+        = vertexOfKey.find(key);
+    if (it != vertexOfKey.end())
+        return it->second;
+
+    Vector3 tangentU, tangentV;
+    Point3 p = (*surface)(static_cast<double>(i) / nI,
+                          static_cast<double>(j) / nJ, tangentU, tangentV);
+    int iVertex = vertexPositions.size();
+
+    vertexPositions.push_back(Point3f(p));
+    vertexNormals.push_back(Vector3f(tangentV.cross(tangentU).normalized()));
+    keyOfVertex.push_back(key);
+    vertexOfKey[key] = iVertex;
+    return iVertex;
+}
+
+
+const bool AdaptiveTessellation::wrapIndices(const int level, int &i,
+                                             int &j) const
+//
+// helper: wraps cell indices (`i`, `j`) at `level` into the domain if
+// the Surface wraps, returning false if they're outside it
+//
+{
+    const int nI = nRootsI << level;
+    const int nJ = nRootsJ << level;
+
+    if (i < 0 || i >= nI) {
+        if (!wrapI)
+            return false;
+        i = (i + nI) % nI;
+    }
+    if (j < 0 || j >= nJ) {
+        if (!wrapJ)
+            return false;
+        j = (j + nJ) % nJ;
+    }
+    return true;
+}
@@ -0,0 +1,125 @@
+#ifndef INCLUDED_ADAPTIVE_TESSELLATION
+
+//
+// The "adaptive_tessellation" module provides the AdaptiveTessellation
+// class (see below).
+//
+
+#include <unordered_map>
+#include <vector>
+
+#include "frame_context.h"
+#include "geometry.h"
+#include "tessellation.h"
+#include "transform.h"
+
+using namespace std;
+
+class Surface;
+
+//
+// AdaptiveTessellation refines its quadtrees this many levels below
+// their roots (at most).
+//
+const int ADAPTIVE_MAX_LEVEL = 5;
+
+// default screen-space error tolerance (in pixels)
+const double DEFAULT_ADAPTIVE_SCREEN_ERROR = 0.5;
+
+//
+// A cell is only merged back into its parent when the parent's error is
+// less than this fraction of the tolerance, so cells near the threshold
+// don't split and merge on alternate frames.
+//
+const double ADAPTIVE_MERGE_HYSTERESIS = 0.5;
+
+
+class AdaptiveTessellation : public Tessellation
+//
+// a view-dependent tessellation of a Surface
+//
+// The Surface's (u, v) domain is divided into a grid of root cells,
+// each the root of a quadtree. Every frame, update() splits a leaf
+// cell when the geometric error of approximating it by its corners
+// (estimated when the cell is created) would be more than
+// `maxScreenError` pixels on the screen, and merges cells whose parent
+// is now well within the tolerance. Only cells that change are
+// re-evaluated, and vertices are cached, so the cost of an update is
+// proportional to how much the view has changed.
+//
+// The quadtree is kept "restricted" (neighboring leaves differ by at
+// most one level), so each leaf edge has at most one extra vertex, at
+// its midpoint, where its neighbor is split. Such leaves are drawn as
+// a fan around their center that includes that vertex, which keeps
+// the tessellation free of cracks.
+//
+{
+    struct Cell {
+        bool isSplit;
+        double error;  // (model coordinates) of the cell's bilinear patch
+        Point3 center; // (model coordinates) of the cell's bounding sphere
+        double radius;
+    };
+
+    const Surface *surface;
+    int nRootsI, nRootsJ;
+    bool wrapI, wrapJ;
+    double maxScreenError;
+
+    // all cells (leaves and split cells) by cellKey()
+    unordered_map<unsigned long long, Cell> cells;
+
+    // vertex cache: mesh vertex by position on the finest grid (see
+    // vertex()) and vice versa
+    unordered_map<unsigned long long, int> vertexOfKey;
+    vector<unsigned long long> keyOfVertex;
+    vector<Point3f> vertexPositions;
+    vector<Vector3f> vertexNormals;
+
+    vector<unsigned int> vertexIndices; // 3 per triangle
+    bool isDirty; // true iff the cells have changed since the last upload
+
+    unsigned int vertexPositionsBufferId;
+    unsigned int vertexNormalBufferId;
+    unsigned int indexBufferId;
+
+    void addLeafTriangles(const int level, const int i, const int j);
+    const unsigned long long cellKey(const int level, const int i,
+                                     const int j) const;
+    void compactVertices(void);
+    void createCell(const int level, const int i, const int j);
+    Cell *findCell(const int level, int i, int j);
+    void merge(const int level, const int i, const int j);
+    void refine(const int level, const int i, const int j,
+                const FrameContext &frameContext,
+                const Transform &worldTransform, const double worldScale);
+    const double screenError(const Cell &cell,
+                             const FrameContext &frameContext,
+                             const Transform &worldTransform,
+                             const double worldScale) const;
+    void split(const int level, const int i, const int j);
+    void rebuildIndices(void);
+    const int vertex(const int level, int i, int j);
+    const bool wrapIndices(const int level, int &i, int &j) const;
+
+public:
+    AdaptiveTessellation(const Surface *surface_,
+                         const int nRootsI_, const int nRootsJ_,
+                         const bool wrapI_, const bool wrapJ_,
+                         const double maxScreenError_
+                             = DEFAULT_ADAPTIVE_SCREEN_ERROR);
+    ~AdaptiveTessellation();
+
+    void allocateBuffers(void);
+    const int nTriangles(void) const
+    {
+        return vertexIndices.size() / 3;
+    };
+    const void render(void);
+    void update(const FrameContext &frameContext,
+                const Transform &worldTransform);
+    void updateBuffers(void);
+};
+
+#define INCLUDED_ADAPTIVE_TESSELLATION
+#endif // INCLUDED_ADAPTIVE_TESSELLATION
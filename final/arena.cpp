@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "arena.h"
+
+Arena *Arena::current = NULL;
+vector<Arena *> Arena::liveArenas;
+
+
+Arena::Arena(const size_t blockSize_)
+    : blockSize(blockSize_), next(NULL), limit(NULL), nBytesAllocated(0)
+{
+    liveArenas.push_back(this);
+}
+
+
+Arena::~Arena()
+{
+    release();
+    liveArenas.erase(find(liveArenas.begin(), liveArenas.end(), this));
+    if (current == this)
+        current = NULL;
+}
+
+
+void *Arena::allocate(const size_t nBytes, const size_t alignment)
+//
+// returns `nBytes` of uninitialized memory aligned to `alignment` (a
+// power of 2)
+//
+{
+    assert((alignment & (alignment - 1)) == 0);
+
+    if (nBytes + alignment > blockSize) {
+        // too big to share a block (and the block isn't bumped into)
+        uintptr_t address = reinterpret_cast<uintptr_t>(
+            newBlock(nBytes + alignment));
+        nBytesAllocated += nBytes;
+        return reinterpret_cast<void *>(
+            (address + alignment - 1) & ~(alignment - 1));
+    }
+
+    uintptr_t address = reinterpret_cast<uintptr_t>(next);
+    uintptr_t aligned = (address + alignment - 1) & ~(alignment - 1);
+    if (next == NULL
+            || aligned + nBytes > reinterpret_cast<uintptr_t>(limit)) {
+        next = newBlock(blockSize);
+        limit = next + blockSize;
+        address = reinterpret_cast<uintptr_t>(next);
+        aligned = (address + alignment - 1) & ~(alignment - 1);
+    }
+    next += (aligned - address) + nBytes;
+    nBytesAllocated += nBytes;
+    return reinterpret_cast<void *>(aligned);
+}
+
+
+const size_t Arena::bytesAllocated(void) const
+//
+// returns the total number of bytes handed out since the last
+// release()
+//
+{
+    return nBytesAllocated;
+}
+
+
+unsigned char *Arena::newBlock(const size_t size)
+//
+// helper: gets a `size`-byte block from the heap and records it
+//
+{
+    Block block;
+
+    block.start = new unsigned char[size];
+    block.size = size;
+    blocks.push_back(block);
+    return block.start;
+}
+
+
+const bool Arena::owns(const void *p) const
+//
+// returns true iff `p` points into memory this Arena handed out
+//
+{
+    const unsigned char *q = static_cast<const unsigned char *>(p);
+
+    for (unsigned int i = 0; i < blocks.size(); i++) {
+        if (blocks[i].start <= q && q < blocks[i].start + blocks[i].size)
+            return true;
+    }
+    return false;
+}
+
+
+void Arena::release(void)
+//
+// frees everything allocated from the Arena
+//
+{
+    for (unsigned int i = 0; i < blocks.size(); i++)
+        delete [] blocks[i].start;
+    blocks.clear();
+    next = limit = NULL;
+    nBytesAllocated = 0;
+}
+
+
+const bool Arena::anyOwns(const void *p)
+//
+// returns true iff any existing Arena owns `p`
+//
+{
+    if (p == NULL)
+        return false;
+    for (unsigned int i = 0; i < liveArenas.size(); i++) {
+        if (liveArenas[i]->owns(p))
+            return true;
+    }
+    return false;
+}
+
+
+#ifdef TEST
+//
+// checks Arena allocation and ownership and times many small arrays
+// allocated from an Arena against the heap
+//
+#include <cstdlib>
+#include <iostream>
+
+#include "clock.h"
+#include "geometry.h"
+
+static int nFailures = 0;
+
+static void check(const bool condition, const char *description)
+{
+    if (!condition) {
+        cerr << "failed: " << description << "\n";
+        nFailures++;
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    const int nArrays = (argc > 1) ? atoi(argv[1]) : 100000;
+    const int maxArraySize = 64;
+
+    {
+        Arena arena(4096);
+
+        for (size_t alignment = 1; alignment <= 64; alignment *= 2) {
+            void *p = arena.allocate(3, alignment);
+            check(reinterpret_cast<uintptr_t>(p) % alignment == 0,
+                  "allocate() alignment");
+            check(arena.owns(p), "owns() of allocated memory");
+        }
+        void *big = arena.allocate(10000, 16); // gets its own block
+        check(arena.owns(big) && Arena::anyOwns(big), "oversized block");
+        int *onHeap = new int[4];
+        check(!Arena::anyOwns(onHeap), "anyOwns() of heap memory");
+        delete [] onHeap;
+
+        {
+            ArenaScope arenaScope(&arena);
+            Point3f (*pairs)[2] = newArray<Point3f[2]>(10);
+            check(arena.owns(pairs), "newArray() in an ArenaScope");
+            check(reinterpret_cast<uintptr_t>(pairs) % alignof(Point3f) == 0,
+                  "newArray() alignment");
+            deleteArray(pairs); // no-op
+        }
+        check(Arena::current == NULL, "ArenaScope restores the current Arena");
+        Vector3f *vectors = newArray<Vector3f>(10);
+        check(!Arena::anyOwns(vectors), "newArray() without an ArenaScope");
+        deleteArray(vectors);
+
+        arena.release();
+        check(arena.bytesAllocated() == 0 && !arena.owns(big), "release()");
+    }
+
+    vector<Point3f *> arrays(nArrays);
+    double startTime = clock_.read();
+    for (int i = 0; i < nArrays; i++)
+        arrays[i] = newArray<Point3f>(1 + i % maxArraySize);
+    for (int i = 0; i < nArrays; i++)
+        deleteArray(arrays[i]);
+    double heapTime = clock_.read() - startTime;
+
+    startTime = clock_.read();
+    Arena *arena = new Arena();
+    {
+        ArenaScope arenaScope(arena);
+        for (int i = 0; i < nArrays; i++)
+            arrays[i] = newArray<Point3f>(1 + i % maxArraySize);
+    }
+    size_t nBytes = arena->bytesAllocated();
+    delete arena;
+    double arenaTime = clock_.read() - startTime;
+
+    cout << nArrays << " arrays (" << nBytes << " bytes)\n";
+    cout << "heap: " << heapTime << " s, arena: " << arenaTime << " s\n";
+    if (nFailures > 0)
+        exit(EXIT_FAILURE);
+}
+#endif // TEST
@@ -0,0 +1,119 @@
+#ifndef INCLUDED_ARENA
+
+//
+// The "arena" module provides the Arena class (see below) and the
+// newArray() and deleteArray() functions that allocate the CPU-side
+// geometry arrays from it.
+//
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+using namespace std;
+
+// size of each block an Arena gets from the heap
+const size_t DEFAULT_ARENA_BLOCK_SIZE = 1 << 20; // 1 MiB
+
+
+class Arena
+//
+// a monotonic ("bump") allocator
+//
+// Memory is carved out of large blocks in the order it's asked for
+// and never freed individually: release() (or the destructor) frees
+// all of it at once. Requests too large for a block get a block of
+// their own.
+//
+// While an ArenaScope (see below) names an Arena "current",
+// newArray() allocates from it.
+//
+{
+    struct Block {
+        unsigned char *start;
+        size_t size;
+    };
+
+    vector<Block> blocks;
+    size_t blockSize;
+    unsigned char *next; // next free byte in the last full-size block
+    unsigned char *limit; // end of the last full-size block
+    size_t nBytesAllocated;
+
+    // all Arenas in existence (for anyOwns())
+    static vector<Arena *> liveArenas;
+
+    unsigned char *newBlock(const size_t size);
+
+public:
+    static Arena *current; // NULL: newArray() uses the heap
+
+    Arena(const size_t blockSize_ = DEFAULT_ARENA_BLOCK_SIZE);
+    ~Arena();
+
+    void *allocate(const size_t nBytes, const size_t alignment);
+    const size_t bytesAllocated(void) const;
+    const bool owns(const void *p) const;
+    void release(void);
+
+    static const bool anyOwns(const void *p);
+};
+
+
+class ArenaScope
+//
+// makes an Arena current for the lifetime of the ArenaScope, then
+// restores the one that was current before
+//
+{
+    Arena *previous;
+
+public:
+    ArenaScope(Arena *arena)
+        : previous(Arena::current)
+    {
+        Arena::current = arena;
+    };
+
+    ~ArenaScope()
+    {
+        Arena::current = previous;
+    };
+};
+
+
+template <class T>
+T *newArray(const int n)
+//
+// returns an array of `n` default-constructed T's, allocated from the
+// current Arena if there is one and from the heap otherwise
+//
+{
+    // Arenas never run destructors.
+    static_assert(is_trivially_destructible<T>::value,
+                  "arena-allocated types must be trivially destructible");
+
+    if (Arena::current == NULL)
+        return new T[n];
+
+    T *a = static_cast<T *>(
+        Arena::current->allocate(n * sizeof(T), alignof(T)));
+    for (int i = 0; i < n; i++)
+        ::new (static_cast<void *>(a + i)) T;
+    return a;
+}
+
+
+template <class T>
+void deleteArray(T *a)
+//
+// frees an array returned by newArray() (a no-op if an Arena owns it,
+// as the Arena will free it)
+//
+{
+    if (!Arena::anyOwns(a))
+        delete [] a;
+}
+
+#define INCLUDED_ARENA
+#endif // INCLUDED_ARENA
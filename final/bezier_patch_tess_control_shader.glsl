@@ -0,0 +1,113 @@
+#version 400
+
+//
+// tessellation control shader for (bicubic) Bezier patches
+//
+// Each patch is its 4x4 control vertices, in the same order as
+// BezierPatch's `cvs[i][j]` (i.e. the vertex for [i][j] is
+// 4*i + j), with i along u and j along v.
+//
+// This picks the tessellation levels so that, on the screen, no
+// segment of the tessellated surface is more than `maxScreenError`
+// pixels from the curve it approximates. A cubic Bezier curve cut
+// into n equal parametric segments deviates from its chords by at
+// most
+//
+//     max |p''| / (8 n^2) <= 6 max |P[k] - 2 P[k+1] + P[k+2]| / (8 n^2)
+//
+// so n is chosen from the control polygon's largest projected second
+// difference. Patches whose control vertices are all outside the same
+// clip plane are culled (a Bezier patch lies within the convex hull of
+// its control vertices).
+//
+
+layout(vertices = 16) out;
+
+uniform mat4 modelViewProjectionMatrix;
+
+uniform vec2 viewportSize; // in pixels
+
+uniform float maxScreenError; // in pixels
+
+// used for patches that cross the eye plane, where projection fails
+const float EYE_PLANE_LEVEL = 16.0;
+
+const float EPSILON = 1.0e-5; // for single precision
+
+vec2 screenPosition[16];
+
+float curveLevel(int k0, int k1, int k2, int k3)
+//
+// returns the number of segments needed by the cubic Bezier curve
+// whose control vertices have indices `k0` ... `k3`
+//
+{
+    float secondDifference = max(
+        length(screenPosition[k0] - 2.0 * screenPosition[k1]
+               + screenPosition[k2]),
+        length(screenPosition[k1] - 2.0 * screenPosition[k2]
+               + screenPosition[k3]));
+
+    return ceil(sqrt(0.75 * secondDifference / maxScreenError));
+}
+
+void main(void)
+{
+    gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+
+    // The levels are per-patch, so only one invocation need set them.
+    if (gl_InvocationID != 0)
+        return;
+
+    // how many control vertices are outside each clip plane
+    vec3 nBelow = vec3(0.0);
+    vec3 nAbove = vec3(0.0);
+    bool crossesEyePlane = false;
+
+    for (int k = 0; k < 16; k++) {
+        vec4 clipPosition = modelViewProjectionMatrix * gl_in[k].gl_Position;
+
+        nBelow += vec3(lessThan(clipPosition.xyz, vec3(-clipPosition.w)));
+        nAbove += vec3(greaterThan(clipPosition.xyz, vec3(clipPosition.w)));
+        if (clipPosition.w < EPSILON)
+            crossesEyePlane = true;
+        else
+            screenPosition[k] = 0.5 * viewportSize
+                * clipPosition.xy / clipPosition.w;
+    }
+
+    if (any(equal(nBelow, vec3(16.0))) || any(equal(nAbove, vec3(16.0)))) {
+        // A zero outer level discards the patch.
+        gl_TessLevelOuter[0] = 0.0;
+        gl_TessLevelOuter[1] = 0.0;
+        gl_TessLevelOuter[2] = 0.0;
+        gl_TessLevelOuter[3] = 0.0;
+        return;
+    }
+
+    if (crossesEyePlane) {
+        gl_TessLevelOuter[0] = EYE_PLANE_LEVEL;
+        gl_TessLevelOuter[1] = EYE_PLANE_LEVEL;
+        gl_TessLevelOuter[2] = EYE_PLANE_LEVEL;
+        gl_TessLevelOuter[3] = EYE_PLANE_LEVEL;
+        gl_TessLevelInner[0] = EYE_PLANE_LEVEL;
+        gl_TessLevelInner[1] = EYE_PLANE_LEVEL;
+        return;
+    }
+
+    // the edges: u = 0, v = 0, u = 1, and v = 1, respectively
+    gl_TessLevelOuter[0] = max(curveLevel( 0,  1,  2,  3), 1.0);
+    gl_TessLevelOuter[1] = max(curveLevel( 0,  4,  8, 12), 1.0);
+    gl_TessLevelOuter[2] = max(curveLevel(12, 13, 14, 15), 1.0);
+    gl_TessLevelOuter[3] = max(curveLevel( 3,  7, 11, 15), 1.0);
+
+    // The interior needs the most any curve in each direction needs.
+    float levelU = 1.0;
+    float levelV = 1.0;
+    for (int k = 0; k < 4; k++) {
+        levelU = max(levelU, curveLevel(k, k + 4, k + 8, k + 12));
+        levelV = max(levelV, curveLevel(4*k, 4*k + 1, 4*k + 2, 4*k + 3));
+    }
+    gl_TessLevelInner[0] = levelU;
+    gl_TessLevelInner[1] = levelV;
+}
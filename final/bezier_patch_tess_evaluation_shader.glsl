@@ -0,0 +1,133 @@
+#version 400
+
+//
+// tessellation evaluation shader for (bicubic) Bezier patches (see
+// "bezier_patch_tess_control_shader.glsl")
+//
+// This evaluates the patch (and its normal, as Surface::tessellate()
+// does) at each tessellated vertex and then lights it just as
+// "eads_vertex_shader.glsl" lights a mesh vertex.
+//
+
+layout(quads, equal_spacing, ccw) in;
+
+//
+// These blocks must be the same as those of "eads_vertex_shader.glsl"
+// (and the host-side offsets in "shader_programs.cpp" and
+// "material.cpp").
+//
+
+struct Light {
+    vec3 irradiance;
+    vec3 towards;
+};
+
+// per-frame properties (camera, lights, and GUI settings)
+layout(std140) uniform FrameBlock {
+    mat4 viewProjectionMatrix;
+    vec3 cameraPosition;
+    int useOrthographic;
+    vec3 orthographicTowards;
+    int nLights;
+    int ambientReflectionEnabled;
+    int diffuseReflectionEnabled;
+    int specularReflectionEnabled;
+    Light light[10];
+};
+
+// material properties
+layout(std140) uniform MaterialBlock {
+    vec3 emittance;
+    float specularExponent;
+    vec3 ambientReflectivity;
+    vec3 maximumDiffuseReflectivity;
+    vec3 maximumSpecularReflectivity;
+};
+
+// per-object (i.e. per-draw) properties
+layout(std140) uniform ObjectBlock {
+    mat4 worldMatrix;
+    mat3 normalMatrix;
+};
+
+smooth out vec4 interpolatedColor;
+
+vec3 getRadiance(vec3 worldNormal, vec3 towardsCamera)
+//
+// returns the emitted and reflected radiance (as in
+// "eads_vertex_shader.glsl")
+//
+{
+    vec3 radiance = emittance;
+
+    for (int i = 0; i < nLights; i++) {
+        vec3 reflectivity = vec3(0.0);
+        if (ambientReflectionEnabled != 0)
+            reflectivity += ambientReflectivity;
+
+        vec3 towardsLight = normalize(light[i].towards);
+        float nDotL = dot(worldNormal, towardsLight);
+
+        if (nDotL > 0.0) {
+            if (diffuseReflectionEnabled != 0)
+                reflectivity += nDotL * maximumDiffuseReflectivity;
+
+            vec3 h = normalize(towardsCamera + towardsLight);
+            float nDotH = dot(worldNormal, h);
+
+            if (nDotH > 0.0 && specularReflectionEnabled != 0)
+                reflectivity += maximumSpecularReflectivity
+                    * pow(nDotH, specularExponent);
+        }
+        radiance += light[i].irradiance * reflectivity;
+    }
+    return radiance;
+}
+
+void bernstein(float t, out vec4 b, out vec4 db_dt)
+//
+// returns the cubic Bernstein polynomials and their derivatives at `t`
+//
+{
+    float s = 1.0 - t;
+
+    b = vec4(s * s * s, 3.0 * t * s * s, 3.0 * t * t * s, t * t * t);
+    db_dt = vec4(-3.0 * s * s,
+                 3.0 * s * (s - 2.0 * t),
+                 3.0 * t * (2.0 * s - t),
+                 3.0 * t * t);
+}
+
+void main(void)
+{
+    vec4 bU, dbU, bV, dbV;
+
+    bernstein(gl_TessCoord.x, bU, dbU);
+    bernstein(gl_TessCoord.y, bV, dbV);
+
+    vec3 p = vec3(0.0);
+    vec3 dp_du = vec3(0.0);
+    vec3 dp_dv = vec3(0.0);
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            vec3 cv = gl_in[4*i + j].gl_Position.xyz;
+
+            p += bU[i] * bV[j] * cv;
+            dp_du += dbU[i] * bV[j] * cv;
+            dp_dv += bU[i] * dbV[j] * cv;
+        }
+    }
+
+    vec4 worldPosition4 = worldMatrix * vec4(p, 1.0);
+    vec3 towardsCamera;
+
+    if (useOrthographic == 1)
+        towardsCamera = orthographicTowards;
+    else
+        towardsCamera = cameraPosition - worldPosition4.xyz;
+    towardsCamera = normalize(towardsCamera);
+    vec3 worldNormal = normalize(normalMatrix * cross(dp_dv, dp_du));
+
+    interpolatedColor = vec4(getRadiance(worldNormal, towardsCamera), 1.0);
+    gl_Position = viewProjectionMatrix * worldPosition4;
+}
@@ -0,0 +1,19 @@
+#version 400
+
+//
+// vertex shader for Bezier patches tessellated by
+// "bezier_patch_tess_control_shader.glsl" and
+// "bezier_patch_tess_evaluation_shader.glsl"
+//
+// Each vertex is a control vertex. It's left in model coordinates,
+// since the surface is evaluated in the tessellation evaluation
+// shader.
+//
+
+// per-vertex inputs
+in vec4 vertexPosition;
+
+void main(void)
+{
+    gl_Position = vertexPosition;
+}
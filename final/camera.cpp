@@ -58,6 +58,17 @@ void Camera::setExtent(double extent_)
 }
 
 
+FrameContext Camera::frameContext(void)
+//
+// returns the camera state needed to draw the next frame (see
+// FrameContext)
+//
+{
+    return FrameContext(viewTransform(), projectionTransform(),
+                        controller.useOrthographic, orthographic.towards);
+}
+
+
 void Camera::magnify(double factor)
 {
     // the only time magnification makes sense
@@ -6,6 +6,7 @@
 //
 
 #include "curve.h"
+#include "frame_context.h"
 #include "geometry.h"
 #include "transform.h"
 
@@ -65,6 +66,7 @@ public:
 
     Camera(void);
 
+    FrameContext frameContext(void);
     Matrix4 lookAt(const Point3 &eye,
                    const Vector3 &viewDirection,
                    const Vector3 &upApprox);
@@ -14,9 +14,19 @@
 // string carFname = DEFAULT_CAR_FNAME;
 string carFname = ROCKET_CAR_FNAME;
 
+//
+// All cars are the same model, so they share one IrregularMesh (and its
+// MeshLodChain): the first Car created reads and simplifies it and the
+// last one deleted deletes it. Only their materials and transforms
+// differ.
+//
+static IrregularMesh *sharedIrregularMesh = NULL;
+static MeshLodChain *sharedMeshLodChain = NULL;
+static int nSharingCars = 0;
+
 Car::Car(const Rgb &baseRgb_, double initialU, const Curve *path_)
     :
-      irregularMesh(NULL)
+      irregularMesh(NULL), meshLodChain(NULL), iLod(0)
 {
     coordinateAxes = new CoordinateAxes(); // add this line
 
@@ -28,16 +38,40 @@ Car::Car(const Rgb &baseRgb_, double initialU, const Curve *path_)
     u = initialU;
     baseRgb = baseRgb_;
 
-    // Since the car's IrregularMesh doesn't need to be tessellated
-    // (effectively), we can create the hedgehogs immediately.
-    irregularMesh = IrregularMesh::read(carFname.c_str());
+    double specFrac = 0.25; // fraction of reflected power that's specular
+    Rgb ambDiffBaseRgb = (1.0 - specFrac) * baseRgb;
+    material = new Material(blackColor,
+                            0.2 * ambDiffBaseRgb,
+                            0.8 * ambDiffBaseRgb,
+                            Rgb(specFrac, specFrac, specFrac), 10.0);
+
+    if (nSharingCars == 0) {
+        sharedIrregularMesh = IrregularMesh::read(carFname.c_str());
+        // Far away, one of its simplified copies is drawn instead.
+        sharedMeshLodChain = new MeshLodChain(sharedIrregularMesh);
+    }
+    nSharingCars++;
+    irregularMesh = sharedIrregularMesh;
+    meshLodChain = sharedMeshLodChain;
 
-    // Since the car's IrregularMesh doesn't need to be tessellated
-    // (effectively), we can create the hedgehogs immediately.
-    addHedgehogs(irregularMesh);
+    // (The chain has the hedgehogs of each level, which display() draws
+    // for the level it draws.)
+}
+
+
+Car::~Car()
+{
+    if (--nSharingCars == 0) {
+        delete sharedMeshLodChain;
+        delete sharedIrregularMesh;
+        sharedMeshLodChain = NULL;
+        sharedIrregularMesh = NULL;
+    }
+    delete coordinateAxes;
+    delete material;
 }
 
-void Car::display(const Transform &viewProjectionTransform,
+void Car::display(const FrameContext &frameContext,
                   Transform worldTransform)
 {
     //
@@ -64,18 +98,8 @@ void Car::display(const Transform &viewProjectionTransform,
     }
 
     if (scene->eadsShaderProgram) { // will be NULL in the template
-        double specFrac = 0.25; // fraction of reflected power that's specular
-        Rgb ambDiffBaseRgb = (1.0 - specFrac) * baseRgb;
-        Transform identityTransform;
-
-        scene->eadsShaderProgram->setEmittance(blackColor);
-        scene->eadsShaderProgram->setAmbient(0.2 * ambDiffBaseRgb);
-        scene->eadsShaderProgram->setDiffuse(0.8 * ambDiffBaseRgb);
-        scene->eadsShaderProgram->setSpecular(
-            Rgb(specFrac, specFrac, specFrac), 10.0);
+        scene->eadsShaderProgram->setMaterial(material);
         worldTransform *= modelTransform;
-        scene->eadsShaderProgram->setModelViewProjectionMatrix(
-            viewProjectionTransform * worldTransform);
         scene->eadsShaderProgram->setWorldMatrix(worldTransform);
         scene->eadsShaderProgram->setNormalMatrix(
             worldTransform.getNormalTransform());
@@ -84,14 +108,14 @@ void Car::display(const Transform &viewProjectionTransform,
 
     // `irregularMesh` will be NULL in the unmodified template.
     if (irregularMesh) {
-        irregularMesh->render();
+        meshLodChain->select(frameContext, worldTransform, iLod)->render();
         const double quillLength = 0.04;
-        displayHedgehogs(viewProjectionTransform,
-            worldTransform, quillLength);
+        meshLodChain->displayHedgehogs(frameContext,
+            worldTransform, quillLength, iLod);
     }
 
     if (controller.axesEnabled)
-        coordinateAxes->display(viewProjectionTransform, worldTransform);
+        coordinateAxes->display(frameContext, worldTransform);
 }
 
 
@@ -7,6 +7,8 @@
 #include "coordinate_axes.h"
 #include "curve.h"
 #include "irregular_mesh.h"
+#include "material.h"
+#include "mesh_lod_chain.h"
 #include "n_elem.h"
 #include "scene_object.h"
 #include "shader_programs.h"
@@ -26,7 +28,10 @@ class Car : public SceneObject
 {
 private:
     IrregularMesh *irregularMesh;
+    MeshLodChain *meshLodChain; // (of `irregularMesh`)
+    int iLod; // the level of detail drawn last
     CoordinateAxes *coordinateAxes;
+    Material *material; // derived from `baseRgb`
 
 public:
     double u; // parametric position along track
@@ -34,8 +39,9 @@ public:
     Rgb baseRgb; // determines reflectance properties in ::draw()
 
     Car(const Rgb &baseRgb, double initialU, const Curve *path);
+    ~Car();
 
-    void display(const Transform &viewProjectionTransform,
+    void display(const FrameContext &frameContext,
               Transform worldTransform);
     const double speed(const Track *track) const;
     void move(double dU);
@@ -24,6 +24,7 @@ enum {
     MENU_TOGGLE_FULL_SCREEN,
     MENU_TOGGLE_STATS,
     MENU_TOGGLE_VIEW_HELP,
+    MENU_TOGGLE_ADAPTIVE_TESSELLATION,
     MENU_TOGGLE_AMBIENT_REFLECTION,
     MENU_TOGGLE_BACK_FACE_CULLING,
     MENU_TOGGLE_DIFFUSE_REFLECTION,
@@ -37,6 +38,7 @@ enum {
     MENU_TOGGLE_ANIMATION,
     MENU_TOGGLE_FIRST_PERSON,
     MENU_TOGGLE_PERSPECTIVE,
+    MENU_RELOAD_TRACK,
 };
 
 
@@ -55,6 +57,8 @@ void Controller::init()
     // build the pop-up menu and attach it to the right mouse button
     framework.createMenu(onMenuSelection);
     // these commands should be in alphabetical order (except for "Quit")
+    framework.addMenuEntry("reload [t]rack",
+                                             MENU_RELOAD_TRACK);
     framework.addMenuEntry("[r]eset view",
                                              MENU_RESET_VIEW);
     framework.addMenuEntry("step [Space]",
@@ -65,6 +69,8 @@ void Controller::init()
                                              MENU_TOGGLE_AMBIENT_REFLECTION);
     framework.addMenuEntry("toggle [a]nimation", // no conflict with antialias
                                              MENU_TOGGLE_ANIMATION);
+    framework.addMenuEntry("toggle adaptive [T]essellation",
+                                             MENU_TOGGLE_ADAPTIVE_TESSELLATION);
     framework.addMenuEntry("toggle [b]ack face culling",
                                              MENU_TOGGLE_BACK_FACE_CULLING);
     framework.addMenuEntry("toggle [c]oordinate axes",
@@ -176,6 +182,14 @@ static void onKeyboardKey(unsigned char key, int, int)
         onMenuSelection(MENU_TOGGLE_STATS);
         break;
 
+    case 'T':
+        onMenuSelection(MENU_TOGGLE_ADAPTIVE_TESSELLATION);
+        break;
+
+    case 't':
+        onMenuSelection(MENU_RELOAD_TRACK);
+        break;
+
     case 'v':
         onMenuSelection(MENU_USE_VERTEX_NORMALS);
         break;
@@ -239,6 +253,13 @@ static void onMenuSelection(int menuDescriptor)
         }
         break;
 
+    case MENU_RELOAD_TRACK:
+        scene->reloadTrack();
+        renderStats.resetTimeAveraging();
+        renderStats.reset();
+        view.display();
+        break;
+
     case MENU_RESET_VIEW:
         renderStats.resetTimeAveraging();
         view.reset(); // also resets camera
@@ -256,6 +277,14 @@ static void onMenuSelection(int menuDescriptor)
         view.display();
         break;
 
+    case MENU_TOGGLE_ADAPTIVE_TESSELLATION:
+        controller.adaptiveTessellationEnabled
+            = !controller.adaptiveTessellationEnabled;
+        renderStats.resetTimeAveraging();
+        renderStats.reset();
+        view.display();
+        break;
+
     case MENU_TOGGLE_AMBIENT_REFLECTION:
         controller.ambientReflectionEnabled
             = !controller.ambientReflectionEnabled;
@@ -16,6 +16,7 @@ class Controller
 //
 {
 public:
+    bool adaptiveTessellationEnabled;
     bool ambientReflectionEnabled;
     bool animationEnabled;
     bool axesEnabled;
@@ -40,6 +41,7 @@ bool useVertexNormals;
 
 Controller()
     :
+    adaptiveTessellationEnabled(true),
     ambientReflectionEnabled(true),
     animationEnabled(false),
     axesEnabled(false),
@@ -7,9 +7,9 @@
 
 CoordinateAxes::CoordinateAxes(void)
 {
-    Point3 pXs[] = { Point3(0, 0, 0), Point3(1, 0, 0) };
-    Point3 pYs[] = { Point3(0, 0, 0), Point3(0, 1, 0) };
-    Point3 pZs[] = { Point3(0, 0, 0), Point3(0, 0, 1) };
+    Point3f pXs[] = { Point3f(0, 0, 0), Point3f(1, 0, 0) };
+    Point3f pYs[] = { Point3f(0, 0, 0), Point3f(0, 1, 0) };
+    Point3f pZs[] = { Point3f(0, 0, 0), Point3f(0, 0, 1) };
 
     xAxis = new PolyLine(pXs, 2, false);
     yAxis = new PolyLine(pYs, 2, false);
@@ -17,7 +17,15 @@ CoordinateAxes::CoordinateAxes(void)
 }
 
 
-void CoordinateAxes::display(const Transform &viewProjectionTransform,
+CoordinateAxes::~CoordinateAxes()
+{
+    delete xAxis;
+    delete yAxis;
+    delete zAxis;
+}
+
+
+void CoordinateAxes::display(const FrameContext &frameContext,
                              Transform worldTransform)
 //
 // draws red, green, and blue unit-length lines for the x, y, and z
@@ -26,7 +34,7 @@ void CoordinateAxes::display(const Transform &viewProjectionTransform,
 {
     // set transform
     scene->uniformColorShaderProgram->setModelViewProjectionMatrix(
-        viewProjectionTransform * worldTransform);
+        frameContext.viewProjectionTransform * worldTransform);
 
     scene->uniformColorShaderProgram->setColor(redColor);
     scene->uniformColorShaderProgram->start();
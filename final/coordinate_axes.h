@@ -24,7 +24,8 @@ private:
 
 public:
     CoordinateAxes(void);
-    void display(const Transform &viewProjectionTransform,
+    ~CoordinateAxes();
+    void display(const FrameContext &frameContext,
                  Transform worldTransform);
 };
 
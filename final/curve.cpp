@@ -2,6 +2,8 @@
 // This file will deal with all single-parametric curves.
 //
 
+#include <algorithm>
+
 #include "curve.h"
 #include "geometry.h"
 #include "poly_line.h"
@@ -35,6 +37,65 @@ const double Curve::dS(const double u, const double du) const
 }
 
 
+const vector<double> Curve::chordParameters(const double maxChordError,
+                                            const double maxChordLength)
+    const
+//
+// returns the parameters of the fewest points (from 0 to 1, inclusive)
+// on the curve such that the chords between successive points are
+// within `maxChordError` of the curve and no longer than
+// `maxChordLength`
+//
+// A chord of length `ds` on a curve of curvature `k` is (about)
+// `k * ds**2 / 8` away from it at its midpoint (cf. getNFromR() in
+// PA01), so each parametric interval `du` needs
+//
+//     |dp_du| * max(sqrt(k / (8 * maxChordError)), 1 / maxChordLength)
+//
+// chords. We integrate that and place the points where its integral
+// reaches an integer, so they're densest where the curve bends most.
+//
+{
+    const int nIntervals = 1024;
+    const double du = 1.0 / nIntervals;
+    vector<double> nChordsBefore(nIntervals + 1); // at i * du
+    nChordsBefore[0] = 0.0;
+
+    for (int i = 0; i < nIntervals; i++) {
+        Vector3 dp_du, d2p_du2;
+        (*this)((i + 0.5) * du, &dp_du, &d2p_du2); // (midpoint rule)
+
+        double speed = dp_du.mag();
+        double curvature = 0.0;
+        if (speed > EPSILON)
+            curvature = dp_du.cross(d2p_du2).mag() / (speed * speed * speed);
+
+        double chordsPerLength = max(sqrt(curvature / (8.0 * maxChordError)),
+                                     1.0 / maxChordLength);
+        nChordsBefore[i + 1] = nChordsBefore[i]
+            + speed * chordsPerLength * du;
+    }
+
+    int nChords = max(static_cast<int>(ceil(nChordsBefore[nIntervals])), 1);
+    double chordScale = nChordsBefore[nIntervals] / nChords; // (<= 1)
+    vector<double> result;
+    result.push_back(0.0);
+    int i = 0;
+    for (int iChord = 1; iChord < nChords; iChord++) {
+        double target = iChord * chordScale;
+
+        while (nChordsBefore[i + 1] < target)
+            i++;
+        // (linearly interpolate within the interval)
+        double f = (target - nChordsBefore[i])
+            / (nChordsBefore[i + 1] - nChordsBefore[i]);
+        result.push_back((i + f) * du);
+    }
+    result.push_back(1.0);
+    return result;
+}
+
+
 const double Curve::length(void) const
 //
 // returns the length of the curve in NDC units
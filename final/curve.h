@@ -7,6 +7,7 @@
 #include <assert.h>
 #include <vector>
 
+#include "arena.h"
 #include "basis.h"
 #include "color.h"
 #include "geometry.h"
@@ -29,6 +30,8 @@ public:
     // at least one older g++ compiler complains if this is missing
     virtual ~Curve() { };
 
+    const vector<double> chordParameters(const double maxChordError,
+                                         const double maxChordLength) const;
     const Transform coordinateFrame(const double u) const;
 
     const double dS(const double u, const double du) const;
@@ -65,13 +68,15 @@ public:
 
         vNeverParallel = vNeverParallel_;
         frameIsDynamic = false;
-        cvs = new Point3[nCvs];
+        cvs = newArray<Point3>(nCvs);
         for (int i = 0; i < nCvs; i++)
             cvs[i] = cvs_[i];
     };
 
-    // at least one older g++ compiler complains if this is missing
-    virtual ~BSplineCurve() { };
+    virtual ~BSplineCurve()
+    {
+        deleteArray(cvs);
+    };
 
     const Point3 operator()(const double u, Vector3 *dp_du = NULL,
                                     Vector3 *d2p_du2 = NULL) const;
@@ -10,24 +10,37 @@ string dsFname = DEATH_STAR_FNAME;
 
 DeathStar::DeathStar(void)
           :
-            irregularMesh(NULL)
+            irregularMesh(NULL), meshLodChain(NULL), iLod(0)
 {
   coordinateAxes = new CoordinateAxes(); // add this line
 
+  Rgb surfaceColorRGB(0.563, 0.578, 0.589);
+  material = new Material(blackColor,
+                          0.3*surfaceColorRGB,
+                          0.3*surfaceColorRGB,
+                          Rgb(0.3, 0.3, 0.3), 30.0);
+
   // Since the car's IrregularMesh doesn't need to be tessellated
-  // (effectively), we can create the hedgehogs immediately.
+  // (effectively), we can add its hedgehogs immediately.
   irregularMesh = IrregularMesh::read(dsFname.c_str());
 
-  // Since the car's IrregularMesh doesn't need to be tessellated
-  // (effectively), we can create the hedgehogs immediately.
-  addHedgehogs(irregularMesh);
+  // Far away, one of its simplified copies (and its hedgehogs) is
+  // drawn instead.
+  meshLodChain = new MeshLodChain(irregularMesh);
 }
 
-void DeathStar::display(const Transform &viewProjectionTransform,
-                     Transform worldTransform)
+
+DeathStar::~DeathStar()
 {
-    Rgb surfaceColorRGB(0.563, 0.578, 0.589);
+  delete meshLodChain;
+  delete irregularMesh;
+  delete coordinateAxes;
+  delete material;
+}
 
+void DeathStar::display(const FrameContext &frameContext,
+                     Transform worldTransform)
+{
     modelTransform = Transform(2.0, 0.0, 0.0, 0.0,
                                0.0, 2.0, 0.0, -0.5,
                                0.0, 0.0, 2.0, 0.0,
@@ -37,13 +50,8 @@ void DeathStar::display(const Transform &viewProjectionTransform,
 
 
     if (scene->eadsShaderProgram) { // will be NULL in the template
-        scene->eadsShaderProgram->setEmittance(blackColor);
-        scene->eadsShaderProgram->setDiffuse(0.3*surfaceColorRGB);
-        scene->eadsShaderProgram->setAmbient(0.3*surfaceColorRGB);
-        scene->eadsShaderProgram->setSpecular(Rgb(0.3, 0.3, 0.3), 30.0);
+        scene->eadsShaderProgram->setMaterial(material);
         worldTransform *= modelTransform;
-        scene->eadsShaderProgram->setModelViewProjectionMatrix(
-            viewProjectionTransform * worldTransform);
         scene->eadsShaderProgram->setWorldMatrix(worldTransform);
         scene->eadsShaderProgram->setNormalMatrix(
             worldTransform.getNormalTransform());
@@ -52,12 +60,12 @@ void DeathStar::display(const Transform &viewProjectionTransform,
 
     // `irregularMesh` will be NULL in the unmodified template.
     if (irregularMesh) {
-        irregularMesh->render();
+        meshLodChain->select(frameContext, worldTransform, iLod)->render();
         const double quillLength = 0.04;
-        displayHedgehogs(viewProjectionTransform,
-            worldTransform, quillLength);
+        meshLodChain->displayHedgehogs(frameContext,
+            worldTransform, quillLength, iLod);
     }
 
     if (controller.axesEnabled)
-        coordinateAxes->display(viewProjectionTransform, worldTransform);
+        coordinateAxes->display(frameContext, worldTransform);
 }
@@ -9,6 +9,8 @@ using namespace std;
 #include "irregular_mesh.h"
 #include "coordinate_axes.h"
 #include "geometry.h"
+#include "material.h"
+#include "mesh_lod_chain.h"
 #include "scene_object.h"
 #include "shader_programs.h"
 #include "surface.h"
@@ -26,12 +28,16 @@ class DeathStar : public SceneObject
 private:
     // A Teapot is made up of a collection of BezierPatches.
     IrregularMesh *irregularMesh;
+    MeshLodChain *meshLodChain; // (of `irregularMesh`)
+    int iLod; // the level of detail drawn last
     CoordinateAxes *coordinateAxes;
+    Material *material;
 
 public:
     DeathStar(void);
+    ~DeathStar();
 
-    void display(const Transform &viewProjectionTransform,
+    void display(const FrameContext &frameContext,
                  Transform worldTransform);
 };
 
@@ -6,50 +6,64 @@
 // OpenGL shading model.
 //
 
-// material properties
-uniform vec3 emittance;
-uniform vec3 ambientReflectivity;
-uniform vec3 maximumDiffuseReflectivity;
-uniform vec3 maximumSpecularReflectivity;
-uniform float specularExponent;
-
-// camera propert(y|ies)
 //
-// Note that "towardsCamera" has been replaced by the following:
+// Uniform values are grouped into std140 uniform blocks by how often
+// they change. The byte offsets of the members are mirrored on the
+// host side (see "shader_programs.cpp" and "material.cpp"), so keep
+// them in sync.
 //
 
-// If true, we're using an orthographic projection. If false, we're
-// using a perspective transform.
-uniform int useOrthographic;
+struct Light {
+    vec3 irradiance;
+    vec3 towards;
+};
 
-// This is the equivalent of "towardsCamera", but it should only be
-// used if "useOrthographic" is true.
-uniform vec3 orthographicTowards;
+// per-frame properties (camera, lights, and GUI settings)
+layout(std140) uniform FrameBlock {
+    // This transforms world coordinates into NDC.
+    mat4 viewProjectionMatrix;
 
-// When using perspective (i.e. useOrthographic is false), the camera
-// is at this position, so the "towards" vector is this value minus
-// `vertexPosition`.
-uniform vec3 cameraPosition;
+    // When using perspective (i.e. useOrthographic is false), the
+    // camera is at this position, so the "towards" vector is this
+    // value minus the world vertex position.
+    vec3 cameraPosition;
 
-// light properties
-uniform int nLights;
-uniform struct Light {
-    vec3 irradiance;
-    vec3 towards;
-} light[10]; // in later GLSLs, this size can vary
+    // If true, we're using an orthographic projection. If false,
+    // we're using a perspective transform.
+    int useOrthographic;
 
-//
-// Note that `viewMatrix` has been replaced (in this shader only) by
-// the following two matrices:
+    // This is the equivalent of "towardsCamera", but it should only
+    // be used if "useOrthographic" is true.
+    vec3 orthographicTowards;
 
-// This transforms `vertexPosition` into NDC for drawing purposes.
-uniform mat4 modelViewProjectionMatrix;
+    int nLights;
 
-// This transforms `vertexPosition` into world coordinates for
-// lighting computation.
-uniform mat4 worldMatrix;
+    // GUI switches for the individual reflection terms
+    int ambientReflectionEnabled;
+    int diffuseReflectionEnabled;
+    int specularReflectionEnabled;
 
-uniform mat3 normalMatrix;    // transforms normals into world
+    Light light[10]; // in later GLSLs, this size can vary
+};
+
+// material properties
+layout(std140) uniform MaterialBlock {
+    vec3 emittance;
+    float specularExponent;
+    vec3 ambientReflectivity;
+    vec3 maximumDiffuseReflectivity;
+    vec3 maximumSpecularReflectivity;
+};
+
+// per-object (i.e. per-draw) properties
+layout(std140) uniform ObjectBlock {
+    // This transforms `vertexPosition` into world coordinates for
+    // lighting computation (and, with `viewProjectionMatrix`, into
+    // NDC for drawing purposes).
+    mat4 worldMatrix;
+
+    mat3 normalMatrix;    // transforms normals into world
+};
 
 // per-vertex inputs
 in vec4 vertexPosition;
@@ -73,7 +87,9 @@ vec3 getRadiance(vec3 worldNormal, vec3 towardsCamera)
 
     for(int i = 0; i < nLights; i++){
 
-      vec3 reflectivity = ambientReflectivity;
+      vec3 reflectivity = vec3(0.0);
+      if(ambientReflectionEnabled != 0)
+        reflectivity += ambientReflectivity;
       vec3 towardsLight = light[i].towards;
       vec3 irradiance = light[i].irradiance;
 
@@ -84,13 +100,14 @@ vec3 getRadiance(vec3 worldNormal, vec3 towardsCamera)
       float nDotL = dot(worldNormal, towardsLight_);
 
       if(nDotL > 0.0){
-        reflectivity += (nDotL * maximumDiffuseReflectivity);
+        if(diffuseReflectionEnabled != 0)
+          reflectivity += (nDotL * maximumDiffuseReflectivity);
 
         vec3 h = normalize(towardsCamera + towardsLight_);
 
         float nDotH = dot(worldNormal, h);
 
-        if(nDotH > 0.0){
+        if(nDotH > 0.0 && specularReflectionEnabled != 0){
           reflectivity += (maximumSpecularReflectivity * pow(nDotH, specularExponent));
         }
       }
@@ -143,5 +160,5 @@ void main(void)
 #endif
 
     // the position transform is trivial
-    gl_Position = modelViewProjectionMatrix * vertexPosition;
+    gl_Position = viewProjectionMatrix * worldPosition4;
 }
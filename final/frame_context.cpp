@@ -0,0 +1,87 @@
+#include <limits>
+
+#include "frame_context.h"
+#include "view.h"
+
+
+FrameContext::FrameContext(const Transform &viewTransform_,
+                           const Transform &projectionTransform_,
+                           const bool useOrthographic_,
+                           const Vector3 &orthographicTowards_)
+    : useOrthographic(useOrthographic_),
+      orthographicTowards(orthographicTowards_),
+      viewTransform(viewTransform_),
+      projectionTransform(projectionTransform_)
+{
+    viewProjectionTransform = projectionTransform * viewTransform;
+
+    // The camera sits at the camera coordinate origin.
+    eye = Transform(viewTransform.inverse()) * Point3(0.0, 0.0, 0.0);
+
+    //
+    // Extract the frustum planes from the rows of the view-projection
+    // matrix `m`: a world point is inside the viewing volume iff
+    // -w <= x, y, z <= w in clip coordinates, so each plane is the
+    // fourth row of `m` plus or minus one of the other three.
+    //
+    const Transform &m = viewProjectionTransform;
+    for (int i = 0; i < N_FRUSTUM_PLANES; i++) {
+        int row = i / 2; // x, y, or z
+        double sign = (i % 2 == 0) ? 1.0 : -1.0; // left/bottom/near is +
+        double coeffs[4];
+
+        for (int j = 0; j < 4; j++)
+            coeffs[j] = m.a[m.ij(3, j)] + sign * m.a[m.ij(row, j)];
+
+        Vector3 normal(coeffs[0], coeffs[1], coeffs[2]);
+        double mag = normal.mag();
+        frustumPlanes[i].normal = Vector3(coeffs[0] / mag,
+                                          coeffs[1] / mag,
+                                          coeffs[2] / mag);
+        frustumPlanes[i].offset = coeffs[3] / mag;
+    }
+}
+
+
+const double FrameContext::pixelsPerUnit(const Point3 &center,
+                                         const double radius) const
+//
+// returns how many pixels a (world) unit length anywhere in a sphere
+// of `radius` at `center` (both in world coordinates) covers, at most,
+// on the screen (the largest double if the eye is in the sphere)
+//
+{
+    // (For either projection, element (1, 1) scales y into NDC.)
+    double result = 0.5 * view.canvasSize().u.g.y * projectionTransform.a[5];
+
+    if (!useOrthographic) {
+        double distance = (center - eye).mag() - radius;
+
+        if (distance <= 0.0)
+            return numeric_limits<double>::max();
+        result /= distance;
+    }
+    return result;
+}
+
+
+const bool FrameContext::sphereIsVisible(const Point3 &center,
+                                         const double radius) const
+//
+// returns false if a sphere of `radius` at `center` (both in world
+// coordinates) is entirely outside the viewing volume (true doesn't
+// guarantee it's visible, but it usually is)
+//
+{
+    for (int i = 0; i < N_FRUSTUM_PLANES; i++) {
+        const Vector3 &normal = frustumPlanes[i].normal;
+        double distance = normal.u.g.x * center.u.g.x
+                        + normal.u.g.y * center.u.g.y
+                        + normal.u.g.z * center.u.g.z
+                        + frustumPlanes[i].offset;
+
+        if (distance < -radius)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,65 @@
+#ifndef INCLUDED_FRAME_CONTEXT
+
+//
+// The "frame_context" module provides the FrameContext class (see
+// below).
+//
+
+#include "geometry.h"
+#include "transform.h"
+
+//
+// indices of FrameContext::frustumPlanes[]
+//
+enum {
+    LEFT_PLANE,
+    RIGHT_PLANE,
+    BOTTOM_PLANE,
+    TOP_PLANE,
+    NEAR_PLANE,
+    FAR_PLANE,
+    N_FRUSTUM_PLANES
+};
+
+
+class FrameContext
+//
+// everything about the camera that's needed to draw one frame
+//
+// Scene::display() gets one of these from Camera::frameContext() at
+// the start of each frame and passes it down to every display()
+// method, so nothing below it needs to (re-)evaluate the camera path
+// or (re-)multiply the camera transforms.
+//
+{
+public:
+    bool useOrthographic;
+    Point3 eye; // camera position in world coordinates (perspective only)
+    Vector3 orthographicTowards; // direction to the camera (orthographic only)
+    Transform viewTransform; // world to camera coordinates
+    Transform projectionTransform; // camera to clip coordinates
+    Transform viewProjectionTransform; // world to clip coordinates
+
+    //
+    // The viewing volume in world coordinates. A world point `p` is
+    // inside plane `i` if `frustumPlanes[i].normal.dot(p - origin) +
+    // frustumPlanes[i].offset >= 0`. The normals are unit length, so
+    // the left hand side is a distance.
+    //
+    struct {
+        Vector3 normal;
+        double offset;
+    } frustumPlanes[N_FRUSTUM_PLANES];
+
+    FrameContext(const Transform &viewTransform_,
+                 const Transform &projectionTransform_,
+                 const bool useOrthographic_,
+                 const Vector3 &orthographicTowards_);
+    const double pixelsPerUnit(const Point3 &center,
+                              const double radius) const;
+    const bool sphereIsVisible(const Point3 &center,
+                               const double radius) const;
+};
+
+#define INCLUDED_FRAME_CONTEXT
+#endif // INCLUDED_FRAME_CONTEXT
@@ -17,6 +17,9 @@ class GeometricalObject
 //
 {
 public:
+    // at least one older g++ compiler complains if this is missing
+    virtual ~GeometricalObject() { };
+
     virtual void draw(SceneObject *sceneObject) = 0;
     virtual void tessellate(void) = 0;
 };
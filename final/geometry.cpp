@@ -6,32 +6,37 @@
 using namespace std;
 
 #include "geometry.h"
+#include "matrix_kernels.h"
 #include "wrap_cmath_inclusion.h"
 
 #define CH_EOF (-1) // denotes end-of-file
 
 
 
-Vector3 faceNormal(const Point3 &p0, const Point3 &p1, const Point3 &p2)
+template <class Scalar>
+Vector3T<Scalar> faceNormal(const Point3T<Scalar> &p0,
+                            const Point3T<Scalar> &p1,
+                            const Point3T<Scalar> &p2)
 {
     //
     // Copy your previous (PA04) solution here.
     //
-    Vector3 v = p1 - p0;
-    Vector3 w = p2 - p0;
+    Vector3T<Scalar> v = p1 - p0;
+    Vector3T<Scalar> w = p2 - p0;
 
     return v.cross(w);
 }
 
 
-Matrix4 Matrix4::inverse(void) const
+template <class Scalar>
+Matrix4T<Scalar> Matrix4T<Scalar>::inverse(void) const
 {
     const int n = 4;
-    double delta = 1.0; // the determinant *if* the matrix is nonsingular
+    Scalar delta = 1.0; // the determinant *if* the matrix is nonsingular
 
-    double b[n], c[n];
+    Scalar b[n], c[n];
     int z[n];
-    Matrix4 inv = *this;
+    Matrix4T inv = *this;
 
 	for (int j = 0; j < n; j++)
 		z[j] = j; // permutation vector
@@ -39,18 +44,19 @@ Matrix4 Matrix4::inverse(void) const
     // solve for inverse (with pivoting)
 	for (int i = 0; i < n; i++) {
 		int k = i;
-		double y = inv.a[inv.ij(i,i)];
+		Scalar y = inv.a[inv.ij(i,i)];
         // `k` is the pivot: the row between i+1 and n (inclusive)
         // with the largest diagonal element.
 		for (int j = i + 1; j < n; j++) {
-			double w = inv.a[ij(i,j)];
+			Scalar w = inv.a[ij(i,j)];
 			if (fabs(w) > fabs(y)) {
 				k = j;
 				y = w;
 			}
 		}
 		delta *= y;
-        assert(fabs(delta) > EPSILON); // otherwise, assume matrix is singular
+        // otherwise, assume matrix is singular
+        assert(fabs(delta) > ScalarTraits<Scalar>::epsilon());
 		y = 1.0 / y;
 		for (int j = 0; j < n; j++) {
 			c[j] = inv.a[ij(j,k)];
@@ -76,7 +82,7 @@ Matrix4 Matrix4::inverse(void) const
 	for (int i = 0; i < n; i++) {
 		for (int k = z[i]; k != i; k = z[i]) {
 			for (int j = 0; j < n; j++) {
-				double w = inv.a[ij(i,j)];
+				Scalar w = inv.a[ij(i,j)];
 				inv.a[ij(i,j)] = inv.a[ij(k,j)];
 				inv.a[ij(k,j)] = w;
 			}
@@ -89,9 +95,11 @@ Matrix4 Matrix4::inverse(void) const
 }
 
 
-const Matrix4 Matrix4::operator*(const Matrix4 &matrix) const
+template <class Scalar>
+const Matrix4T<Scalar> Matrix4T<Scalar>::operator*(
+    const Matrix4T<Scalar> &matrix) const
 {
-    Matrix4 result;
+    Matrix4T result;
 
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
@@ -103,9 +111,21 @@ const Matrix4 Matrix4::operator*(const Matrix4 &matrix) const
     return result;
 }
 
-Matrix4 Matrix4::transpose(void) const
+template <>
+const Matrix4T<double> Matrix4T<double>::operator*(
+    const Matrix4T<double> &matrix) const
 {
-    Matrix4 result;
+    Matrix4T result;
+
+    // (see the "matrix_kernels" module)
+    multiplyMatrix4s(a, matrix.a, result.a);
+    return result;
+}
+
+template <class Scalar>
+Matrix4T<Scalar> Matrix4T<Scalar>::transpose(void) const
+{
+    Matrix4T result;
 
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
@@ -116,6 +136,17 @@ Matrix4 Matrix4::transpose(void) const
 }
 
 
+// explicit instantiations for the scalar types we use
+template class Matrix4T<double>;
+template class Matrix4T<float>;
+template Vector3T<double> faceNormal(const Point3T<double> &p0,
+                                     const Point3T<double> &p1,
+                                     const Point3T<double> &p2);
+template Vector3T<float> faceNormal(const Point3T<float> &p0,
+                                    const Point3T<float> &p1,
+                                    const Point3T<float> &p2);
+
+
 vector<Point2> readPoint2s(string fname)
 //
 // Read a vector of Point2s from a (simplified) CSV file.
@@ -46,228 +46,224 @@ public:
 // might also, for instance, be applied to an RGB tuple.
 //
 
-class Point3 : public Vec3
+template <class Scalar>
+class Point3T : public Vec3T<Scalar>
 //
 // 3D point
 //
 {
 
 public:
+    using Vec3T<Scalar>::u;
+    using typename Vec3T<Scalar>::Arithmetic;
 
-    Point3(void)
-    : Vec3() {};
+    Point3T(void)
+    : Vec3T<Scalar>() {};
 
-    Point3(double x, double y, double z)
-    : Vec3(x, y, z) {};
+    Point3T(Scalar x, Scalar y, Scalar z)
+    : Vec3T<Scalar>(x, y, z) {};
 
-    Point3(double a[3])
-    : Vec3(a) {};
+    Point3T(const Scalar a[3])
+    : Vec3T<Scalar>(a) {};
+
+    // converts between precisions (e.g. from double to float for
+    // uploading to the GPU)
+    template <class OtherScalar>
+    explicit Point3T(const Point3T<OtherScalar> &p)
+    : Vec3T<Scalar>(p) {};
 
     // Point3 + Point3 -> Point3 (e.g. for computing midpoint)
     // compound operator
-    Point3 operator+=(const Point3 &p)
+    Point3T operator+=(const Point3T &p)
     {
-        u.a[0] += p.u.a[0];
-        u.a[1] += p.u.a[1];
-        u.a[2] += p.u.a[2];
+        Arithmetic::add(u.a, p.u.a);
         return *this;
     };
     // binary operator
-    const Point3 operator+(const Point3 &p) const
+    const Point3T operator+(const Point3T &p) const
     {
-        return Point3(*this) += p;
+        return Point3T(*this) += p;
     };
 
     // Point3 * Vec3 -> Point3
     // compound operator
-    Point3 operator*=(const Vec3 &vec)
+    Point3T operator*=(const Vec3T<Scalar> &vec)
     {
-        u.a[0] *= vec.u.a[0];
-        u.a[1] *= vec.u.a[1];
-        u.a[2] *= vec.u.a[2];
+        Arithmetic::multiply(u.a, vec.u.a);
         return *this;
     };
     // binary operator
-    const Point3 operator*(const Vec3 &vec) const
+    const Point3T operator*(const Vec3T<Scalar> &vec) const
     {
-        return Point3(*this) *= vec;
+        return Point3T(*this) *= vec;
     };
 
     // Point3 - offset -> Point3
     // compound operator
-    Point3 operator-=(const double offset)
+    Point3T operator-=(const Scalar offset)
     {
-        u.a[0] -= offset;
-        u.a[1] -= offset;
-        u.a[2] -= offset;
+        Arithmetic::addScalar(u.a, -offset);
         return *this;
     };
     // binary operator
-    const Point3 operator-(const double offset) const
+    const Point3T operator-(const Scalar offset) const
     {
-        return Point3(*this) -= offset;
+        return Point3T(*this) -= offset;
     };
 
     // Point3 * scalar -> Point3 (e.g. for computing centroid)
-    Point3 operator*=(const double scale)
+    Point3T operator*=(const Scalar scale)
     // compound operator
     {
-        u.a[0] *= scale;
-        u.a[1] *= scale;
-        u.a[2] *= scale;
+        Arithmetic::scale(u.a, scale);
         return *this;
     };
     // binary operator
-    const Point3 operator*(const double scale) const
+    const Point3T operator*(const Scalar scale) const
     {
-        return Point3(*this) *= scale;
+        return Point3T(*this) *= scale;
     };
 
     // Point3 / scalar -> Point3 (e.g. for computing centroid)
     // compound operator
-    Point3 operator/=(const double scale)
+    Point3T operator/=(const Scalar scale)
     {
-        u.a[0] /= scale;
-        u.a[1] /= scale;
-        u.a[2] /= scale;
+        Arithmetic::divide(u.a, scale);
         return *this;
     };
     // binary operator
-    const Point3 operator/(const double scale) const
+    const Point3T operator/(const Scalar scale) const
     {
-        return Point3(*this) /= scale;
+        return Point3T(*this) /= scale;
     };
 };
 
 
-class Vector3 : public Vec3
+template <class Scalar>
+class Vector3T : public Vec3T<Scalar>
 //
 // 3D vector
 //
 {
 
 public:
+    using Vec3T<Scalar>::u;
+    using typename Vec3T<Scalar>::Arithmetic;
+
+    Vector3T()
+    : Vec3T<Scalar>()
+    { };
 
-    Vector3()
-    : Vec3()
+    Vector3T(Scalar x, Scalar y, Scalar z)
+    : Vec3T<Scalar>(x, y, z)
     { };
 
-    Vector3(double x, double y, double z)
-    : Vec3(x, y, z)
+    Vector3T(const Scalar a[3])
+    : Vec3T<Scalar>(a)
     { };
 
-    Vector3(double a[3])
-    : Vec3(a)
+    // converts between precisions
+    template <class OtherScalar>
+    explicit Vector3T(const Vector3T<OtherScalar> &v)
+    : Vec3T<Scalar>(v)
     { };
 
     // Vector3 + Point3 -> Point3
     // binary operator
-    const Point3 operator+(const Point3 &p) const
+    const Point3T<Scalar> operator+(const Point3T<Scalar> &p) const
     {
-        return Point3(
-            u.g.x + p.u.g.x,
-            u.g.y + p.u.g.y,
-            u.g.z + p.u.g.z);
+        Point3T<Scalar> result(p);
+        Arithmetic::add(result.u.a, u.a); // commutativity
+        return result;
     };
 
     // Vector3 + Vector3 -> Vector3
     // compound operator
-    Vector3 operator+=(const Vector3 &v)
+    Vector3T operator+=(const Vector3T &v)
     {
-        u.a[0] += v.u.a[0];
-        u.a[1] += v.u.a[1];
-        u.a[2] += v.u.a[2];
+        Arithmetic::add(u.a, v.u.a);
         return *this;
     };
     // binary operator
-    const Vector3 operator+(const Vector3 &v) const
+    const Vector3T operator+(const Vector3T &v) const
     {
-        return Vector3(*this) += v;
+        return Vector3T(*this) += v;
     };
 
     // Vector3 - Vector3 -> Vector3
     // compound operator
-    Vector3 operator-=(const Vector3 &v)
+    Vector3T operator-=(const Vector3T &v)
     {
-        u.a[0] -= v.u.a[0];
-        u.a[1] -= v.u.a[1];
-        u.a[2] -= v.u.a[2];
+        Arithmetic::subtract(u.a, v.u.a);
         return *this;
     };
     // binary operator
-    const Vector3 operator-(const Vector3 &v) const
+    const Vector3T operator-(const Vector3T &v) const
     {
-        return Vector3(*this) -= v;
+        return Vector3T(*this) -= v;
     };
 
     // -Vector3 -> Vector3
-    const Vector3 operator-(void) const
+    const Vector3T operator-(void) const
     // unary operator
     {
-        return Vector3(
-            -u.g.x,
-            -u.g.y,
-            -u.g.z);
+        Vector3T result(*this);
+        Arithmetic::negate(result.u.a);
+        return result;
     };
 
     // Vector3 * Vec3 -> Vector3
     // compound operator
-    Vector3 operator*=(const Vec3 &vec)
+    Vector3T operator*=(const Vec3T<Scalar> &vec)
     {
-        u.a[0] *= vec.u.a[0];
-        u.a[1] *= vec.u.a[1];
-        u.a[2] *= vec.u.a[2];
+        Arithmetic::multiply(u.a, vec.u.a);
         return *this;
     };
     // binary operator
-    const Vector3 operator*(const Vec3 &vec) const
+    const Vector3T operator*(const Vec3T<Scalar> &vec) const
     {
-        return Vector3(*this) *= vec;
+        return Vector3T(*this) *= vec;
     };
 
     // Vector3 * scalar -> Vector3
     // compound operator
-    Vector3 operator*=(const double scale)
+    Vector3T operator*=(const Scalar scale)
     {
-        u.a[0] *= scale;
-        u.a[1] *= scale;
-        u.a[2] *= scale;
+        Arithmetic::scale(u.a, scale);
         return *this;
     };
     // binary operator
-    const Vector3 operator*(const double scale) const
+    const Vector3T operator*(const Scalar scale) const
     {
-        return Vector3(*this) *= scale;
+        return Vector3T(*this) *= scale;
     };
 
     // Vector3 / scalar -> Vector3
     // compound operator
-    Vector3 operator/=(const double scale)
+    Vector3T operator/=(const Scalar scale)
     {
-        u.a[0] /= scale;
-        u.a[1] /= scale;
-        u.a[2] /= scale;
+        Arithmetic::divide(u.a, scale);
         return *this;
     };
     // binary operator
-    const Vector3 operator/(const double scale) const
+    const Vector3T operator/(const Scalar scale) const
     {
-        return Vector3(*this) /= scale;
+        return Vector3T(*this) /= scale;
     };
 
 
-    const double dot(const Vector3 &other) const
+    const Scalar dot(const Vector3T &other) const
     {
-        return u.g.x*other.u.g.x + u.g.y*other.u.g.y + u.g.z*other.u.g.z;
+        return Arithmetic::dot(u.a, other.u.a);
     };
 
-    const double mag(void) const
+    const Scalar mag(void) const
     {
         // C++ oddness: remember that dot(*this) is actually this->dot(*this)
         return sqrt(dot(*this));
     };
 
-    const Vector3 normalized(void) const
+    const Vector3T normalized(void) const
     {
         //
         // Normalizing a near-zero vector in a graphics program is
@@ -276,8 +272,9 @@ public:
         // places where they are harder to isolate. You might even consider
         // propagating the assertion itself up the calling stack.
         //
-        double mag_ = mag();
-        assert(mag_ > EPSILON); // otherwise, something is likely to be wrong
+        Scalar mag_ = mag();
+        // otherwise, something is likely to be wrong
+        assert(mag_ > ScalarTraits<Scalar>::epsilon());
 
         // C++ oddness: remember that mag() is actually this->mag()
         return *this / mag_;
@@ -287,21 +284,28 @@ public:
     // Copy your previous (PA04) solution here.
     //
 
-    const Vector3 cross(const Vector3 &other) const
+    const Vector3T cross(const Vector3T &other) const
     {
-        double a1 = u.a[0];
-        double a2 = u.a[1];
-        double a3 = u.a[2];
-
-        double b1 = other.u.a[0];
-        double b2 = other.u.a[1];
-        double b3 = other.u.a[2];
+        Vector3T result;
 
-        return Vector3(a2*b3 - a3*b2, a3*b1 - a1*b3, a1*b2 - a2*b1);
+        Arithmetic::cross(u.a, other.u.a, result.u.a);
+        return result;
     };
 };
 
-Vector3 faceNormal(const Point3 &p0, const Point3 &p1, const Point3 &p2);
+template <class Scalar>
+Vector3T<Scalar> faceNormal(const Point3T<Scalar> &p0,
+                            const Point3T<Scalar> &p1,
+                            const Point3T<Scalar> &p2);
+
+//
+// the double precision (default) and single precision (for bulk data,
+// e.g. vertex buffers) versions of Point3T and Vector3T
+//
+typedef Point3T<double> Point3;
+typedef Point3T<float> Point3f;
+typedef Vector3T<double> Vector3;
+typedef Vector3T<float> Vector3f;
 
 
 // not a legal OBJ index (OK for textureIndex and normalIndex to be this)
@@ -352,51 +356,63 @@ const Vector3 vZ(0, 0, 1);
 //
 
 // Vec3 * Point3 -> Point3
-inline Point3 operator*(const Vec3 vec, const Point3 p)
+template <class Scalar>
+inline Point3T<Scalar> operator*(const Vec3T<Scalar> vec,
+                                 const Point3T<Scalar> p)
 {
     return p * vec; // commutativity
 }
 
 // Point3 + Vector3 -> Point3
-inline Point3 operator+(const Point3 p, const Vector3 v)
+template <class Scalar>
+inline Point3T<Scalar> operator+(const Point3T<Scalar> p,
+                                 const Vector3T<Scalar> v)
 {
     // Because we define Point3 before Vector3, I can't figure out a
     // way to make this a member of Point3.
-    return Point3(p.u.a[0] + v.u.a[0],
-                  p.u.a[1] + v.u.a[1],
-                  p.u.a[2] + v.u.a[2]);
+    Point3T<Scalar> result(p);
+    Vec3Arithmetic<Scalar>::add(result.u.a, v.u.a);
+    return result;
 }
 
 // Point3 - Vector3 -> Point3
-inline Point3 operator-(const Point3 p, const Vector3 v)
+template <class Scalar>
+inline Point3T<Scalar> operator-(const Point3T<Scalar> p,
+                                 const Vector3T<Scalar> v)
 {
     // Because we define Point3 before Vector3, I can't figure out a
     // way to make this a member of Point3.
-    return Point3(p.u.a[0] - v.u.a[0],
-                  p.u.a[1] - v.u.a[1],
-                  p.u.a[2] - v.u.a[2]);
+    Point3T<Scalar> result(p);
+    Vec3Arithmetic<Scalar>::subtract(result.u.a, v.u.a);
+    return result;
 }
 
 // Point3 - Point3 -> Vector3
-inline Vector3 operator-(const Point3 p0, const Point3 p1)
+template <class Scalar>
+inline Vector3T<Scalar> operator-(const Point3T<Scalar> p0,
+                                  const Point3T<Scalar> p1)
 {
     // Because we define Point3 before Vector3, I can't figure out a
     // way to make this a member of Point3.
     //
     // vector math says that the difference of two points is a vector
-    return Vector3(p0.u.a[0] - p1.u.a[0],
-                   p0.u.a[1] - p1.u.a[1],
-                   p0.u.a[2] - p1.u.a[2]);
+    Vector3T<Scalar> result(p0.u.a);
+    Vec3Arithmetic<Scalar>::subtract(result.u.a, p1.u.a);
+    return result;
 }
 
 // scalar * Point3 -> Point3
-inline Point3 operator*(const double scale, const Point3 p)
+template <class Scalar>
+inline Point3T<Scalar> operator*(const typename NonDeduced<Scalar>::type scale,
+                                 const Point3T<Scalar> p)
 {
     return p * scale; // commutativity
 }
 
 // scalar * Vector3 -> Vector3
-inline Vector3 operator*(const double scale, const Vector3 v)
+template <class Scalar>
+inline Vector3T<Scalar> operator*(
+    const typename NonDeduced<Scalar>::type scale, const Vector3T<Scalar> v)
 {
     return v * scale; // commutativity
 }
@@ -405,20 +421,23 @@ vector<Point2> readPoint2s(string fname);
 vector<Point3> readPoint3s(string fname);
 
 
-class Matrix4 : public Mat4
+template <class Scalar>
+class Matrix4T : public Mat4T<Scalar>
 //
 // a 4x4 matrix
 //
 {
 
 public:
+    using Mat4T<Scalar>::a;
+    using Mat4T<Scalar>::ij;
 
-Matrix4()
-    : Mat4()
+Matrix4T()
+    : Mat4T<Scalar>()
     { };
 
     // This constructor assumes matrices are in OpenGL order
-    Matrix4(const double a_[16]) {
+    Matrix4T(const Scalar a_[16]) {
         for (int i = 0; i < 16; i++)
             a[i] = a_[i];
     };
@@ -426,11 +445,11 @@ Matrix4()
     // Notice that this prototype follows the OpenGL naming convention
     // and allows you to enter matrices from OpenGL matrices verbatim,
     // which normal C/C++ code does not.
-    Matrix4(
-        double m_1, double m_5, double  m_9, double m_13,
-        double m_2, double m_6, double m_10, double m_14,
-        double m_3, double m_7, double m_11, double m_15,
-        double m_4, double m_8, double m_12, double m_16)
+    Matrix4T(
+        Scalar m_1, Scalar m_5, Scalar  m_9, Scalar m_13,
+        Scalar m_2, Scalar m_6, Scalar m_10, Scalar m_14,
+        Scalar m_3, Scalar m_7, Scalar m_11, Scalar m_15,
+        Scalar m_4, Scalar m_8, Scalar m_12, Scalar m_16)
     {
         a[0] = m_1; a[4] = m_5; a[8]  =  m_9; a[12] = m_13;
         a[1] = m_2; a[5] = m_6; a[9]  = m_10; a[13] = m_14;
@@ -438,11 +457,27 @@ Matrix4()
         a[3] = m_4; a[7] = m_8; a[11] = m_12; a[15] = m_16;
     };
 
-    Matrix4 inverse(void) const;
-    const Matrix4 operator*(const Matrix4 &matrix) const;
-    Matrix4 transpose(void) const;
+    // converts between precisions
+    template <class OtherScalar>
+    explicit Matrix4T(const Matrix4T<OtherScalar> &matrix)
+    {
+        for (int i = 0; i < 16; i++)
+            a[i] = static_cast<Scalar>(matrix.a[i]);
+    };
+
+    Matrix4T inverse(void) const;
+    const Matrix4T operator*(const Matrix4T &matrix) const;
+    Matrix4T transpose(void) const;
 };
 
+// (Double precision uses the "matrix_kernels" module.)
+template <>
+const Matrix4T<double> Matrix4T<double>::operator*(
+    const Matrix4T<double> &matrix) const;
+
+typedef Matrix4T<double> Matrix4;
+typedef Matrix4T<float> Matrix4f;
+
 
 #define INCLUDED_GEOMETRY
 #endif // INCLUDED_GEOMETRY
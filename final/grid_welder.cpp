@@ -0,0 +1,195 @@
+#include "grid_welder.h"
+
+
+GridWelder::GridWelder(const double tolerance, const int nVerticesExpected)
+    : pointGrid(tolerance, nVerticesExpected)
+{
+    normalSums.reserve(nVerticesExpected);
+}
+
+
+void GridWelder::add(const Point3f *positions, const Vector3f *normals,
+                     const int nI, const int nJ,
+                     const bool wrapI, const bool wrapJ)
+//
+// welds the nI x nJ (row-major in j) `positions` and `normals` into
+// the mesh and adds their triangles, connecting the last column
+// (row) to the first if `wrapI` (`wrapJ`)
+//
+{
+    vector<int> welded(nI * nJ); // grid vertex -> mesh vertex
+
+    for (int iVertex = 0; iVertex < nI * nJ; iVertex++) {
+        int jVertex = pointGrid.findNear(Point3(positions[iVertex]));
+
+        if (jVertex == NO_NEAR_POINT) {
+            jVertex = pointGrid.add(Point3(positions[iVertex]));
+            normalSums.push_back(Vector3());
+        }
+        normalSums[jVertex] += Vector3(normals[iVertex]);
+        welded[iVertex] = jVertex;
+    }
+
+    for (int j = 0; j < nJ + wrapJ - 1; j++) {
+        const int jUpper = (j + 1) % nJ;
+
+        for (int i = 0; i < nI + wrapI - 1; i++) {
+            const int iRight = (i + 1) % nI;
+            const int quad[4] = {
+                welded[j * nI + i],
+                welded[j * nI + iRight],
+                welded[jUpper * nI + iRight],
+                welded[jUpper * nI + i],
+            };
+            const int triangles[2][3] = {
+                { quad[0], quad[2], quad[3] },
+                { quad[0], quad[1], quad[2] },
+            };
+
+            for (int t = 0; t < 2; t++) {
+                const int *tri = triangles[t];
+
+                // Welding can collapse a sliver to an edge.
+                if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+                    continue;
+                for (int k = 0; k < 3; k++)
+                    vertexIndices.push_back(tri[k]);
+            }
+        }
+    }
+}
+
+
+void GridWelder::getMesh(Point3f *vertexPositions, Vector3f *vertexNormals,
+                         unsigned int *vertexIndices_) const
+//
+// copies the welded mesh into `vertexPositions` and `vertexNormals`
+// (nVertices() long) and `vertexIndices_` (3 * nFaces() long)
+//
+{
+    for (int iVertex = 0; iVertex < nVertices(); iVertex++) {
+        vertexPositions[iVertex] = Point3f(pointGrid[iVertex]);
+        vertexNormals[iVertex] = Vector3f(normalSums[iVertex].normalized());
+    }
+    for (unsigned int k = 0; k < vertexIndices.size(); k++)
+        vertexIndices_[k] = vertexIndices[k];
+}
+
+
+#ifdef TEST
+//
+// welds an 8 x 8 tessellation of each of the teapot's 32 Bezier
+// patches (as the Teapot does) and checks that the vertices shared
+// along their seams are exactly the ones a brute force search finds
+//
+#include <cstdlib>
+#include <iostream>
+#include <math.h> // for fabs()
+
+#include "basis.h"
+#include "teapot_cvs.h"
+
+// (as in the "surface" module)
+static const double tolerance = 1.0e-6;
+
+// as the Teapot tessellates its patches
+static const int nI = 8;
+static const int nJ = 8;
+
+//
+// the number of vertices that coincide with another (earlier) one,
+// along the seams around and between the rings of patches making up
+// the rim, body, bottom, and lid and along the handle and spout (plus
+// two where the handle touches the body)
+//
+static const int N_TEAPOT_SHARED_VERTICES = 397;
+
+
+int main(int argc, char **argv)
+{
+    const BezierBasis basis;
+    const int nGridVertices = nI * nJ;
+    vector<Point3f> allPositions;
+    GridWelder welder(tolerance, nTeapotBezierPatches * nGridVertices);
+    int nFailures = 0;
+
+    for (int iPatch = 0; iPatch < nTeapotBezierPatches; iPatch++) {
+        Point3f positions[nI * nJ];
+        Vector3f normals[nI * nJ];
+
+        for (int j = 0; j < nJ; j++) {
+            double v = (double) j / (nJ - 1);
+            double v_bs[4], db_dvs[4];
+            basis(v, v_bs, &db_dvs);
+
+            for (int i = 0; i < nI; i++) {
+                double u = (double) i / (nI - 1);
+                double u_bs[4], db_dus[4];
+                basis(u, u_bs, &db_dus);
+
+                Vector3 p, dp_du, dp_dv; // (p relative to the origin)
+                for (int k = 0; k < 4; k++) {
+                    for (int l = 0; l < 4; l++) {
+                        Vector3 cv(teapotBezierPatches[iPatch][k][l].u.a);
+
+                        p += u_bs[k] * v_bs[l] * cv;
+                        dp_du += db_dus[k] * v_bs[l] * cv;
+                        dp_dv += u_bs[k] * db_dvs[l] * cv;
+                    }
+                }
+                positions[j * nI + i] = Point3f(Point3(p.u.a));
+                normals[j * nI + i] = Vector3f(dp_dv.cross(dp_du));
+                allPositions.push_back(positions[j * nI + i]);
+            }
+        }
+        welder.add(positions, normals, nI, nJ, false, false);
+    }
+
+    // brute force: a vertex is shared if an earlier one is near it
+    int nShared = 0;
+    for (unsigned int iVertex = 0; iVertex < allPositions.size(); iVertex++) {
+        const Point3f &p = allPositions[iVertex];
+
+        for (unsigned int jVertex = 0; jVertex < iVertex; jVertex++) {
+            const Point3f &q = allPositions[jVertex];
+
+            if (   fabs(p.u.g.x - q.u.g.x) < tolerance
+                && fabs(p.u.g.y - q.u.g.y) < tolerance
+                && fabs(p.u.g.z - q.u.g.z) < tolerance) {
+                nShared++;
+                break;
+            }
+        }
+    }
+
+    const int nWelded = allPositions.size() - welder.nVertices();
+    cout << allPositions.size() << " vertices, " << welder.nVertices()
+         << " after welding (" << nWelded << " shared, "
+         << nShared << " by brute force), " << welder.nFaces()
+         << " triangles\n";
+    if (nWelded != nShared || nWelded != N_TEAPOT_SHARED_VERTICES) {
+        cerr << "expected " << N_TEAPOT_SHARED_VERTICES
+             << " shared vertices\n";
+        nFailures++;
+    }
+
+    // Every index must refer to a welded vertex.
+    vector<Point3f> vertexPositions(welder.nVertices());
+    vector<Vector3f> vertexNormals(welder.nVertices());
+    vector<unsigned int> vertexIndices(3 * welder.nFaces());
+    welder.getMesh(&vertexPositions[0], &vertexNormals[0],
+                   &vertexIndices[0]);
+    for (unsigned int k = 0; k < vertexIndices.size(); k++) {
+        if (vertexIndices[k] >= vertexPositions.size()) {
+            cerr << "vertex index " << vertexIndices[k] << " out of range\n";
+            nFailures++;
+            break;
+        }
+    }
+
+    if (nFailures > 0) {
+        cerr << nFailures << " failures\n";
+        exit(EXIT_FAILURE);
+    }
+}
+#endif // TEST
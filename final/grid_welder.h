@@ -0,0 +1,49 @@
+#ifndef INCLUDED_GRID_WELDER
+
+//
+// The "grid_welder" module provides the GridWelder class (see below).
+//
+
+#include <vector>
+
+#include "geometry.h"
+#include "point_grid.h"
+
+using namespace std;
+
+
+class GridWelder
+//
+// welds grids of vertices (e.g. Surface tessellations) into a single
+// triangle mesh in which vertices that coincide along the seams
+// between them (or where a grid degenerates to a point) are shared,
+// with their normals averaged
+//
+// Each grid is triangulated as it's added, two triangles per quad,
+// wound as RegularMesh's strips are. It's all CPU-side, so it can be
+// built (and tested) without OpenGL.
+//
+{
+    PointGrid pointGrid;
+    vector<Vector3> normalSums;
+    vector<unsigned int> vertexIndices;
+
+public:
+    GridWelder(const double tolerance, const int nVerticesExpected = 0);
+    void add(const Point3f *positions, const Vector3f *normals,
+             const int nI, const int nJ, const bool wrapI, const bool wrapJ);
+    void getMesh(Point3f *vertexPositions, Vector3f *vertexNormals,
+                 unsigned int *vertexIndices_) const;
+
+    const int nFaces(void) const
+    {
+        return vertexIndices.size() / 3;
+    };
+    const int nVertices(void) const
+    {
+        return pointGrid.nPoints();
+    };
+};
+
+#define INCLUDED_GRID_WELDER
+#endif // INCLUDED_GRID_WELDER
@@ -1,9 +1,13 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
 #include <math.h>
 
 #include "color.h"
 #include "controller.h"
 #include "ground.h"
 #include "height_field.h"
+#include "heightmap.h"
 #include "n_elem.h"
 #include "scene.h"
 #include "shader_programs.h"
@@ -21,8 +25,34 @@ const double gaussian(const double x, const double y,
 }
 
 
-// ground global used in position()
+string heightmapFname = "";
+
+// ground globals used in position()
 static double extent_ = 2.0; // actually set in constructor
+static Heightmap *heightmap = NULL; // (read from `heightmapFname`, if set)
+
+// height (in NDC) of a heightmap's highest possible sample
+static const double HEIGHTMAP_RELIEF = 4.0;
+
+//
+// Ground samples its height this many times along each side
+// (at a spacing of extent / 256, bilinear interpolation is within a few
+// thousandths of the hills' exact height).
+//
+static const int N_GROUND_SAMPLES = 257;
+
+//
+// With adaptive tessellation enabled, the Ground is drawn as a Terrain
+// of this many tiles on a side (each TERRAIN_TILE_QUADS quads on a
+// side).
+//
+static const int N_TERRAIN_TILES = 32;
+
+//
+// A heightmap's Terrain streams its tiles, keeping at most this many
+// (about 30 MB of vertex data) on the GPU.
+//
+static const int N_CACHED_TERRAIN_TILES = 1024;
 
 static struct {
     double u0, v0;
@@ -45,6 +75,12 @@ static const Point3 position(const double u, const double v)
     double x = extent_ * (u - 0.5);
     double y = extent_ * (v - 0.5);
 
+    if (heightmap) {
+        double dh_du, dh_dv; // (ignored)
+        return Point3(x, y,
+                      HEIGHTMAP_RELIEF * heightmap->height(u, v, dh_du, dh_dv));
+    }
+
     double zSum = 0.0;
     for (unsigned int i = 0; i < N_ELEM(hills); i++) {
         double sigma = hills[i].rHalf / log(2.0);
@@ -57,8 +93,47 @@ static const Point3 position(const double u, const double v)
 }
 
 
+static const Point3 positionAndPartials(const double u, const double v,
+                                        Vector3 &dp_du, Vector3 &dp_dv)
+//
+// returns position(u, v) and its exact partial derivatives
+//
+{
+    double x = extent_ * (u - 0.5);
+    double y = extent_ * (v - 0.5);
 
-void Ground::display(const Transform &viewProjectionTransform,
+    if (heightmap) {
+        double dh_du, dh_dv;
+        double h = heightmap->height(u, v, dh_du, dh_dv);
+
+        dp_du = Vector3(extent_, 0.0, HEIGHTMAP_RELIEF * dh_du);
+        dp_dv = Vector3(0.0, extent_, HEIGHTMAP_RELIEF * dh_dv);
+        return Point3(x, y, HEIGHTMAP_RELIEF * h);
+    }
+
+    double zSum = 0.0;
+    double dz_dx = 0.0;
+    double dz_dy = 0.0;
+    for (unsigned int i = 0; i < N_ELEM(hills); i++) {
+        double sigma = hills[i].rHalf / log(2.0);
+        double dx = x - extent_ * (hills[i].u0 - 0.5);
+        double dy = y - extent_ * (hills[i].v0 - 0.5);
+        double z = hills[i].height
+            * exp(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+
+        zSum += z;
+        dz_dx -= z * dx / (sigma * sigma);
+        dz_dy -= z * dy / (sigma * sigma);
+    }
+
+    dp_du = Vector3(extent_, 0.0, extent_ * dz_dx);
+    dp_dv = Vector3(0.0, extent_, extent_ * dz_dy);
+    return Point3(x, y, zSum);
+}
+
+
+
+void Ground::display(const FrameContext &frameContext,
                      Transform worldTransform)
 {
     if (!heightField->tessellationMesh) {
@@ -66,50 +141,129 @@ void Ground::display(const Transform &viewProjectionTransform,
         addHedgehogs(heightField->tessellationMesh);
     }
 
-    //
-    // A grassy Ground should have a dark greenish Diffuse + Ambient
-    // reflectance.
-    //
-    Rgb ambDiffBaseRgb(.1,.4,.1);
     if (scene->eadsShaderProgram) { // will be NULL in the template
-        scene->eadsShaderProgram->setEmittance(blackColor);
-        scene->eadsShaderProgram->setAmbient(0.2 * ambDiffBaseRgb);
-        scene->eadsShaderProgram->setDiffuse(0.8 * ambDiffBaseRgb);
-        scene->eadsShaderProgram->setSpecular(blackRgb, 0.0);
-        scene->eadsShaderProgram->setModelViewProjectionMatrix(
-            viewProjectionTransform * worldTransform);
+        scene->eadsShaderProgram->setMaterial(material);
         scene->eadsShaderProgram->setWorldMatrix(worldTransform);
         scene->eadsShaderProgram->setNormalMatrix(
             worldTransform.getNormalTransform());
         scene->eadsShaderProgram->start();
     }
-    heightField->tessellationMesh->render();
+    //
+    // With adaptive tessellation, only the tiles in view are drawn, each
+    // at the level of detail its distance requires. (The nominal
+    // tessellation is still made, for the hedgehogs, and drawn instead
+    // if OpenGL can't draw a Terrain.)
+    //
+    if (controller.adaptiveTessellationEnabled && Terrain::isSupported()) {
+        if (!terrain && heightmap) {
+            int nSamples = max(heightmap->nColumns(), heightmap->nRows());
+            int nTiles = (nSamples - 1 + TERRAIN_TILE_QUADS - 1)
+                / TERRAIN_TILE_QUADS;
+
+            terrain = new Terrain(positionAndPartials, nTiles,
+                                  N_CACHED_TERRAIN_TILES,
+                                  0.0, HEIGHTMAP_RELIEF);
+        } else if (!terrain)
+            terrain = new Terrain(positionAndPartials, N_TERRAIN_TILES);
+        terrain->update(frameContext, worldTransform);
+        terrain->render();
+    } else
+        heightField->tessellationMesh->render();
 
     const double quillLength = 0.02;
-    displayHedgehogs(viewProjectionTransform, worldTransform,
+    displayHedgehogs(frameContext, worldTransform,
             quillLength);
 }
 
 
 Ground::Ground(const double extent)
+    : terrain(NULL)
 {
     // The ground is wider, so we need a larger mesh for it.
     int nI = 101;
     int nJ = 101;
     extent_ = extent;
 
-    heightField = new HeightField(position, nI, nJ);
+    if (!heightmapFname.empty()) {
+        heightmap = Heightmap::read(heightmapFname);
+        if (!heightmap) {
+            cerr << "Unable to use \"" << heightmapFname
+                 << "\" as a heightmap -- exiting\n";
+            exit(EXIT_FAILURE);
+        }
+    }
+    heightField = new HeightField(position, nI, nJ, positionAndPartials);
+
+    // (A heightmap is already a grid, so height() uses it.)
+    if (!heightmap) {
+        heightSamples.resize(N_GROUND_SAMPLES * N_GROUND_SAMPLES);
+        for (int j = 0; j < N_GROUND_SAMPLES; j++) {
+            double v = (double) j / (N_GROUND_SAMPLES - 1);
+
+            for (int i = 0; i < N_GROUND_SAMPLES; i++) {
+                double u = (double) i / (N_GROUND_SAMPLES - 1);
+
+                heightSamples[j * N_GROUND_SAMPLES + i]
+                    = position(u, v).u.g.z;
+            }
+        }
+    }
+
+    //
+    // A grassy Ground should have a dark greenish Diffuse + Ambient
+    // reflectance.
+    //
+    Rgb ambDiffBaseRgb(.1,.4,.1);
+    material = new Material(blackColor,
+                            0.2 * ambDiffBaseRgb,
+                            0.8 * ambDiffBaseRgb,
+                            blackRgb, 0.0);
+}
+
+
+Ground::~Ground()
+{
+    delete terrain; // (before the heightmap its worker thread may use)
+    delete heightField;
+    delete material;
+    delete heightmap;
+    heightmap = NULL;
+}
+
+
+void Ground::gridCell(const double x, const double y,
+                      int &i, int &j, double &s, double &t) const
+//
+// helper: sets (`i`, `j`) to the lower left corner of the sample grid
+// cell containing (`x`, `y`) (clamped to the Ground) and (`s`, `t`) to
+// the fractional position within it
+//
+{
+    const int nCells = N_GROUND_SAMPLES - 1;
+    double fI = min(max((x / extent_ + 0.5) * nCells, 0.0), (double) nCells);
+    double fJ = min(max((y / extent_ + 0.5) * nCells, 0.0), (double) nCells);
+
+    i = min((int) fI, nCells - 1);
+    j = min((int) fJ, nCells - 1);
+    s = fI - i;
+    t = fJ - j;
 }
 
 
 const double Ground::height(const double x, const double y) const
+//
+// returns the height of the Ground at (`x`, `y`) (NDC), interpolated
+// from the sample grid (or the heightmap)
+//
 {
-    //
-    // Undo the uv -> xy mapping that operator() does and then call
-    // it to return the Point3 in NDC.
-    //
-    Vector3 dp_du, dp_dv; // ignored
-    Point3 p = (*heightField)((x / extent_) + 0.5, (y / extent_) + 0.5,
-                              dp_du, dp_dv);
-    return p.u.g.z;
+    if (heightmap)
+        return position(x / extent_ + 0.5, y / extent_ + 0.5).u.g.z;
+
+    int i, j;
+    double s, t;
+
+    gridCell(x, y, i, j, s, t);
+    const double *h = &heightSamples[j * N_GROUND_SAMPLES + i];
+    return (1 - t) * ((1 - s) * h[0] + s * h[1])
+        + t * ((1 - s) * h[N_GROUND_SAMPLES] + s * h[N_GROUND_SAMPLES + 1]);
 }
@@ -4,22 +4,46 @@
 // The "ground" module provides the Ground class (see below).
 //
 
+#include <string>
+#include <vector>
+
 #include "height_field.h"
+#include "material.h"
 #include "scene_object.h"
 #include "shader_programs.h"
+#include "terrain.h"
 #include "transform.h"
 
+using namespace std;
+
+//
+// name of the heightmap file (see the "heightmap" module) to read the
+// Ground's shape from (if empty, it has built-in hills)
+//
+extern string heightmapFname;
+
 
 class Ground : public SceneObject
 //
 // a SceneObject representing the ground
 //
 {
+    Material *material;
+    Terrain *terrain; // (of `heightField`, created on first use)
+
+    // heights sampled on a square grid over the Ground, which height()
+    // interpolates
+    vector<double> heightSamples;
+
+    void gridCell(const double x, const double y,
+                  int &i, int &j, double &s, double &t) const;
+
 public:
     HeightField *heightField;
 
     Ground(double extent_);
-    void display(const Transform &viewProjectionTransform,
+    ~Ground();
+    void display(const FrameContext &frameContext,
                  Transform worldTransform);
     const double height(const double x, const double y) const;
 };
@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "check_gl.h"
 #include "controller.h"
 #include "hedgehog.h"
@@ -15,36 +16,70 @@
 static const double NORMAL_DOT_THRESHOLD = -5.0e-2;
 
 
-Hedgehog::Hedgehog(const Point3 *positions_, const Vector3 *normals_,
+Hedgehog::Hedgehog(const Point3f *positions_, const Vector3f *normals_,
                    int nQuills_, const Color &color_)
   : nQuills(nQuills_),
     color(color_)
 {
-    uniformColorShaderProgram = new UniformColorShaderProgram(
-        "UniformColorShaderProgram for hedgehog");
+    if (scene->hedgehogShaderProgram) {
+        //
+        // The geometry shader builds the quills, so the positions and
+        // normals only need to be sent to the GPU, once.
+        //
+        positions = NULL;
+        normals = NULL;
+        quillNormals = NULL;
+        lines = NULL;
+        CHECK_GL(glGenBuffers(1, &positionsBufferId));
+        CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, positionsBufferId));
+        CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                              nQuills * sizeof(positions_[0]),
+                              positions_, GL_STATIC_DRAW));
+        CHECK_GL(glGenBuffers(1, &normalsBufferId));
+        CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, normalsBufferId));
+        CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                              nQuills * sizeof(normals_[0]),
+                              normals_, GL_STATIC_DRAW));
+        return;
+    }
 
     // save positions and normals
-    positions = new Point3[nQuills];
-    normals = new Vector3[nQuills];
+    positions = newArray<Point3f>(nQuills);
+    normals = newArray<Vector3f>(nQuills);
+    quillNormals = newArray<Vector3f>(nQuills); // set at draw time
     for (int i = 0; i < nQuills; i++) {
         positions[i] = positions_[i];
         normals[i] = normals_[i];
     }
 
-    // initialize the Lines object
-    Point3 (*vertexPositions)[2] = new Point3[nQuills][2];
-    vertexPositions = new Point3[nQuills][2];
+    // initialize the Lines object (which takes over `vertexPositions`)
+    Point3f (*vertexPositions)[2] = newArray<Point3f[2]>(nQuills);
     for (int i = 0; i < nQuills; i++) {
         // These will be set at draw time.
         vertexPositions[i][0] = positions_[i];
         vertexPositions[i][1] = positions_[i];
     }
-    lines = new Lines(vertexPositions, nQuills);
-    delete [] vertexPositions;
+    lines = new Lines(vertexPositions, nQuills, ADOPT_ARRAYS,
+                      STREAMED_VERTEX_DATA);
 }
 
 
-static bool showQuillVector(const Vector3 &quillVector, const Vector3 &normal)
+Hedgehog::~Hedgehog()
+{
+    if (lines == NULL) {
+        CHECK_GL(glDeleteBuffers(1, &positionsBufferId));
+        CHECK_GL(glDeleteBuffers(1, &normalsBufferId));
+        return;
+    }
+    deleteArray(positions);
+    deleteArray(normals);
+    deleteArray(quillNormals);
+    delete lines;
+}
+
+
+static bool showQuillVector(const Vector3f &quillVector,
+                            const Vector3f &normal)
 //
 // returns true iff a quill vector should be shown
 //
@@ -65,14 +100,15 @@ static bool showQuillVector(const Vector3 &quillVector, const Vector3 &normal)
     }
 }
 
-void Hedgehog::draw(const Transform &viewProjectionTransform,
+void Hedgehog::draw(const FrameContext &frameContext,
                     Transform worldTransform, const double quillLength)
 {
-    Vector3 quillVector;
+    Vector3f quillVector;
+    Color quillColor;
 
     // All vertices (including the bases and ends of the quills) will
     // be transformed by this "base transform" in the vertex shader.
-    Transform baseTransform = viewProjectionTransform * worldTransform;
+    Transform baseTransform = frameContext.viewProjectionTransform * worldTransform;
 
     // Light directions (and therefore light quills), on the other
     // hand, are defined in the global frame, so they should not be
@@ -84,13 +120,11 @@ void Hedgehog::draw(const Transform &viewProjectionTransform,
     Transform lightQuillTransform = worldTransform.inverse();
     Transform normalQuillTransform
         = worldTransform.inverse() * worldTransform.getNormalTransform();
-    scene->uniformColorShaderProgram->setModelViewProjectionMatrix(
-        baseTransform);
 
     if (controller.normalHedgehogEnabled) {
         // The hedgehog is displaying normals, so use the intrinsic
         // hedgehog color.
-        scene->uniformColorShaderProgram->setColor(color);
+        quillColor = color;
     } else {
         // If the hedgehog is not displaying normals, it's displaying
         // the light vector given by the `iLight`th light, which we'll
@@ -100,23 +134,35 @@ void Hedgehog::draw(const Transform &viewProjectionTransform,
 
         // Set the quill color to the light color, overriding the
         // intrinsic hedgehog color.
-        scene->uniformColorShaderProgram->setColor(light->irradiance);
+        quillColor = light->irradiance;
 
         // Draw quills pointing towards the light.
-        quillVector = light->towards();
+        quillVector = Vector3f(light->towards());
         // see above -- only used if we're drawing light quills
-        quillVector = lightQuillTransform * quillVector;
+        quillVector = Vector3f(lightQuillTransform * Vector3(quillVector));
         // make sure it's unit length
         quillVector = quillVector.normalized();
     }
 
+    if (lines == NULL) {
+        drawOnGpu(baseTransform, normalQuillTransform, quillColor,
+                  quillVector, quillLength);
+        return;
+    }
+
+    scene->uniformColorShaderProgram->setModelViewProjectionMatrix(
+        baseTransform);
+    scene->uniformColorShaderProgram->setColor(quillColor);
+
     //
     // Since the directions of the quill vectors can change from frame
     // to frame, we need to update the buffers on every redraw, unlike
     // other objects.
     //
+    Transformf(normalQuillTransform).transformVectors(
+        normals, quillNormals, nQuills);
     for (int iQuill = 0; iQuill < nQuills; iQuill++) {
-        Vector3 quillNormal = normalQuillTransform * normals[iQuill];
+        const Vector3f &quillNormal = quillNormals[iQuill];
 
         // If we're looking at normals, set `quillVector` accordingly.
         // Otherwise, we'll use the value of `quillVector` we set
@@ -128,8 +174,8 @@ void Hedgehog::draw(const Transform &viewProjectionTransform,
         quillVector = quillVector.normalized(); // may not be necessary
         quillVector /= (viewTransform.inverse() * quillVector).mag();
 #endif
-        const Point3 start = positions[iQuill];
-        const Point3 end = start + quillLength * quillVector;
+        const Point3f start = positions[iQuill];
+        const Point3f end = start + quillLength * quillVector;
         lines->vertexPositions[iQuill][0] = start;
 
         // To not show a quill vector, set the quill to zero length.
@@ -145,3 +191,50 @@ void Hedgehog::draw(const Transform &viewProjectionTransform,
 
     return;
 }
+
+
+void Hedgehog::drawOnGpu(const Transform &baseTransform,
+                         const Transform &normalQuillTransform,
+                         const Color &quillColor,
+                         const Vector3f &lightQuillVector,
+                         const double quillLength)
+//
+// helper: has the HedgehogShaderProgram build and draw the quills
+// (with the same results as the rest of draw())
+//
+{
+    HedgehogShaderProgram *program = scene->hedgehogShaderProgram;
+
+    program->setModelViewProjectionMatrix(baseTransform);
+    program->setQuillNormalMatrix(normalQuillTransform);
+    program->setColor(quillColor);
+    program->setQuillLength(quillLength);
+    if (controller.normalHedgehogEnabled)
+        program->setNormalQuills();
+    else
+        program->setLightQuills(Vector3(lightQuillVector),
+                                NORMAL_DOT_THRESHOLD);
+    program->start();
+
+    GLint vpai = ShaderProgram::getCurrentAttributeIndex("vertexPosition");
+    GLint vnai = ShaderProgram::getCurrentAttributeIndex("vertexNormal");
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, positionsBufferId));
+    CHECK_GL(glEnableVertexAttribArray(vpai));
+    CHECK_GL(glVertexAttribPointer(vpai, 3, GL_FLOAT, GL_FALSE, 0,
+                                   BUFFER_OFFSET(0)));
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, normalsBufferId));
+    CHECK_GL(glEnableVertexAttribArray(vnai));
+    CHECK_GL(glVertexAttribPointer(vnai, 3, GL_FLOAT, GL_FALSE, 0,
+                                   BUFFER_OFFSET(0)));
+
+    // one point per quill
+    CHECK_GL(glDrawArrays(GL_POINTS, 0, nQuills));
+
+    // (Other drawing code assumes only the attributes it enables are.)
+    CHECK_GL(glDisableVertexAttribArray(vnai));
+    CHECK_GL(glDisableVertexAttribArray(vpai));
+
+    renderStats.ctLines += nQuills;
+    renderStats.ctVertices += 2 * nQuills;
+}
@@ -5,6 +5,7 @@
 //
 
 #include "color.h"
+#include "frame_context.h"
 #include "lines.h"
 #include "geometry.h"
 #include "shader_programs.h"
@@ -18,23 +19,35 @@ class Hedgehog
 // SceneObject-GeometricalObject-Tessellation taxonomy. They're a
 // little of each.
 //
+// When it can, a Hedgehog has the Scene's HedgehogShaderProgram build
+// its quills on the GPU. Otherwise it computes them itself and draws
+// them with the Scene's UniformColorShaderProgram.
+//
 {
-    Point3 *positions;
-    Vector3 *normals;
+    Point3f *positions;
+    Vector3f *normals;
+    Vector3f *quillNormals; // `normals`, transformed for drawing
     int nQuills;
 
     Color color;
 
-    Lines *lines;
-    unsigned int vertexPositionsBufferId;
-    UniformColorShaderProgram *uniformColorShaderProgram;
-    void allocateBuffers(void);
-    void updateBuffers(void);
+    Lines *lines; // NULL iff the quills are drawn on the GPU
+
+    // used only when the quills are drawn on the GPU
+    unsigned int positionsBufferId;
+    unsigned int normalsBufferId;
+
+    void drawOnGpu(const Transform &baseTransform,
+                   const Transform &normalQuillTransform,
+                   const Color &quillColor,
+                   const Vector3f &lightQuillVector,
+                   const double quillLength);
 
 public:
-    Hedgehog(const Point3 *positions_, const Vector3 *normals_, int nVertices_,
-             const Color &color);
-    void draw(const Transform &viewProjectionTransform,
+    Hedgehog(const Point3f *positions_, const Vector3f *normals_,
+             int nVertices_, const Color &color);
+    ~Hedgehog();
+    void draw(const FrameContext &frameContext,
               Transform worldTransform, const double quillLength);
 };
 
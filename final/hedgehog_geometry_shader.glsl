@@ -0,0 +1,60 @@
+#version 330
+
+//
+// geometry shader that turns each point (a quill base and its
+// surface normal) into a hedgehog quill: a line segment along the
+// normal or towards a light
+//
+
+layout(points) in;
+layout(line_strip, max_vertices = 2) out;
+
+uniform vec3 color;
+uniform mat4 modelViewProjectionMatrix;
+
+// transforms model normals into quill directions (in model coordinates)
+uniform mat3 quillNormalMatrix;
+
+// the direction (in model coordinates) of a light quill (if any)
+uniform vec3 lightQuillVector;
+
+uniform float quillLength;
+
+// Light quills on faces whose normals dotted into the light direction
+// are smaller than this aren't drawn.
+uniform float normalDotThreshold;
+
+// 1 (true) for normal quills, 0 (false) for light quills
+uniform int showNormals;
+
+in vec3 normal[];
+
+smooth out vec4 interpolatedColor;
+
+void main(void)
+{
+    vec3 quillNormal = quillNormalMatrix * normal[0];
+    vec3 quillVector;
+
+    if (showNormals != 0) {
+        quillVector = normalize(quillNormal);
+    } else {
+        // The light doesn't contribute, so don't show the quill.
+        if (dot(quillNormal, lightQuillVector) < normalDotThreshold)
+            return;
+        quillVector = lightQuillVector;
+    }
+
+    vec4 start = gl_in[0].gl_Position;
+    vec4 end = vec4(start.xyz + quillLength * quillVector, start.w);
+
+    gl_Position = modelViewProjectionMatrix * start;
+    interpolatedColor = vec4(color, 1.0);
+    EmitVertex();
+
+    gl_Position = modelViewProjectionMatrix * end;
+    interpolatedColor = vec4(color, 1.0);
+    EmitVertex();
+
+    EndPrimitive();
+}
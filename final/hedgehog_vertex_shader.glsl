@@ -0,0 +1,20 @@
+#version 330
+
+//
+// vertex shader for hedgehogs drawn by "hedgehog_geometry_shader.glsl"
+//
+// Each vertex is the base of one quill. Everything is left in model
+// coordinates for the geometry shader.
+//
+
+// per-vertex inputs
+in vec4 vertexPosition;
+in vec3 vertexNormal;
+
+out vec3 normal;
+
+void main(void)
+{
+    gl_Position = vertexPosition;
+    normal = vertexNormal;
+}
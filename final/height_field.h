@@ -14,13 +14,25 @@ class HeightField : public Surface
 {
 private:
     const Point3 (*position)(const double u, const double v);
+    const Point3 (*positionAndPartials)(const double u, const double v,
+                                        Vector3 &dp_du, Vector3 &dp_dv);
 
 public:
     HeightField(const Point3 (*position_)(const double u, const double v),
-                int nI, int nJ)
+                int nI, int nJ,
+                const Point3 (*positionAndPartials_)(
+                    const double u, const double v,
+                    Vector3 &dp_du, Vector3 &dp_dv) = NULL)
         : Surface(nI, nJ, false, false),
-          position(position_)
+          position(position_),
+          positionAndPartials(positionAndPartials_)
     { };
+    //
+    // `positionAndPartials_`, if given, returns the same point as
+    // `position_` along with its exact partial derivatives, which are
+    // otherwise approximated by central differences (at the cost of
+    // four more calls to `position_`).
+    //
 
     const Point3 operator()(const double u, const double v,
                             Vector3 &dp_du, Vector3 &dp_dv) const;
@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "heightmap.h"
+
+
+Heightmap::Heightmap(void)
+    : samples(NULL), nI(0), nJ(0), bytesPerSample(0), maxValue(0.0),
+      isBigEndian(false), mapping(NULL), mappingSize(0)
+{
+}
+
+
+Heightmap::~Heightmap()
+{
+#if !defined(_WIN32)
+    if (mapping)
+        munmap(mapping, mappingSize);
+#endif
+}
+
+
+const double Heightmap::height(const double u, const double v,
+                               double &dh_du, double &dh_dv) const
+//
+// returns the height at (`u`, `v`), bilinearly interpolated between
+// samples, and sets `dh_du` and `dh_dv` to its partial derivatives
+//
+// The derivatives are interpolated the same way from central
+// differences at the samples, so they're continuous (and so are
+// normals computed from them), unlike the slopes of the interpolated
+// heights themselves.
+//
+{
+    const double fI = min(max(u, 0.0), 1.0) * (nI - 1);
+    const double fJ = min(max(v, 0.0), 1.0) * (nJ - 1);
+    const int i = min((int) fI, nI - 2);
+    const int j = min((int) fJ, nJ - 2);
+    const double s = fI - i;
+    const double t = fJ - j;
+    double h = 0.0;
+    double dh_dI = 0.0;
+    double dh_dJ = 0.0;
+
+    for (int dj = 0; dj <= 1; dj++) {
+        for (int di = 0; di <= 1; di++) {
+            const double weight = (di ? s : 1 - s) * (dj ? t : 1 - t);
+            const int iCorner = i + di;
+            const int jCorner = j + dj;
+
+            h += weight * sample(iCorner, jCorner);
+            dh_dI += weight * 0.5 * (sample(iCorner + 1, jCorner)
+                                     - sample(iCorner - 1, jCorner));
+            dh_dJ += weight * 0.5 * (sample(iCorner, jCorner + 1)
+                                     - sample(iCorner, jCorner - 1));
+        }
+    }
+    dh_du = dh_dI * (nI - 1);
+    dh_dv = dh_dJ * (nJ - 1);
+    return h;
+}
+
+
+static const bool parsePgmHeader(const unsigned char *bytes, const size_t size,
+                                 size_t &offset, long values[3])
+//
+// helper: parses the width, height, and maximum value of a binary PGM
+// file's header (after its "P5") into `values` and sets `offset` to the
+// first byte of its samples, returning false if the header is invalid
+//
+{
+    size_t pos = 2; // (past the "P5")
+
+    for (int k = 0; k < 3; k++) {
+        // Whitespace and comments (to the end of the line) are skipped.
+        while (pos < size && (isspace(bytes[pos]) || bytes[pos] == '#')) {
+            if (bytes[pos] == '#')
+                while (pos < size && bytes[pos] != '\n')
+                    pos++;
+            else
+                pos++;
+        }
+        if (pos >= size || !isdigit(bytes[pos]))
+            return false;
+        values[k] = 0;
+        while (pos < size && isdigit(bytes[pos])) {
+            values[k] = 10 * values[k] + (bytes[pos++] - '0');
+            if (values[k] > (1L << 30))
+                return false;
+        }
+    }
+    // Exactly one whitespace character precedes the samples.
+    if (pos >= size || !isspace(bytes[pos]))
+        return false;
+    offset = pos + 1;
+    return true;
+}
+
+
+Heightmap *Heightmap::read(const string &fname)
+//
+// returns a new Heightmap of the file `fname`, or NULL (after reporting
+// why on cerr) if it can't be read
+//
+{
+    Heightmap *heightmap = new Heightmap();
+
+#if defined(_WIN32)
+    ifstream in(fname.c_str(), ios::binary);
+
+    if (!in) {
+        cerr << "Unable to open heightmap file \"" << fname << "\"\n";
+        delete heightmap;
+        return NULL;
+    }
+    heightmap->contents.assign(istreambuf_iterator<char>(in),
+                               istreambuf_iterator<char>());
+    heightmap->mappingSize = heightmap->contents.size();
+    const unsigned char *bytes = heightmap->contents.empty()
+        ? NULL : &heightmap->contents[0];
+#else
+    int fd = open(fname.c_str(), O_RDONLY);
+    struct stat status;
+
+    if (fd < 0 || fstat(fd, &status) < 0) {
+        cerr << "Unable to open heightmap file \"" << fname << "\"\n";
+        if (fd >= 0)
+            close(fd);
+        delete heightmap;
+        return NULL;
+    }
+    heightmap->mappingSize = status.st_size;
+    if (heightmap->mappingSize > 0) {
+        void *address = mmap(NULL, heightmap->mappingSize, PROT_READ,
+                             MAP_PRIVATE, fd, 0);
+
+        if (address == MAP_FAILED) {
+            cerr << "Unable to map heightmap file \"" << fname << "\"\n";
+            close(fd);
+            delete heightmap;
+            return NULL;
+        }
+        heightmap->mapping = (unsigned char *) address;
+    }
+    close(fd); // (The mapping remains.)
+    const unsigned char *bytes = heightmap->mapping;
+#endif
+
+    const size_t size = heightmap->mappingSize;
+    size_t sampleBytes; // available after the header
+
+    if (size >= 2 && bytes[0] == 'P' && bytes[1] == '5') {
+        size_t offset;
+        long values[3]; // width, height, and maximum value
+
+        if (!parsePgmHeader(bytes, size, offset, values)
+                || values[2] <= 0 || values[2] > 65535) {
+            cerr << "Invalid PGM header in heightmap file \"" << fname
+                 << "\"\n";
+            delete heightmap;
+            return NULL;
+        }
+        heightmap->samples = bytes + offset;
+        heightmap->nI = values[0];
+        heightmap->nJ = values[1];
+        heightmap->maxValue = values[2];
+        heightmap->bytesPerSample = (values[2] < 256) ? 1 : 2;
+        heightmap->isBigEndian = true;
+        sampleBytes = size - offset;
+    } else {
+        // Raw files have no header, so they have to be square.
+        const size_t nSamples = size / 2;
+        const int side = (int) floor(sqrt((double) nSamples) + 0.5);
+
+        if (size % 2 != 0 || (size_t) side * side != nSamples) {
+            cerr << "Heightmap file \"" << fname << "\" is neither a PGM"
+                 << " file nor a square grid of 16-bit samples\n";
+            delete heightmap;
+            return NULL;
+        }
+        heightmap->samples = bytes;
+        heightmap->nI = heightmap->nJ = side;
+        heightmap->maxValue = 65535;
+        heightmap->bytesPerSample = 2;
+        heightmap->isBigEndian = false;
+        sampleBytes = size;
+    }
+
+    if (heightmap->nI < 2 || heightmap->nJ < 2
+            || (size_t) heightmap->nI * heightmap->nJ
+                   * heightmap->bytesPerSample > sampleBytes) {
+        cerr << "Heightmap file \"" << fname << "\" is too small ("
+             << heightmap->nI << " x " << heightmap->nJ << " samples)\n";
+        delete heightmap;
+        return NULL;
+    }
+    return heightmap;
+}
+
+
+const double Heightmap::sample(int i, int j) const
+//
+// returns the height of sample (`i`, `j`) (clamped to the grid), where
+// `i` increases to the right and `j` increases up the image
+//
+{
+    i = min(max(i, 0), nI - 1);
+    j = min(max(j, 0), nJ - 1);
+
+    const unsigned char *bytes
+        = samples + ((size_t) (nJ - 1 - j) * nI + i) * bytesPerSample;
+    unsigned int value;
+
+    if (bytesPerSample == 1)
+        value = bytes[0];
+    else if (isBigEndian)
+        value = (bytes[0] << 8) | bytes[1];
+    else
+        value = bytes[0] | (bytes[1] << 8);
+    return value / maxValue;
+}
+
+
+#ifdef TEST
+//
+// writes small heightmaps in each of the supported formats (and some
+// invalid ones), reads them back, and checks their samples and
+// interpolation
+//
+#include <cstdio>
+
+#include "n_elem.h"
+
+static const unsigned int testValue(const int i, const int row)
+//
+// the sample at column `i` and (file) row `row` of the test files
+//
+{
+    return 1000 * i + 37 * row + 300;
+}
+
+
+static void writeFile(const string &fname, const string &contents)
+{
+    FILE *f = fopen(fname.c_str(), "wb");
+
+    fwrite(contents.data(), 1, contents.size(), f);
+    fclose(f);
+}
+
+
+static const string pgm(const int nI, const int nJ, const int maxValue)
+//
+// returns a binary PGM file of testValue()s (with a comment in its
+// header)
+//
+{
+    char header[100];
+    string contents;
+
+    sprintf(header, "P5\n# test heightmap\n%d %d\n%d\n", nI, nJ, maxValue);
+    contents = header;
+    for (int row = 0; row < nJ; row++)
+        for (int i = 0; i < nI; i++) {
+            unsigned int value = testValue(i, row) % (maxValue + 1);
+
+            if (maxValue >= 256)
+                contents += (char) (value >> 8);
+            contents += (char) (value & 0xff);
+        }
+    return contents;
+}
+
+
+static const string raw(const int side)
+//
+// returns a raw file of testValue()s
+//
+{
+    string contents;
+
+    for (int row = 0; row < side; row++)
+        for (int i = 0; i < side; i++) {
+            unsigned int value = testValue(i, row);
+
+            contents += (char) (value & 0xff);
+            contents += (char) (value >> 8);
+        }
+    return contents;
+}
+
+
+static int check(const string &name, const string &contents,
+                 const int maxValue)
+//
+// writes `contents` to a file, reads it as a Heightmap, and returns the
+// number of its samples (and interpolated heights) that are wrong (or
+// -1 if it can't be read)
+//
+{
+    const string fname = "heightmap_t.tmp";
+    writeFile(fname, contents);
+    Heightmap *heightmap = Heightmap::read(fname);
+    remove(fname.c_str());
+    if (!heightmap)
+        return -1;
+
+    const int nI = heightmap->nColumns();
+    const int nJ = heightmap->nRows();
+    int nErrors = 0;
+
+    for (int j = 0; j < nJ; j++)
+        for (int i = 0; i < nI; i++) {
+            const int row = nJ - 1 - j; // (The file starts at the top.)
+            double expected = (testValue(i, row) % (maxValue + 1))
+                / (double) maxValue;
+            double dh_du, dh_dv;
+
+            if (fabs(heightmap->sample(i, j) - expected) > 1.0e-12)
+                nErrors++;
+            // Interpolation must reproduce the samples.
+            if (fabs(heightmap->height((double) i / (nI - 1),
+                                       (double) j / (nJ - 1),
+                                       dh_du, dh_dv) - expected) > 1.0e-12)
+                nErrors++;
+        }
+
+    // The test values are linear in i and row, so (away from the
+    // clamped edges) so are the heights, exactly.
+    if (maxValue == 65535 && nI >= 4 && nJ >= 4) {
+        double dh_du, dh_dv;
+        double u = 1.5 / (nI - 1);
+        double v = 1.25 / (nJ - 1);
+        double h = heightmap->height(u, v, dh_du, dh_dv);
+        double row = nJ - 1 - 1.25;
+        double expected = (1000 * 1.5 + 37 * row + 300) / maxValue;
+
+        if (fabs(h - expected) > 1.0e-12
+                || fabs(dh_du - 1000.0 * (nI - 1) / maxValue) > 1.0e-9
+                || fabs(dh_dv + 37.0 * (nJ - 1) / maxValue) > 1.0e-9)
+            nErrors++;
+    }
+    printf("%-24s %3d x %-3d %s\n", name.c_str(), nI, nJ,
+           nErrors ? "FAILED" : "ok");
+    delete heightmap;
+    return nErrors;
+}
+
+
+int main(int argc, char **argv)
+{
+    int nFailures = 0;
+
+    nFailures += (check("16-bit PGM", pgm(7, 5, 65535), 65535) != 0);
+    nFailures += (check("8-bit PGM", pgm(6, 4, 255), 255) != 0);
+    nFailures += (check("16-bit raw", raw(6), 65535) != 0);
+
+    // These must be rejected.
+    const struct {
+        const char *name;
+        string contents;
+    } invalids[] = {
+        { "truncated PGM", pgm(7, 5, 65535).substr(0, 60) },
+        { "PGM without a header", "P5\n7 5\n" },
+        { "non-square raw", raw(6).substr(0, 70) },
+        { "odd-sized raw", raw(6).substr(0, 71) },
+    };
+    for (unsigned int k = 0; k < N_ELEM(invalids); k++) {
+        bool isRejected = (check(invalids[k].name, invalids[k].contents,
+                                 65535) == -1);
+
+        printf("%-24s %s\n", invalids[k].name,
+               isRejected ? "rejected (ok)" : "accepted (FAILED)");
+        nFailures += !isRejected;
+    }
+    return nFailures;
+}
+#endif // TEST
@@ -0,0 +1,66 @@
+#ifndef INCLUDED_HEIGHTMAP
+
+//
+// The "heightmap" module provides the Heightmap class (see below).
+//
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+
+class Heightmap
+//
+// a grid of heights read from a file, which may be either
+//
+//  - a binary ("P5") PGM file, with 8-bit samples if its maximum value
+//    is less than 256 and (big-endian) 16-bit samples otherwise, or
+//
+//  - a "raw" file of nothing but a square grid of little-endian 16-bit
+//    samples
+//
+// The file is memory-mapped rather than read, so only the parts of it
+// that are used need to be in memory (and the operating system can
+// page them out again), which allows heightmaps larger than memory.
+// Nothing about it changes after it's read, so it's safe to use from
+// more than one thread.
+//
+// Heights are scaled to [0, 1]. In (u, v) coordinates, which also run
+// from 0 to 1, the first row of the file (the top of the image) is at
+// v = 1.
+//
+{
+    const unsigned char *samples; // (within `mapping`)
+    int nI, nJ; // samples per row and rows
+    int bytesPerSample;
+    double maxValue;
+    bool isBigEndian;
+
+    // the mapped file (or, where there's no mmap(), a copy of it)
+    unsigned char *mapping;
+    size_t mappingSize;
+    vector<unsigned char> contents;
+
+    Heightmap(void);
+
+public:
+    static Heightmap *read(const string &fname);
+    ~Heightmap();
+
+    const double height(const double u, const double v,
+                        double &dh_du, double &dh_dv) const;
+    const int nColumns(void) const
+    {
+        return nI;
+    };
+    const int nRows(void) const
+    {
+        return nJ;
+    };
+    const double sample(int i, int j) const;
+};
+
+#define INCLUDED_HEIGHTMAP
+#endif // INCLUDED_HEIGHTMAP
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <cassert>
+
+#include "arena.h"
+#include "indexed_mesh.h"
+#include "render_stats.h"
+#include "shader_programs.h"
+
+
+void IndexedMesh::allocateBuffers(void)
+{
+    CHECK_GL(glGenBuffers(1, &vertexPositionsBufferId));
+    CHECK_GL(glGenBuffers(1, &vertexNormalBufferId));
+    CHECK_GL(glGenBuffers(1, &indexBufferId));
+}
+
+
+const void IndexedMesh::createFaceNormalsAndCentroids(void)
+{
+    faceNormals = newArray<Vector3f>(nFaces);
+    faceCentroids = newArray<Point3f>(nFaces);
+    for (int iFace = 0; iFace < nFaces; iFace++) {
+        const Point3f &p0 = vertexPositions[vertexIndices[3*iFace]];
+        const Point3f &p1 = vertexPositions[vertexIndices[3*iFace + 1]];
+        const Point3f &p2 = vertexPositions[vertexIndices[3*iFace + 2]];
+
+        faceNormals[iFace] = faceNormal(p0, p1, p2);
+        faceCentroids[iFace] = triangleCentroid(p0, p1, p2);
+    }
+}
+
+
+IndexedMesh::IndexedMesh(Point3f *vertexPositions_, Vector3f *vertexNormals_,
+                         int nVertices_, unsigned int *vertexIndices_,
+                         int nFaces_, const ArrayOwnership ownership)
+{
+    nVertices = nVertices_;
+    nFaces = nFaces_;
+    if (ownership == ADOPT_ARRAYS) {
+        vertexPositions = vertexPositions_;
+        vertexNormals = vertexNormals_;
+        vertexIndices = vertexIndices_;
+    } else {
+        vertexPositions = newArray<Point3f>(nVertices);
+        vertexNormals = newArray<Vector3f>(nVertices);
+        vertexIndices = newArray<unsigned int>(3 * nFaces);
+        copy(vertexPositions_, vertexPositions_ + nVertices,
+             vertexPositions);
+        copy(vertexNormals_, vertexNormals_ + nVertices, vertexNormals);
+        copy(vertexIndices_, vertexIndices_ + 3 * nFaces, vertexIndices);
+    }
+    for (int i = 0; i < 3 * nFaces; i++)
+        assert(vertexIndices[i] < (unsigned int) nVertices);
+    // (face normals and centroids are created on demand)
+
+    allocateBuffers();
+    //
+    // As with the other Meshes, transforms are handled in the vertex
+    // shader, so the buffers only need to be downloaded once.
+    //
+    updateBuffers();
+}
+
+
+IndexedMesh::~IndexedMesh()
+{
+    deleteArray(vertexIndices);
+    CHECK_GL(glDeleteBuffers(1, &indexBufferId));
+}
+
+
+const void IndexedMesh::render(void)
+{
+    GLint vpai = ShaderProgram::getCurrentAttributeIndex("vertexPosition");
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
+    CHECK_GL(glEnableVertexAttribArray(vpai));
+    CHECK_GL(glVertexAttribPointer(
+                 vpai, // index of attribute
+                 3, // # of elements per attribute
+                 GL_FLOAT, // type of each component
+                 GL_FALSE,  // don't normalized fixed-point values
+                 0, // offset between consecutive generic vertex attributes
+                 BUFFER_OFFSET(0)));
+
+    GLint vnai = ShaderProgram::getCurrentAttributeIndex("vertexNormal");
+
+    if (vnai != NO_SUCH_ATTRIBUTE) {
+        CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexNormalBufferId));
+        CHECK_GL(glEnableVertexAttribArray(vnai));
+        CHECK_GL(glVertexAttribPointer(
+                     vnai, // index of attribute
+                     3, // # of elements per attribute
+                     GL_FLOAT, // type of each component
+                     GL_FALSE,  // don't normalized fixed-point values
+                     0, // offset between consecutive generic vertex attributes
+                     BUFFER_OFFSET(0)));
+    }
+
+    CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId));
+    CHECK_GL(glDrawElements(GL_TRIANGLES, 3 * nFaces, GL_UNSIGNED_INT,
+                            BUFFER_OFFSET(0)));
+
+    renderStats.ctVertices += 3 * nFaces;
+    renderStats.ctTrianglesInIndexedMeshes += nFaces;
+}
+
+
+void IndexedMesh::updateBuffers(void)
+{
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                          sizeof(vertexPositions[0]) * nVertices,
+                          vertexPositions, GL_STATIC_DRAW));
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexNormalBufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                          sizeof(vertexNormals[0]) * nVertices,
+                          vertexNormals, GL_STATIC_DRAW));
+
+    CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferId));
+    CHECK_GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                          sizeof(vertexIndices[0]) * 3 * nFaces,
+                          vertexIndices, GL_STATIC_DRAW));
+}
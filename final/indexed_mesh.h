@@ -0,0 +1,38 @@
+#ifndef INCLUDED_INDEXED_MESH
+
+//
+// The "indexed_mesh" module provides the IndexedMesh class (see
+// below).
+//
+
+#include "check_gl.h"
+#include "mesh.h"
+
+
+class IndexedMesh : public Mesh
+//
+// An IndexedMesh is a Mesh of triangles that share vertices. Each
+// face is three indices into the vertex arrays, so the whole mesh is
+// drawn with a single glDrawElements() call regardless of how many
+// pieces (e.g. Bezier patches) it was built from.
+//
+{
+    unsigned int indexBufferId;
+
+    unsigned int *vertexIndices; // there are 3 * nFaces of these
+
+    const void createFaceNormalsAndCentroids(void);
+
+public:
+    IndexedMesh(Point3f *vertexPositions_, Vector3f *vertexNormals_,
+                int nVertices_, unsigned int *vertexIndices_, int nFaces_,
+                const ArrayOwnership ownership = COPY_ARRAYS);
+    ~IndexedMesh();
+
+    void allocateBuffers(void);
+    const void render(void);
+    void updateBuffers(void);
+};
+
+#define INCLUDED_INDEXED_MESH
+#endif // INCLUDED_INDEXED_MESH
@@ -1,5 +1,6 @@
 #include <cassert>
 
+#include "arena.h"
 #include "controller.h"
 #include "check_gl.h"
 #include "geometry.h"
@@ -10,7 +11,7 @@
 
 
 // helper (could be static)
-void fitInBbox(Point3 *p, const int nP,
+void fitInBbox(Point3f *p, const int nP,
                       const Point3 qMin, const Point3 qMax)
 //
 // scales (uniformly) and translates the points in `p` to fit in an
@@ -20,7 +21,7 @@ void fitInBbox(Point3 *p, const int nP,
     Point3 pMin, pMax;
 
     assert(nP > 0);
-    pMin = pMax = p[0];
+    pMin = pMax = Point3(p[0]);
     for (int iP = 0; iP < nP; iP++) {
         for (int d = 0; d < 3; d++) {
             if (p[iP].u.a[d] < pMin.u.a[d])
@@ -52,7 +53,7 @@ void fitInBbox(Point3 *p, const int nP,
     // Scale all coordinates in all dimensions by the smallest scale
     // value and add qCtr.
     for (int iP = 0; iP < nP; iP++)
-        p[iP] = scale * (p[iP] - pCtr) + qCtr;
+        p[iP] = Point3f(scale * (Point3(p[iP]) - pCtr) + qCtr);
 }
 
 
@@ -69,18 +70,26 @@ void IrregularMesh::allocateBuffers(void)
 }
 
 
-IrregularMesh::IrregularMesh(Point3 *vertexPositions_, Vector3 *vertexNormals_,
-                             int nVertices_)
+IrregularMesh::IrregularMesh(Point3f *vertexPositions_,
+                             Vector3f *vertexNormals_,
+                             int nVertices_,
+                             const ArrayOwnership ownership)
 {
     nVertices = nVertices_;
-    vertexPositions = vertexPositions_;
-    vertexNormals = vertexNormals_;
+    if (ownership == ADOPT_ARRAYS) {
+        vertexPositions = vertexPositions_;
+        vertexNormals = vertexNormals_;
+    } else {
+        vertexPositions = newArray<Point3f>(nVertices);
+        vertexNormals = newArray<Vector3f>(nVertices);
+        copy(vertexPositions_, vertexPositions_ + nVertices,
+             vertexPositions);
+        copy(vertexNormals_, vertexNormals_ + nVertices, vertexNormals);
+    }
     assert(nVertices % 3 == 0); // irregular mesh assumes 3 vertices/face
     nFaces = nVertices / 3;
     assert(nFaces * 3 == nVertices);
 
-    createFaceNormalsAndCentroids();
-
     allocateBuffers();
     //
     // Since we're handling transforms in the vertex shader, we only
@@ -91,6 +100,12 @@ IrregularMesh::IrregularMesh(Point3 *vertexPositions_, Vector3 *vertexNormals_,
 }
 
 
+IrregularMesh::~IrregularMesh()
+{
+    CHECK_GL(glDeleteBuffers(1, &faceNormalBufferId));
+}
+
+
 const void IrregularMesh::render(void)
 {
     //
@@ -103,7 +118,7 @@ const void IrregularMesh::render(void)
     CHECK_GL(glVertexAttribPointer(
                  vpai, // index of attribute
                  3, // # of elements per attribute
-                 GL_DOUBLE, // type of each component
+                 GL_FLOAT, // type of each component
                  GL_FALSE,  // don't normalized fixed-point values
                  0, // offset between consecutive generic vertex attributes
                  BUFFER_OFFSET(0)));
@@ -124,7 +139,7 @@ const void IrregularMesh::render(void)
        CHECK_GL(glVertexAttribPointer(
                     vnai, // index of attribute
                     3, // # of elements per attribute
-                    GL_DOUBLE, // type of each component
+                    GL_FLOAT, // type of each component
                     GL_FALSE,  // don't normalized fixed-point values
                     0, // offset between consecutive generic vertex attributes
                     BUFFER_OFFSET(0)));
@@ -152,8 +167,8 @@ const void IrregularMesh::createFaceNormalsAndCentroids(void)
     int iVertex = 0;
 
     assert(nFaces * 3 == nVertices);
-    faceNormals = new Vector3[nFaces];
-    faceCentroids = new Point3[nFaces];
+    faceNormals = newArray<Vector3f>(nFaces);
+    faceCentroids = newArray<Point3f>(nFaces);
     for (int iFace = 0; iFace < nFaces; iFace++) {
         faceNormals[iFace] = faceNormal(
             vertexPositions[iVertex],
@@ -192,34 +207,32 @@ IrregularMesh *IrregularMesh::read(const string fname)
 
     int nFaces = facesVector.size();
     int nVertices = 3 * nFaces; // 3 vertices / (triangular) face
-    Point3 *vertexPositions = new Point3[nVertices];
-    Vector3 *vertexNormals = new Vector3[nVertices];
+    Point3f *vertexPositions = newArray<Point3f>(nVertices);
+    Vector3f *vertexNormals = newArray<Vector3f>(nVertices);
 
     int iVertex = 0;
     for (int iFace = 0; iFace < nFaces; iFace++) {
         Face face = facesVector[iFace];
-        vertexPositions[iVertex] = vertexPositionsVector[
-            face.faceVertex0.positionIndex];
+        vertexPositions[iVertex] = Point3f(vertexPositionsVector[
+            face.faceVertex0.positionIndex]);
         assert(face.faceVertex0.normalIndex != OBJ_INDEX_DEFAULTED);
-        vertexNormals[iVertex] = vertexNormalsVector[
-                face.faceVertex0.normalIndex];
+        vertexNormals[iVertex] = Vector3f(vertexNormalsVector[
+                face.faceVertex0.normalIndex]);
         iVertex++;
-        vertexPositions[iVertex] = vertexPositionsVector[
-            face.faceVertex1.positionIndex];
+        vertexPositions[iVertex] = Point3f(vertexPositionsVector[
+            face.faceVertex1.positionIndex]);
         assert(face.faceVertex1.normalIndex != OBJ_INDEX_DEFAULTED);
-        vertexNormals[iVertex] = vertexNormalsVector[
-                face.faceVertex1.normalIndex];
+        vertexNormals[iVertex] = Vector3f(vertexNormalsVector[
+                face.faceVertex1.normalIndex]);
         iVertex++;
-        vertexPositions[iVertex] = vertexPositionsVector[
-            face.faceVertex2.positionIndex];
+        vertexPositions[iVertex] = Point3f(vertexPositionsVector[
+            face.faceVertex2.positionIndex]);
         assert(face.faceVertex2.normalIndex != OBJ_INDEX_DEFAULTED);
-        vertexNormals[iVertex] = vertexNormalsVector[
-                face.faceVertex2.normalIndex];
+        vertexNormals[iVertex] = Vector3f(vertexNormalsVector[
+                face.faceVertex2.normalIndex]);
         iVertex++;
     }
     assert(iVertex == nVertices);
-    Face *faces = new Face[nFaces];
-    copy(facesVector.begin(), facesVector.end(), faces);
 
     // make the mesh fit in a 1.5 x 1.5 x 1.5 bounding box
     fitInBbox(vertexPositions, nVertices,
@@ -228,7 +241,7 @@ IrregularMesh *IrregularMesh::read(const string fname)
         );
 
     IrregularMesh *irregularMesh = new IrregularMesh(
-        vertexPositions, vertexNormals, nVertices);
+        vertexPositions, vertexNormals, nVertices, ADOPT_ARRAYS);
 
     return irregularMesh;
 }
@@ -249,7 +262,8 @@ void IrregularMesh::updateBuffers(void)
 
 
     // BIND the face Normal vector to the vertices of the faces
-    Vec3 *faceNormalOfVertex = new Vec3[nVertices];
+    needFaceNormalsAndCentroids();
+    Vec3f *faceNormalOfVertex = new Vec3f[nVertices];
 
     for (int iFace = 0; iFace < nFaces; iFace++) {
           faceNormalOfVertex[iFace * 3 + 0] = faceNormals[iFace];
@@ -261,5 +275,5 @@ void IrregularMesh::updateBuffers(void)
     CHECK_GL(glBufferData(GL_ARRAY_BUFFER, sizeof(faceNormalOfVertex[0]) * nVertices,
     faceNormalOfVertex, GL_STATIC_DRAW));
 
-    delete faceNormalOfVertex;
+    delete [] faceNormalOfVertex;
 }
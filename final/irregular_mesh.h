@@ -20,8 +20,10 @@ private:
     const void renderTriangles(void) const;
 
 public:
-    IrregularMesh(Point3 *vertexPositions_,
-                  Vector3 *vertexNormals_, int nVertices_);
+    IrregularMesh(Point3f *vertexPositions_,
+                  Vector3f *vertexNormals_, int nVertices_,
+                  const ArrayOwnership ownership = COPY_ARRAYS);
+    ~IrregularMesh();
 
     static IrregularMesh *read(const string fname);
 
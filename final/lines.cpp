@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "check_gl.h"
 #include "color.h"
 #include "controller.h"
@@ -13,6 +14,12 @@
 
 void Lines::allocateBuffers(void)
 {
+    vertexPositionsOffset = 0;
+    if (usage == STREAMED_VERTEX_DATA) {
+        vertexPositionsBufferId = scene->streamBuffer->bufferId;
+        return;
+    }
+
     // Allocate a buffer for the vertex coordinates ...
     CHECK_GL(glGenBuffers(1, &vertexPositionsBufferId));
 }
@@ -20,25 +27,44 @@ void Lines::allocateBuffers(void)
 
 void Lines::updateBuffers(void)
 {
+    if (usage == STREAMED_VERTEX_DATA) {
+        vertexPositionsOffset = scene->streamBuffer->upload(
+            vertexPositions, nI * sizeof(vertexPositions[0]));
+        return;
+    }
     CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
     CHECK_GL(glBufferData(GL_ARRAY_BUFFER, nI * sizeof(vertexPositions[0]),
                           vertexPositions, GL_STATIC_DRAW));
 }
 
 
-Lines::Lines(Point3 (*vertexPositions_)[2], int nI_)
-    : nI(nI_)
+Lines::Lines(Point3f (*vertexPositions_)[2], int nI_,
+             const ArrayOwnership ownership,
+             const VertexDataUsage usage_)
+    : nI(nI_), usage(usage_)
 {
-    vertexPositions = new Point3[nI][2];
-    for (int i = 0; i < nI; i++) {
-        vertexPositions[i][0] = vertexPositions_[i][0];
-        vertexPositions[i][1] = vertexPositions_[i][1];
+    if (ownership == ADOPT_ARRAYS) {
+        vertexPositions = vertexPositions_;
+    } else {
+        vertexPositions = newArray<Point3f[2]>(nI);
+        for (int i = 0; i < nI; i++) {
+            vertexPositions[i][0] = vertexPositions_[i][0];
+            vertexPositions[i][1] = vertexPositions_[i][1];
+        }
     }
     allocateBuffers();
     updateBuffers();
 }
 
 
+Lines::~Lines()
+{
+    deleteArray(vertexPositions);
+    if (usage == STATIC_VERTEX_DATA)
+        CHECK_GL(glDeleteBuffers(1, &vertexPositionsBufferId));
+}
+
+
 const void Lines::render(void)
 {
     CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
@@ -46,10 +72,10 @@ const void Lines::render(void)
     CHECK_GL(glVertexAttribPointer(
                  0, // index of attribute
                  3, // # of elements per attribute
-                 GL_DOUBLE, // type of each component
+                 GL_FLOAT, // type of each component
                  GL_FALSE,  // don't normalized fixed-point values
                  0, // offset between consecutive generic vertex attributes
-                 BUFFER_OFFSET(0)));
+                 BUFFER_OFFSET(vertexPositionsOffset)));
     CHECK_GL(glDrawArrays(GL_LINES, 0, 2*nI));
     renderStats.ctLines += nI;
     renderStats.ctVertices += 2*nI;
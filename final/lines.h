@@ -17,14 +17,19 @@ class Lines : public Tessellation
 {
 public:
     // array of line segments, defined by start and stop vertex coordinates
-    Point3 (*vertexPositions)[2];
+    Point3f (*vertexPositions)[2];
 
     unsigned int vertexPositionsBufferId;
+    size_t vertexPositionsOffset; // (in bytes) within that buffer
 
     int nI; // number of line segments
+    VertexDataUsage usage;
 
 public:
-    Lines(Point3 (*vertexPositions)[2], int nI);
+    Lines(Point3f (*vertexPositions)[2], int nI,
+          const ArrayOwnership ownership = COPY_ARRAYS,
+          const VertexDataUsage usage_ = STATIC_VERTEX_DATA);
+    ~Lines();
 
     void allocateBuffers(void);
     const void render(void);
@@ -6,6 +6,7 @@ using namespace std;
 #include "car.h"
 #include "controller.h"
 #include "framework.h"
+#include "ground.h"
 #include "scene.h"
 #include "view.h"
 #include "work_arounds.h"
@@ -23,6 +24,8 @@ static void help(char *progname)
         "where <option> is any of:\n"
         "  -c <filename>  use <filename> as car model (obj format)\n"
         "                 (default: \"" DEFAULT_CAR_FNAME "\")\n"
+        "  -g <filename>  use <filename> as ground heightmap (binary PGM\n"
+        "                 or square 16-bit raw format)\n"
         "  -h             (this) help message\n"
         "  -l <name>      selects track layout, where <name> is one of:\n"
         ;
@@ -48,13 +51,17 @@ int main(int argc, char **argv)
     // Layout layout = LAYOUT_BSPLINE; // the default
     Layout layout = LAYOUT_CUSTOM;
 
-    while ((ch = getopt(argc, argv, "c:l:h")) != -1) {
+    while ((ch = getopt(argc, argv, "c:g:l:h")) != -1) {
         switch (ch) {
 
         case 'c':
             carFname = optarg;
             break;
 
+        case 'g':
+            heightmapFname = optarg;
+            break;
+
         case 'l':
             status = parseLayout(optarg, layout);
             assert(status);
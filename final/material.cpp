@@ -0,0 +1,77 @@
+#include "material.h"
+#include "uniform_block.h"
+
+//
+// std140 byte offsets of the members of "MaterialBlock" (see
+// "eads_vertex_shader.glsl").
+//
+enum {
+    EMITTANCE_OFFSET                     =  0, // vec3
+    SPECULAR_EXPONENT_OFFSET             = 12, // float
+    AMBIENT_REFLECTIVITY_OFFSET          = 16, // vec3
+    MAXIMUM_DIFFUSE_REFLECTIVITY_OFFSET  = 32, // vec3
+    MAXIMUM_SPECULAR_REFLECTIVITY_OFFSET = 48, // vec3
+    MATERIAL_BLOCK_SIZE                  = 64
+};
+
+
+Material::Material(const Color &emittance,
+                   const Rgb &ambientReflectivity,
+                   const Rgb &maximumDiffuseReflectivity,
+                   const Rgb &maximumSpecularReflectivity,
+                   const double specularExponent)
+{
+    materialBlock = new UniformBlock(MATERIAL_BLOCK_BINDING,
+                                     MATERIAL_BLOCK_SIZE);
+    setEmittance(emittance);
+    setAmbient(ambientReflectivity);
+    setDiffuse(maximumDiffuseReflectivity);
+    setSpecular(maximumSpecularReflectivity, specularExponent);
+}
+
+
+Material::~Material()
+{
+    delete materialBlock;
+}
+
+
+void Material::bind(void)
+//
+// makes this the Material used by subsequent draws
+//
+{
+    materialBlock->update();
+    materialBlock->bind();
+}
+
+
+void Material::setAmbient(const Rgb &ambientReflectivity)
+{
+    materialBlock->set(AMBIENT_REFLECTIVITY_OFFSET, ambientReflectivity);
+}
+
+
+void Material::setDiffuse(const Rgb &maximumDiffuseReflectivity)
+{
+    materialBlock->set(MAXIMUM_DIFFUSE_REFLECTIVITY_OFFSET,
+                       maximumDiffuseReflectivity);
+}
+
+
+void Material::setEmittance(const Color &emittance)
+{
+    materialBlock->set(EMITTANCE_OFFSET, emittance);
+}
+
+
+void Material::setSpecular(const Rgb &maximumSpecularReflectivity,
+                           double specularExponent)
+{
+    // A zero exponent causes a pow(0.0, 0.0) ambiguity in the shader.
+    if (specularExponent == 0.0)
+        specularExponent = 1.0;
+    materialBlock->set(MAXIMUM_SPECULAR_REFLECTIVITY_OFFSET,
+                       maximumSpecularReflectivity);
+    materialBlock->set(SPECULAR_EXPONENT_OFFSET, specularExponent);
+}
@@ -0,0 +1,40 @@
+#ifndef INCLUDED_MATERIAL
+
+//
+// The "material" module provides the Material class (see below).
+//
+
+#include "color.h"
+#include "uniform_block.h"
+
+
+class Material
+//
+// the reflective (and emissive) properties of a surface, as used by
+// the EadsShaderProgram
+//
+// Since these rarely change, a Material keeps them in its own
+// UniformBlock, which is only sent to the GPU when they do.
+//
+{
+    UniformBlock *materialBlock;
+
+public:
+    Material(const Color &emittance,
+             const Rgb &ambientReflectivity,
+             const Rgb &maximumDiffuseReflectivity,
+             const Rgb &maximumSpecularReflectivity,
+             const double specularExponent);
+    ~Material();
+
+    void bind(void);
+
+    void setAmbient(const Rgb &ambientReflectivity);
+    void setDiffuse(const Rgb &maximumDiffuseReflectivity);
+    void setEmittance(const Color &emittance);
+    void setSpecular(const Rgb &maximumSpecularReflectivity,
+                     double specularExponent);
+};
+
+#define INCLUDED_MATERIAL
+#endif // INCLUDED_MATERIAL
@@ -0,0 +1,396 @@
+#include <cassert>
+
+#include "matrix_kernels.h"
+
+//
+// The SIMD kernels use GCC/Clang function attributes and builtins, so
+// other compilers (and non-x86-64 CPUs) get only the portable ones.
+//
+#if defined(__GNUC__) && defined(__x86_64__)
+#define HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define HAVE_X86_KERNELS 0
+#endif
+
+const char *matrixKernelSetNames[N_MATRIX_KERNEL_SETS] = {
+    "portable",
+    "sse2",
+    "avx2",
+};
+
+
+//
+// portable kernels
+//
+
+static void multiplyPortable(const double a[16], const double b[16],
+                             double result[16])
+{
+    double c[16]; // in case `result` is `a` or `b`
+
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+            c[4*j + i] = 0.0;
+            for (int k = 0; k < 4; k++)
+                c[4*j + i] += a[4*k + i] * b[4*j + k];
+        }
+    }
+    for (int i = 0; i < 16; i++)
+        result[i] = c[i];
+}
+
+
+static void transformPortable(const double m[16], const Vec3 in[],
+                              Vec3 out[], const int n, const double w)
+//
+// transforms `n` Vec3s with a 4th coordinate of `w` (1 for points, 0
+// for vectors)
+//
+{
+    for (int iVec = 0; iVec < n; iVec++) {
+        double x = in[iVec].u.a[0];
+        double y = in[iVec].u.a[1];
+        double z = in[iVec].u.a[2];
+
+        for (int i = 0; i < 3; i++)
+            out[iVec].u.a[i] = m[i] * x + m[4 + i] * y + m[8 + i] * z
+                + m[12 + i] * w;
+    }
+}
+
+
+#if HAVE_X86_KERNELS
+
+//
+// SSE2 kernels: each column is held as two pairs of doubles (rows 0-1
+// and rows 2-3).
+//
+
+__attribute__((target("sse2")))
+static void multiplySse2(const double a[16], const double b[16],
+                         double result[16])
+{
+    __m128d aLo[4], aHi[4], cLo[4], cHi[4];
+
+    for (int k = 0; k < 4; k++) {
+        aLo[k] = _mm_loadu_pd(a + 4*k);
+        aHi[k] = _mm_loadu_pd(a + 4*k + 2);
+    }
+    for (int j = 0; j < 4; j++) {
+        cLo[j] = _mm_setzero_pd();
+        cHi[j] = _mm_setzero_pd();
+        for (int k = 0; k < 4; k++) {
+            __m128d bKJ = _mm_set1_pd(b[4*j + k]);
+            cLo[j] = _mm_add_pd(cLo[j], _mm_mul_pd(aLo[k], bKJ));
+            cHi[j] = _mm_add_pd(cHi[j], _mm_mul_pd(aHi[k], bKJ));
+        }
+    }
+    for (int j = 0; j < 4; j++) {
+        _mm_storeu_pd(result + 4*j, cLo[j]);
+        _mm_storeu_pd(result + 4*j + 2, cHi[j]);
+    }
+}
+
+
+__attribute__((target("sse2")))
+static void transformSse2(const double m[16], const Vec3 in[],
+                          Vec3 out[], const int n, const double w)
+{
+    __m128d mLo[4], mHi[4];
+
+    for (int k = 0; k < 4; k++) {
+        mLo[k] = _mm_loadu_pd(m + 4*k);
+        mHi[k] = _mm_loadu_pd(m + 4*k + 2);
+    }
+    // The 4th coordinate is the same for every Vec3.
+    __m128d wLo = _mm_mul_pd(mLo[3], _mm_set1_pd(w));
+    __m128d wHi = _mm_mul_pd(mHi[3], _mm_set1_pd(w));
+
+    for (int iVec = 0; iVec < n; iVec++) {
+        __m128d x = _mm_set1_pd(in[iVec].u.a[0]);
+        __m128d y = _mm_set1_pd(in[iVec].u.a[1]);
+        __m128d z = _mm_set1_pd(in[iVec].u.a[2]);
+        __m128d lo = _mm_add_pd(
+            _mm_add_pd(_mm_mul_pd(mLo[0], x), _mm_mul_pd(mLo[1], y)),
+            _mm_add_pd(_mm_mul_pd(mLo[2], z), wLo));
+        __m128d hi = _mm_add_pd(
+            _mm_add_pd(_mm_mul_pd(mHi[0], x), _mm_mul_pd(mHi[1], y)),
+            _mm_add_pd(_mm_mul_pd(mHi[2], z), wHi));
+
+        _mm_storeu_pd(out[iVec].u.a, lo);
+        _mm_store_sd(out[iVec].u.a + 2, hi); // (drop the 4th coordinate)
+    }
+}
+
+
+//
+// AVX2 kernels: each column is held in a single register.
+//
+
+__attribute__((target("avx2,fma")))
+static void multiplyAvx2(const double a[16], const double b[16],
+                         double result[16])
+{
+    __m256d aCol[4], c[4];
+
+    for (int k = 0; k < 4; k++)
+        aCol[k] = _mm256_loadu_pd(a + 4*k);
+    for (int j = 0; j < 4; j++) {
+        c[j] = _mm256_mul_pd(aCol[0], _mm256_set1_pd(b[4*j]));
+        for (int k = 1; k < 4; k++)
+            c[j] = _mm256_fmadd_pd(aCol[k], _mm256_set1_pd(b[4*j + k]),
+                                   c[j]);
+    }
+    for (int j = 0; j < 4; j++)
+        _mm256_storeu_pd(result + 4*j, c[j]);
+}
+
+
+__attribute__((target("avx2,fma")))
+static void transformAvx2(const double m[16], const Vec3 in[],
+                          Vec3 out[], const int n, const double w)
+{
+    __m256d mCol[3];
+
+    for (int k = 0; k < 3; k++)
+        mCol[k] = _mm256_loadu_pd(m + 4*k);
+    // The 4th coordinate is the same for every Vec3.
+    __m256d wCol = _mm256_mul_pd(_mm256_loadu_pd(m + 12), _mm256_set1_pd(w));
+    // Only store x, y, and z, so as not to overrun the next Vec3.
+    __m256i xyzMask = _mm256_set_epi64x(0, -1, -1, -1);
+
+    for (int iVec = 0; iVec < n; iVec++) {
+        __m256d r = _mm256_fmadd_pd(mCol[0], _mm256_set1_pd(in[iVec].u.a[0]),
+                                    wCol);
+        r = _mm256_fmadd_pd(mCol[1], _mm256_set1_pd(in[iVec].u.a[1]), r);
+        r = _mm256_fmadd_pd(mCol[2], _mm256_set1_pd(in[iVec].u.a[2]), r);
+        _mm256_maskstore_pd(out[iVec].u.a, xyzMask, r);
+    }
+}
+
+#endif // HAVE_X86_KERNELS
+
+
+struct MatrixKernels {
+    void (*multiply)(const double a[16], const double b[16],
+                     double result[16]);
+    void (*transform)(const double m[16], const Vec3 in[], Vec3 out[],
+                      const int n, const double w);
+};
+
+static const MatrixKernels matrixKernels[N_MATRIX_KERNEL_SETS] = {
+    { multiplyPortable, transformPortable },
+#if HAVE_X86_KERNELS
+    { multiplySse2,     transformSse2 },
+    { multiplyAvx2,     transformAvx2 },
+#else
+    { multiplyPortable, transformPortable }, // never selected
+    { multiplyPortable, transformPortable }, // never selected
+#endif
+};
+
+
+const bool matrixKernelSetIsSupported(const MatrixKernelSet kernelSet)
+//
+// returns true iff the CPU can run the kernels in `kernelSet`
+//
+{
+    switch (kernelSet) {
+    case PORTABLE_KERNELS:
+        return true;
+#if HAVE_X86_KERNELS
+    case SSE2_KERNELS:
+        return true; // part of x86-64
+    case AVX2_KERNELS:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2")
+            && __builtin_cpu_supports("fma");
+#endif
+    default:
+        return false;
+    }
+}
+
+
+static MatrixKernelSet &currentKernelSet(void)
+//
+// helper: returns (a reference to) the kernel set in use, initially
+// the fastest one supported
+//
+// This is a function-local static so that it's initialized before
+// the first use, even if that happens during static initialization
+// of some other module (e.g. a global Transform).
+//
+{
+    static MatrixKernelSet kernelSet = PORTABLE_KERNELS;
+    static bool isInitialized = false;
+
+    if (!isInitialized) {
+        // The kernels treat arrays of Point3s and Vector3s as Vec3s.
+        assert(sizeof(Point3) == sizeof(Vec3));
+        assert(sizeof(Vector3) == sizeof(Vec3));
+        for (int i = N_MATRIX_KERNEL_SETS - 1; i >= 0; i--) {
+            if (matrixKernelSetIsSupported(static_cast<MatrixKernelSet>(i))) {
+                kernelSet = static_cast<MatrixKernelSet>(i);
+                break;
+            }
+        }
+        isInitialized = true;
+    }
+    return kernelSet;
+}
+
+
+const MatrixKernelSet currentMatrixKernelSet(void)
+{
+    return currentKernelSet();
+}
+
+
+void selectMatrixKernelSet(const MatrixKernelSet kernelSet)
+//
+// overrides the automatic choice of kernels (mostly for testing)
+//
+{
+    assert(matrixKernelSetIsSupported(kernelSet));
+    currentKernelSet() = kernelSet;
+}
+
+
+void multiplyMatrix4s(const double a[16], const double b[16],
+                      double result[16])
+{
+    matrixKernels[currentKernelSet()].multiply(a, b, result);
+}
+
+
+void transformPoint3s(const double m[16], const Point3 points[],
+                      Point3 result[], const int n)
+{
+    matrixKernels[currentKernelSet()].transform(m, points, result, n, 1.0);
+}
+
+
+void transformVector3s(const double m[16], const Vector3 vectors[],
+                       Vector3 result[], const int n)
+{
+    matrixKernels[currentKernelSet()].transform(m, vectors, result, n, 0.0);
+}
+
+
+#ifdef TEST
+//
+// checks each supported kernel set against the portable one and times
+// them
+//
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+using namespace std;
+
+#include "clock.h"
+#include "wrap_cmath_inclusion.h"
+
+static double randomDouble(void)
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+
+int main(int argc, char **argv)
+{
+    const int nPoints = 1000;
+    const int nRepetitions = argc > 1 ? atoi(argv[1]) : 10000;
+    double a[16], b[16], expectedProduct[16];
+    Point3 *points = new Point3[nPoints];
+    Vector3 *vectors = new Vector3[nPoints];
+    Point3 *expectedPoints = new Point3[nPoints];
+    Point3 *resultPoints = new Point3[nPoints];
+    Vector3 *expectedVectors = new Vector3[nPoints];
+    Vector3 *resultVectors = new Vector3[nPoints];
+    int nFailures = 0;
+
+    for (int i = 0; i < 16; i++) {
+        a[i] = randomDouble();
+        b[i] = randomDouble();
+    }
+    for (int i = 0; i < nPoints; i++) {
+        points[i] = Point3(randomDouble(), randomDouble(), randomDouble());
+        vectors[i] = Vector3(randomDouble(), randomDouble(), randomDouble());
+    }
+
+    selectMatrixKernelSet(PORTABLE_KERNELS);
+    multiplyMatrix4s(a, b, expectedProduct);
+    transformPoint3s(a, points, expectedPoints, nPoints);
+    transformVector3s(a, vectors,
+                      expectedVectors, nPoints);
+
+    cout << setw(10) << "kernels" << setw(16) << "multiply (ns)"
+         << setw(16) << "point (ns)" << setw(16) << "vector (ns)" << "\n";
+    for (int iSet = 0; iSet < N_MATRIX_KERNEL_SETS; iSet++) {
+        MatrixKernelSet kernelSet = static_cast<MatrixKernelSet>(iSet);
+        if (!matrixKernelSetIsSupported(kernelSet)) {
+            cout << setw(10) << matrixKernelSetNames[iSet]
+                 << "  (not supported)\n";
+            continue;
+        }
+        selectMatrixKernelSet(kernelSet);
+
+        //
+        // correctness (FMA rounds differently, so allow some slop)
+        //
+        double product[16];
+        double maxError = 0.0;
+        multiplyMatrix4s(a, b, product);
+        for (int i = 0; i < 16; i++)
+            maxError = max(maxError, fabs(product[i] - expectedProduct[i]));
+        transformPoint3s(a, points, resultPoints, nPoints);
+        transformVector3s(a, vectors,
+                          resultVectors, nPoints);
+        for (int i = 0; i < nPoints; i++) {
+            for (int k = 0; k < 3; k++) {
+                maxError = max(maxError, fabs(resultPoints[i].u.a[k]
+                                              - expectedPoints[i].u.a[k]));
+                maxError = max(maxError, fabs(resultVectors[i].u.a[k]
+                                              - expectedVectors[i].u.a[k]));
+            }
+        }
+        // in place, too
+        double aCopy[16];
+        for (int i = 0; i < 16; i++)
+            aCopy[i] = a[i];
+        multiplyMatrix4s(aCopy, b, aCopy);
+        for (int i = 0; i < 16; i++)
+            maxError = max(maxError, fabs(aCopy[i] - expectedProduct[i]));
+        if (maxError > 1.0e-12) {
+            cerr << matrixKernelSetNames[iSet] << " kernels are off by "
+                 << maxError << "\n";
+            nFailures++;
+        }
+
+        //
+        // speed
+        //
+        double t0 = clock_.read();
+        for (int iRep = 0; iRep < nRepetitions * 100; iRep++)
+            multiplyMatrix4s(a, b, product);
+        double t1 = clock_.read();
+        for (int iRep = 0; iRep < nRepetitions; iRep++)
+            transformPoint3s(a, points, resultPoints, nPoints);
+        double t2 = clock_.read();
+        for (int iRep = 0; iRep < nRepetitions; iRep++)
+            transformVector3s(a, vectors,
+                              resultVectors, nPoints);
+        double t3 = clock_.read();
+
+        cout << setw(10) << matrixKernelSetNames[iSet] << fixed
+             << setprecision(2)
+             << setw(16) << 1.0e9 * (t1 - t0) / (nRepetitions * 100.0)
+             << setw(16) << 1.0e9 * (t2 - t1) / (nRepetitions * nPoints)
+             << setw(16) << 1.0e9 * (t3 - t2) / (nRepetitions * nPoints)
+             << "\n";
+    }
+    return nFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+#endif // TEST
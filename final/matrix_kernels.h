@@ -0,0 +1,42 @@
+#ifndef INCLUDED_MATRIX_KERNELS
+
+//
+// The "matrix_kernels" module provides the low level 4x4 matrix
+// multiply and point/vector transform loops used by Matrix4 and
+// Transform.
+//
+// All matrices are 16 doubles in OpenGL (column-major) order. Each
+// kernel comes in several versions (see MatrixKernelSet), the fastest
+// of which the CPU supports is chosen the first time any kernel is
+// called.
+//
+
+#include "geometry.h"
+
+enum MatrixKernelSet {
+    PORTABLE_KERNELS, // plain C++
+    SSE2_KERNELS,     // 2 doubles at a time (any x86-64)
+    AVX2_KERNELS,     // 4 doubles at a time, fused multiply-add
+    N_MATRIX_KERNEL_SETS
+};
+
+extern const char *matrixKernelSetNames[N_MATRIX_KERNEL_SETS];
+
+// `result` = `a` * `b` (`result` may be `a` or `b`)
+void multiplyMatrix4s(const double a[16], const double b[16],
+                      double result[16]);
+
+// `result[i]` = `m` * `points[i]` (`result` may be `points`)
+void transformPoint3s(const double m[16], const Point3 points[],
+                      Point3 result[], const int n);
+
+// `result[i]` = `m` * `vectors[i]` (`result` may be `vectors`)
+void transformVector3s(const double m[16], const Vector3 vectors[],
+                       Vector3 result[], const int n);
+
+const MatrixKernelSet currentMatrixKernelSet(void);
+const bool matrixKernelSetIsSupported(const MatrixKernelSet kernelSet);
+void selectMatrixKernelSet(const MatrixKernelSet kernelSet);
+
+#define INCLUDED_MATRIX_KERNELS
+#endif // INCLUDED_MATRIX_KERNELS
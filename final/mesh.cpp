@@ -1,13 +1,40 @@
+#include "arena.h"
+#include "check_gl.h"
 #include "mesh.h"
 
 
-const void Mesh::createHedgehogs(Hedgehog *&faceHedgehog,
-                                 Hedgehog *&vertexHedgehog) const
+Mesh::~Mesh()
 {
-    faceHedgehog = new Hedgehog(faceCentroids, faceNormals, nFaces,
-                                   yellowColor);
-    vertexHedgehog = new Hedgehog(vertexPositions, vertexNormals,
-                                     nVertices, yellowColor);
+    deleteArray(vertexPositions);
+    deleteArray(faceCentroids);
+    deleteArray(vertexNormals);
+    deleteArray(faceNormals);
+    CHECK_GL(glDeleteBuffers(1, &vertexPositionsBufferId));
+    CHECK_GL(glDeleteBuffers(1, &vertexNormalBufferId));
+}
+
+
+Hedgehog *Mesh::createFaceHedgehog(void)
+{
+    needFaceNormalsAndCentroids();
+    return new Hedgehog(faceCentroids, faceNormals, nFaces, yellowColor);
+}
+
+
+Hedgehog *Mesh::createVertexHedgehog(void) const
+{
+    return new Hedgehog(vertexPositions, vertexNormals, nVertices,
+                        yellowColor);
+}
+
+
+void Mesh::needFaceNormalsAndCentroids(void)
+//
+// creates `faceNormals` and `faceCentroids` if they don't exist yet
+//
+{
+    if (faceNormals == NULL)
+        createFaceNormalsAndCentroids();
 }
 
 
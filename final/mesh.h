@@ -20,18 +20,18 @@ class Mesh : public Tessellation
 //
 {
 public:
-    Point3 *vertexPositions;       // there are nVertices of these
+    Point3f *vertexPositions;      // there are nVertices of these
     int nVertices;
 
 protected:
     int nFaces;
-    Point3 *faceCentroids;   // there are nFaces of these
-    Vector3 *vertexNormals;  // there are nVertices of these
-    Vector3 *faceNormals;    // there are nFaces of these
+    Point3f *faceCentroids;  // there are nFaces of these (or NULL)
+    Vector3f *vertexNormals; // there are nVertices of these
+    Vector3f *faceNormals;   // there are nFaces of these (or NULL)
     unsigned int vertexPositionsBufferId;
     unsigned int vertexNormalBufferId;
 
-    static const Point3 triangleCentroid(Point3 p0, Point3 p1, Point3 p2)
+    static const Point3f triangleCentroid(Point3f p0, Point3f p1, Point3f p2)
     //
     // helper: returns the centroid of the (p0, p1, p2) triangle
     //
@@ -39,9 +39,19 @@ protected:
         return (p0 + p1 + p2) / 3;
     }
 
+    //
+    // Face normals and centroids are only needed by some renderings
+    // (and hedgehogs), so they're created on first use.
+    //
+    Mesh(void)
+        : faceCentroids(NULL), faceNormals(NULL)
+    { };
+    void needFaceNormalsAndCentroids(void);
+
 public:
-    const void createHedgehogs(Hedgehog *&faceHedgehog,
-                               Hedgehog *&vertexHedgehog) const;
+    virtual ~Mesh();
+    Hedgehog *createFaceHedgehog(void);
+    Hedgehog *createVertexHedgehog(void) const;
 
 protected:
     const virtual void createFaceNormalsAndCentroids(void) = 0;
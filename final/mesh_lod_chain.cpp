@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <vector>
+
+#include "mesh_lod_chain.h"
+#include "mesh_simplifier.h"
+#include "scene_object.h"
+
+// fraction of the original mesh's triangles in each level of detail
+static const double lodFractions[N_MESH_LODS] = { 1.00, 0.50, 0.25, 0.10 };
+
+
+MeshLodChain::MeshLodChain(IrregularMesh *original,
+                           const bool preserveBoundary)
+//
+// simplifies `original` into the chain's coarser levels of detail
+// (keeping the boundaries of open meshes if `preserveBoundary` is set)
+//
+{
+    meshes[0] = original;
+    errors[0] = 0.0;
+    nLods = 1;
+    for (int k = 0; k < N_MESH_LODS; k++)
+        faceHedgehogs[k] = vertexHedgehogs[k] = NULL;
+
+    Point3 pMin(original->vertexPositions[0]);
+    Point3 pMax = pMin;
+    for (int k = 1; k < original->nVertices; k++) {
+        Point3 p(original->vertexPositions[k]);
+
+        for (int c = 0; c < 3; c++) {
+            pMin.u.a[c] = min(pMin.u.a[c], p.u.a[c]);
+            pMax.u.a[c] = max(pMax.u.a[c], p.u.a[c]);
+        }
+    }
+    boundCenter = pMin + 0.5 * (pMax - pMin);
+    boundRadius = 0.5 * (pMax - pMin).mag();
+
+    MeshSimplifier simplifier(original->vertexPositions, original->nVertices,
+                              preserveBoundary);
+    const int nTrianglesOriginal = original->nVertices / 3;
+    for (int k = 1; k < N_MESH_LODS; k++) {
+        vector<Point3f> vertexPositions;
+        vector<Vector3f> vertexNormals;
+
+        simplifier.simplify(static_cast<int>(lodFractions[k]
+                                             * nTrianglesOriginal));
+        simplifier.getTriangles(vertexPositions, vertexNormals);
+
+        // A tiny mesh may collapse to nothing: the chain ends above it.
+        if (vertexPositions.empty())
+            break;
+        meshes[k] = new IrregularMesh(&vertexPositions[0], &vertexNormals[0],
+                                      vertexPositions.size());
+        errors[k] = simplifier.maxError();
+        nLods++;
+    }
+}
+
+
+MeshLodChain::~MeshLodChain()
+{
+    for (int k = 0; k < nLods; k++) {
+        delete faceHedgehogs[k];
+        delete vertexHedgehogs[k];
+    }
+    // (meshes[0] belongs to whoever created the chain.)
+    for (int k = 1; k < nLods; k++)
+        delete meshes[k];
+}
+
+
+IrregularMesh *MeshLodChain::select(const FrameContext &frameContext,
+                                    const Transform &worldTransform,
+                                    int &iLod) const
+//
+// returns the coarsest level of detail whose error, at the nearest
+// point of the mesh's bounding sphere as drawn with `worldTransform`,
+// is within MESH_LOD_MAX_SCREEN_ERROR, starting from (and updating)
+// `iLod`, the level the caller drew last
+//
+{
+    double worldScale = worldTransform.maxScale();
+    Point3 worldCenter = worldTransform * boundCenter;
+    double worldRadius = worldScale * boundRadius;
+
+    // If the mesh can't be seen, it doesn't matter which level we draw.
+    if (frameContext.sphereIsVisible(worldCenter, worldRadius)) {
+        // (pixels per model coordinate unit)
+        double pixelsPerUnit = worldScale
+            * frameContext.pixelsPerUnit(worldCenter, worldRadius);
+
+        while (iLod > 0
+               && errors[iLod] * pixelsPerUnit > MESH_LOD_MAX_SCREEN_ERROR)
+            iLod--;
+        while (iLod < nLods - 1
+               && MESH_LOD_HYSTERESIS * errors[iLod + 1] * pixelsPerUnit
+                   <= MESH_LOD_MAX_SCREEN_ERROR)
+            iLod++;
+    }
+    return meshes[iLod];
+}
+
+
+void MeshLodChain::displayHedgehogs(const FrameContext &frameContext,
+                                    const Transform &worldTransform,
+                                    const double quillLength,
+                                    const int iLod)
+//
+// displays the hedgehogs of level of detail `iLod` (as select()
+// returned it), so they match the surface that's drawn
+//
+{
+    SceneObject::displayHedgehog(meshes[iLod], faceHedgehogs[iLod],
+                                 vertexHedgehogs[iLod], frameContext,
+                                 worldTransform, quillLength);
+}
@@ -0,0 +1,71 @@
+#ifndef INCLUDED_MESH_LOD_CHAIN
+
+//
+// The "mesh_lod_chain" module provides the MeshLodChain class (see
+// below).
+//
+
+#include "frame_context.h"
+#include "geometry.h"
+#include "hedgehog.h"
+#include "irregular_mesh.h"
+#include "transform.h"
+
+enum {
+    N_MESH_LODS = 4 // levels of detail (including the original mesh)
+};
+
+//
+// the most error (in pixels) that a MeshLodChain's level of detail may
+// have on the screen
+//
+const double MESH_LOD_MAX_SCREEN_ERROR = 1.0;
+
+//
+// A MeshLodChain only switches to a coarser level of detail when that
+// level's error is this factor within the tolerance, so an object
+// whose error is near the tolerance doesn't pop back and forth
+// between levels.
+//
+const double MESH_LOD_HYSTERESIS = 1.5;
+
+
+class MeshLodChain
+//
+// an IrregularMesh and successively simplified copies of it (with
+// about 50%, 25%, and 10% of its triangles), one of which is drawn
+// depending on how large the mesh appears on the screen
+//
+// The copies are made by a MeshSimplifier when the chain is created.
+// Several objects may share a chain, so the level each one drew last
+// (see select()) is kept by that object. The hedgehogs of each level
+// belong to the chain, so they're shared, too.
+//
+{
+    // from finest (the original mesh, which the chain doesn't own) to
+    // coarsest, and their (model coordinate) errors
+    IrregularMesh *meshes[N_MESH_LODS];
+    double errors[N_MESH_LODS];
+    int nLods; // (fewer than N_MESH_LODS if simplification ran out)
+
+    // each level's hedgehogs (NULL until they're first displayed)
+    Hedgehog *faceHedgehogs[N_MESH_LODS];
+    Hedgehog *vertexHedgehogs[N_MESH_LODS];
+
+    // (model coordinate) bounding sphere
+    Point3 boundCenter;
+    double boundRadius;
+
+public:
+    MeshLodChain(IrregularMesh *original, const bool preserveBoundary = true);
+    ~MeshLodChain();
+
+    IrregularMesh *select(const FrameContext &frameContext,
+                          const Transform &worldTransform, int &iLod) const;
+    void displayHedgehogs(const FrameContext &frameContext,
+                          const Transform &worldTransform,
+                          const double quillLength, const int iLod);
+};
+
+#define INCLUDED_MESH_LOD_CHAIN
+#endif // INCLUDED_MESH_LOD_CHAIN
@@ -0,0 +1,757 @@
+#include <algorithm>
+#include <cassert>
+#include <queue>
+#include <unordered_map>
+
+#include "mesh_simplifier.h"
+#include "point_grid.h"
+#include "wrap_cmath_inclusion.h"
+
+//
+// Where two triangles meet at more than this angle, getTriangles()
+// gives their corners face normals instead of a shared vertex normal,
+// so creases stay sharp.
+//
+static const double CREASE_ANGLE = M_PI / 3.0; // 60 degrees
+
+
+static const double pointTriangleDistance(const Point3 &p, const Point3 &a,
+                                          const Point3 &b, const Point3 &c)
+//
+// helper: returns the distance from `p` to triangle (`a`, `b`, `c`)
+// (after Ericson, "Real-Time Collision Detection", section 5.1.5)
+//
+{
+    Vector3 ab = b - a, ac = c - a, ap = p - a;
+    double d1 = ab.dot(ap), d2 = ac.dot(ap);
+    if (d1 <= 0.0 && d2 <= 0.0)
+        return ap.mag(); // nearest `a`
+
+    Vector3 bp = p - b;
+    double d3 = ab.dot(bp), d4 = ac.dot(bp);
+    if (d3 >= 0.0 && d4 <= d3)
+        return bp.mag(); // nearest `b`
+
+    double vc = d1*d4 - d3*d2;
+    if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) // nearest edge ab
+        return (ap - (d1 / (d1 - d3)) * ab).mag();
+
+    Vector3 cp = p - c;
+    double d5 = ab.dot(cp), d6 = ac.dot(cp);
+    if (d6 >= 0.0 && d5 <= d6)
+        return cp.mag(); // nearest `c`
+
+    double vb = d5*d2 - d1*d6;
+    if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) // nearest edge ac
+        return (ap - (d2 / (d2 - d6)) * ac).mag();
+
+    double va = d3*d6 - d5*d4;
+    if (va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0) { // edge bc
+        double w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+        return (bp - w * (c - b)).mag();
+    }
+
+    // nearest the interior
+    double denom = 1.0 / (va + vb + vc);
+    return (ap - (vb * denom) * ab - (vc * denom) * ac).mag();
+}
+
+
+MeshSimplifier::Quadric::Quadric(void)
+{
+    for (int i = 0; i < 10; i++)
+        a[i] = 0.0;
+}
+
+
+MeshSimplifier::Quadric::Quadric(const Vector3 &normal, const double offset,
+                                 const double weight)
+//
+// the quadric of the squared distance to the plane `normal`.p +
+// `offset` = 0 (`normal` being unit length), times `weight`
+//
+{
+    const double plane[4] = {
+        normal.u.g.x, normal.u.g.y, normal.u.g.z, offset
+    };
+    int k = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int j = i; j < 4; j++)
+            a[k++] = weight * plane[i] * plane[j];
+    }
+}
+
+
+void MeshSimplifier::Quadric::operator+=(const Quadric &other)
+{
+    for (int i = 0; i < 10; i++)
+        a[i] += other.a[i];
+}
+
+
+const double MeshSimplifier::Quadric::error(const Point3 &p) const
+//
+// returns the (weighted) sum of the squared distances from `p` to the
+// quadric's planes
+//
+{
+    double x = p.u.g.x, y = p.u.g.y, z = p.u.g.z;
+
+    return a[0]*x*x + 2*a[1]*x*y + 2*a[2]*x*z + 2*a[3]*x
+                    +   a[4]*y*y + 2*a[5]*y*z + 2*a[6]*y
+                                 +   a[7]*z*z + 2*a[8]*z
+                                              +   a[9];
+}
+
+
+const bool MeshSimplifier::Quadric::minimizer(Point3 &p) const
+//
+// sets `p` to the point of least error and returns true, unless the
+// quadric is (nearly) singular (e.g. its planes are all parallel), in
+// which case it returns false
+//
+{
+    // Solve the 3x3 system A p = -b by Cramer's rule.
+    double a00 = a[0], a01 = a[1], a02 = a[2];
+    double a11 = a[4], a12 = a[5], a22 = a[7];
+    double b0 = -a[3], b1 = -a[6], b2 = -a[8];
+
+    double c00 = a11*a22 - a12*a12;
+    double c01 = a02*a12 - a01*a22;
+    double c02 = a01*a12 - a02*a11;
+    double det = a00*c00 + a01*c01 + a02*c02;
+
+    // (relative to the scale of the matrix)
+    double scale = fabs(a00) + fabs(a11) + fabs(a22);
+    if (fabs(det) <= 1.0e-9 * scale * scale * scale)
+        return false;
+
+    double c11 = a00*a22 - a02*a02;
+    double c12 = a01*a02 - a00*a12;
+    double c22 = a00*a11 - a01*a01;
+    p = Point3((c00*b0 + c01*b1 + c02*b2) / det,
+               (c01*b0 + c11*b1 + c12*b2) / det,
+               (c02*b0 + c12*b1 + c22*b2) / det);
+    return true;
+}
+
+
+MeshSimplifier::MeshSimplifier(const Point3f *vertexPositions,
+                               const int nVertices,
+                               const bool preserveBoundary)
+//
+// prepares the mesh of `nVertices` / 3 triangles in `vertexPositions`
+// for simplification
+//
+{
+    assert(nVertices % 3 == 0);
+
+    PointGrid pointGrid(SIMPLIFIER_WELD_TOLERANCE, nVertices);
+    for (int iVertex = 0; iVertex < nVertices; iVertex++) {
+        const Point3 p(vertexPositions[iVertex]);
+        int iWelded = pointGrid.findNear(p);
+
+        if (iWelded == NO_NEAR_POINT)
+            iWelded = pointGrid.add(p);
+        triangles.push_back(iWelded);
+    }
+
+    const int nWelded = pointGrid.nPoints();
+    for (int iVertex = 0; iVertex < nWelded; iVertex++)
+        positions.push_back(pointGrid[iVertex]);
+    originalPositions = positions;
+    quadrics.resize(nWelded);
+    isLocked.resize(nWelded, false);
+    stamps.resize(nWelded, 0);
+    trianglesOfVertex.resize(nWelded);
+    for (int iVertex = 0; iVertex < nWelded; iVertex++)
+        mergedInto.push_back(iVertex);
+
+    // count the triangles on each edge to find the boundary
+    unordered_map<long long, int> nTrianglesOfEdge;
+    const int nTriangles = triangles.size() / 3;
+    isDeleted.resize(nTriangles, false);
+    nTrianglesLeft = 0;
+    for (int iTriangle = 0; iTriangle < nTriangles; iTriangle++) {
+        const int *tri = &triangles[3 * iTriangle];
+        const Point3 &p0 = positions[tri[0]];
+        Vector3 crossProduct = (positions[tri[1]] - p0).cross(
+            positions[tri[2]] - p0);
+        double area2 = crossProduct.mag(); // twice the area
+
+        // Welding may have collapsed the triangle.
+        if (tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0]
+                || area2 == 0.0) {
+            isDeleted[iTriangle] = true;
+            continue;
+        }
+        nTrianglesLeft++;
+
+        Vector3 normal = crossProduct / area2;
+        Quadric quadric(normal, -normal.dot(p0 - Point3(0.0, 0.0, 0.0)),
+                        0.5 * area2);
+        for (int k = 0; k < 3; k++) {
+            quadrics[tri[k]] += quadric;
+            trianglesOfVertex[tri[k]].push_back(iTriangle);
+
+            long long i0 = tri[k], i1 = tri[(k + 1) % 3];
+            nTrianglesOfEdge[min(i0, i1) * nWelded + max(i0, i1)]++;
+        }
+    }
+
+    if (preserveBoundary) {
+        for (unordered_map<long long, int>::const_iterator it
+                 = nTrianglesOfEdge.begin();
+             it != nTrianglesOfEdge.end(); it++) {
+            if (it->second == 1) {
+                isLocked[it->first / nWelded] = true;
+                isLocked[it->first % nWelded] = true;
+            }
+        }
+    }
+}
+
+
+const bool MeshSimplifier::collapseIsValid(const int iVertex0,
+                                           const int iVertex1,
+                                           const Point3 &p) const
+//
+// helper: returns true iff merging `iVertex1` into `iVertex0` at `p`
+// keeps the mesh manifold and flips none of its triangles
+//
+{
+    //
+    // The "link condition": the vertices the two have in common must
+    // be exactly those of the triangles on the edge between them, or
+    // the collapse would pinch the mesh.
+    //
+    vector<int> neighbors0 = neighbors(iVertex0);
+    vector<int> neighbors1 = neighbors(iVertex1);
+    vector<int> common;
+    set_intersection(neighbors0.begin(), neighbors0.end(),
+                     neighbors1.begin(), neighbors1.end(),
+                     back_inserter(common));
+
+    int nShared = 0;
+    const int iVertices[2] = { iVertex0, iVertex1 };
+    for (int k = 0; k < 2; k++) {
+        const vector<int> &tris = trianglesOfVertex[iVertices[k]];
+
+        for (unsigned int iTri = 0; iTri < tris.size(); iTri++) {
+            if (isDeleted[tris[iTri]])
+                continue;
+
+            const int *tri = &triangles[3 * tris[iTri]];
+            int iOther = iVertices[1 - k];
+            if (tri[0] == iOther || tri[1] == iOther || tri[2] == iOther) {
+                nShared += (k == 0); // (count each shared one once)
+                continue;
+            }
+
+            // The triangle survives: make sure it doesn't flip.
+            Point3 q[3];
+            for (int m = 0; m < 3; m++)
+                q[m] = positions[tri[m]];
+            Vector3 before = (q[1] - q[0]).cross(q[2] - q[0]);
+            for (int m = 0; m < 3; m++) {
+                if (tri[m] == iVertices[k])
+                    q[m] = p;
+            }
+            Vector3 after = (q[1] - q[0]).cross(q[2] - q[0]);
+            if (after.dot(before) <= 0.0)
+                return false;
+        }
+    }
+    return static_cast<int>(common.size()) == nShared;
+}
+
+
+const int MeshSimplifier::find(int iVertex) const
+//
+// helper: returns the vertex that original vertex `iVertex` has been
+// merged into
+//
+{
+    while (mergedInto[iVertex] != iVertex)
+        iVertex = mergedInto[iVertex];
+    return iVertex;
+}
+
+
+void MeshSimplifier::getTriangles(vector<Point3f> &vertexPositions,
+                                  vector<Vector3f> &vertexNormals) const
+//
+// sets `vertexPositions` and `vertexNormals` to three vertices per
+// triangle of the (current) mesh, as IrregularMesh expects them
+//
+// Normals are the area-weighted average of the normals of the
+// triangles around each vertex, except at creases.
+//
+{
+    const int nTriangles = triangles.size() / 3;
+    vector<Vector3> faceNormals(nTriangles);
+    vector<Vector3> normalSums(positions.size());
+
+    for (int iTriangle = 0; iTriangle < nTriangles; iTriangle++) {
+        if (isDeleted[iTriangle])
+            continue;
+
+        const int *tri = &triangles[3 * iTriangle];
+        Vector3 crossProduct = (positions[tri[1]] - positions[tri[0]]).cross(
+            positions[tri[2]] - positions[tri[0]]);
+        double mag = crossProduct.mag();
+        if (mag > 0.0) // (Collapses can leave slivers of zero area.)
+            faceNormals[iTriangle] = crossProduct / mag;
+        for (int k = 0; k < 3; k++)
+            normalSums[tri[k]] += crossProduct; // (area-weighted)
+    }
+
+    const double cosCreaseAngle = cos(CREASE_ANGLE);
+    vertexPositions.clear();
+    vertexNormals.clear();
+    for (int iTriangle = 0; iTriangle < nTriangles; iTriangle++) {
+        if (isDeleted[iTriangle])
+            continue;
+
+        const int *tri = &triangles[3 * iTriangle];
+        for (int k = 0; k < 3; k++) {
+            Vector3 normal = faceNormals[iTriangle];
+            double mag = normalSums[tri[k]].mag();
+
+            if (mag > 0.0
+                    && normal.dot(normalSums[tri[k]]) >= cosCreaseAngle * mag)
+                normal = normalSums[tri[k]] / mag;
+            vertexPositions.push_back(Point3f(positions[tri[k]]));
+            vertexNormals.push_back(Vector3f(normal));
+        }
+    }
+}
+
+
+const double MeshSimplifier::maxError(void) const
+//
+// returns the largest distance from an original vertex to the
+// triangles around (and next to) the vertex it's been merged into, an
+// upper bound on the distance from the original vertices to the
+// current mesh (and, in practice, a close one)
+//
+{
+    double result = 0.0;
+
+    for (unsigned int iOriginal = 0; iOriginal < originalPositions.size();
+         iOriginal++) {
+        const int iVertex = find(iOriginal);
+        vector<int> nearVertices = neighbors(iVertex);
+        nearVertices.push_back(iVertex);
+        double distance = -1.0; // (none yet)
+
+        for (unsigned int iNear = 0; iNear < nearVertices.size(); iNear++) {
+            const vector<int> &tris = trianglesOfVertex[nearVertices[iNear]];
+
+            for (unsigned int iTri = 0; iTri < tris.size(); iTri++) {
+                if (isDeleted[tris[iTri]])
+                    continue;
+
+                const int *tri = &triangles[3 * tris[iTri]];
+                double d = pointTriangleDistance(
+                    originalPositions[iOriginal], positions[tri[0]],
+                    positions[tri[1]], positions[tri[2]]);
+                if (distance < 0.0 || d < distance)
+                    distance = d;
+            }
+        }
+        result = max(result, distance);
+    }
+    return result;
+}
+
+
+const vector<int> MeshSimplifier::neighbors(const int iVertex) const
+//
+// helper: returns the (sorted) vertices that share a triangle with
+// `iVertex`
+//
+{
+    vector<int> result;
+    const vector<int> &tris = trianglesOfVertex[iVertex];
+
+    for (unsigned int iTri = 0; iTri < tris.size(); iTri++) {
+        if (isDeleted[tris[iTri]])
+            continue;
+        for (int k = 0; k < 3; k++) {
+            int iOther = triangles[3 * tris[iTri] + k];
+            if (iOther != iVertex)
+                result.push_back(iOther);
+        }
+    }
+    sort(result.begin(), result.end());
+    result.erase(unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+
+void MeshSimplifier::queueCollapse(
+    const int iVertex0, const int iVertex1,
+    priority_queue<Collapse> &queue) const
+//
+// helper: adds the collapse of the edge from `iVertex0` to `iVertex1`
+// (the latter merging into the former) to `queue` at its cost
+//
+{
+    if (isLocked[iVertex0] && isLocked[iVertex1])
+        return;
+
+    Quadric quadric = quadrics[iVertex0];
+    quadric += quadrics[iVertex1];
+
+    const Point3 &p0 = positions[iVertex0];
+    const Point3 &p1 = positions[iVertex1];
+    Collapse collapse;
+    if (isLocked[iVertex0]) {
+        collapse.p = p0;
+    } else if (isLocked[iVertex1]) {
+        collapse.p = p1;
+    } else {
+        //
+        // Use the quadric's minimizer if there is one and it's near the
+        // edge (it can be far away on nearly flat regions), otherwise
+        // the best of the endpoints and midpoint.
+        //
+        Point3 pMid = p0 + 0.5 * (p1 - p0);
+        double edgeLength = (p1 - p0).mag();
+        if (!quadric.minimizer(collapse.p)
+                || (collapse.p - pMid).mag() > edgeLength) {
+            const Point3 candidates[3] = { p0, p1, pMid };
+
+            collapse.p = candidates[0];
+            for (int k = 1; k < 3; k++) {
+                if (quadric.error(candidates[k]) < quadric.error(collapse.p))
+                    collapse.p = candidates[k];
+            }
+        }
+    }
+    collapse.cost = max(quadric.error(collapse.p), 0.0);
+    collapse.iVertex0 = iVertex0;
+    collapse.iVertex1 = iVertex1;
+    collapse.stamp0 = stamps[iVertex0];
+    collapse.stamp1 = stamps[iVertex1];
+    queue.push(collapse);
+}
+
+
+void MeshSimplifier::simplify(const int nTrianglesTarget)
+//
+// collapses edges, least cost first, until there are no more than
+// `nTrianglesTarget` triangles (or no valid collapses are left)
+//
+{
+    priority_queue<Collapse> queue;
+    const int nTriangles = triangles.size() / 3;
+
+    for (int iTriangle = 0; iTriangle < nTriangles; iTriangle++) {
+        if (isDeleted[iTriangle])
+            continue;
+        for (int k = 0; k < 3; k++)
+            queueCollapse(triangles[3 * iTriangle + k],
+                          triangles[3 * iTriangle + (k + 1) % 3], queue);
+    }
+
+    while (nTrianglesLeft > nTrianglesTarget && !queue.empty()) {
+        Collapse collapse = queue.top();
+        queue.pop();
+
+        const int iVertex0 = collapse.iVertex0;
+        const int iVertex1 = collapse.iVertex1;
+
+        // Skip collapses queued before either vertex last changed.
+        if (collapse.stamp0 != stamps[iVertex0]
+                || collapse.stamp1 != stamps[iVertex1])
+            continue;
+        if (!collapseIsValid(iVertex0, iVertex1, collapse.p))
+            continue;
+
+        // Merge `iVertex1` into `iVertex0`.
+        positions[iVertex0] = collapse.p;
+        quadrics[iVertex0] += quadrics[iVertex1];
+        isLocked[iVertex0] = isLocked[iVertex0] || isLocked[iVertex1];
+        mergedInto[iVertex1] = iVertex0;
+        stamps[iVertex0]++;
+        stamps[iVertex1]++;
+
+        vector<int> &tris0 = trianglesOfVertex[iVertex0];
+        const vector<int> &tris1 = trianglesOfVertex[iVertex1];
+        for (unsigned int iTri = 0; iTri < tris1.size(); iTri++) {
+            const int iTriangle = tris1[iTri];
+            if (isDeleted[iTriangle])
+                continue;
+
+            int *tri = &triangles[3 * iTriangle];
+            if (tri[0] == iVertex0 || tri[1] == iVertex0
+                    || tri[2] == iVertex0) {
+                // (a triangle on the collapsed edge)
+                isDeleted[iTriangle] = true;
+                nTrianglesLeft--;
+            } else {
+                for (int k = 0; k < 3; k++) {
+                    if (tri[k] == iVertex1)
+                        tri[k] = iVertex0;
+                }
+                tris0.push_back(iTriangle);
+            }
+        }
+        trianglesOfVertex[iVertex1].clear();
+
+        // Drop deleted triangles and requeue the edges around the
+        // merged vertex, whose costs have changed.
+        vector<int> live;
+        for (unsigned int iTri = 0; iTri < tris0.size(); iTri++) {
+            if (!isDeleted[tris0[iTri]])
+                live.push_back(tris0[iTri]);
+        }
+        tris0.swap(live);
+
+        const vector<int> neighbors0 = neighbors(iVertex0);
+        for (unsigned int k = 0; k < neighbors0.size(); k++) {
+            // (Once a neighbor changes, this collapse is stale.)
+            queueCollapse(iVertex0, neighbors0[k], queue);
+            queueCollapse(neighbors0[k], iVertex0, queue);
+        }
+    }
+}
+
+
+#ifdef TEST
+//
+// simplifies a mesh (a sphere, or an OBJ file given as an argument)
+// to 50%, 25%, and 10% of its triangles, reporting the error of each
+// level of detail, and checks that an open mesh keeps its boundary
+//
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+
+#include "obj_io.h"
+
+struct PositionLess
+//
+// orders positions lexicographically, so they can key a map or set
+//
+{
+    bool operator()(const Point3f &p0, const Point3f &p1) const
+    {
+        for (int c = 0; c < 3; c++) {
+            if (p0.u.a[c] != p1.u.a[c])
+                return p0.u.a[c] < p1.u.a[c];
+        }
+        return false;
+    }
+};
+
+typedef set<Point3f, PositionLess> PositionSet;
+
+
+static const PositionSet boundaryPositions(
+    const vector<Point3f> &vertexPositions)
+//
+// returns the distinct positions of the vertices on the boundary of
+// the triangles in `vertexPositions` (i.e. on an edge with only one
+// triangle), which must share exactly equal positions
+//
+{
+    map<Point3f, int, PositionLess> iPositions;
+    vector<Point3f> positions;
+    map<pair<int, int>, int> nEdgeTriangles;
+
+    for (unsigned int iVertex = 0; iVertex + 2 < vertexPositions.size();
+         iVertex += 3) {
+        int iCorners[3];
+
+        for (int k = 0; k < 3; k++) {
+            const Point3f &p = vertexPositions[iVertex + k];
+
+            if (iPositions.find(p) == iPositions.end()) {
+                iPositions[p] = positions.size();
+                positions.push_back(p);
+            }
+            iCorners[k] = iPositions[p];
+        }
+        for (int k = 0; k < 3; k++) {
+            int i0 = iCorners[k], i1 = iCorners[(k + 1) % 3];
+            nEdgeTriangles[make_pair(min(i0, i1), max(i0, i1))]++;
+        }
+    }
+
+    PositionSet result;
+    for (map<pair<int, int>, int>::const_iterator it = nEdgeTriangles.begin();
+         it != nEdgeTriangles.end(); it++) {
+        if (it->second == 1) {
+            result.insert(positions[it->first.first]);
+            result.insert(positions[it->first.second]);
+        }
+    }
+    return result;
+}
+
+static void addSphere(vector<Point3f> &vertexPositions, const int nLatitudes,
+                      const int nLongitudes, const bool isHemisphere)
+//
+// adds the triangles of a (unit) sphere or, if `isHemisphere`, its
+// upper half (an open mesh) to `vertexPositions`
+//
+{
+    const int nRows = isHemisphere ? nLatitudes / 2 : nLatitudes;
+
+    for (int i = 0; i < nRows; i++) {
+        for (int j = 0; j < nLongitudes; j++) {
+            Point3 p[2][2];
+
+            for (int di = 0; di < 2; di++) {
+                double theta = M_PI * (i + di) / nLatitudes;
+
+                for (int dj = 0; dj < 2; dj++) {
+                    // (so the seam's positions match exactly)
+                    double phi = 2.0 * M_PI * ((j + dj) % nLongitudes)
+                        / nLongitudes;
+                    p[di][dj] = Point3(sin(theta) * cos(phi),
+                                       sin(theta) * sin(phi), cos(theta));
+                }
+            }
+            if (i > 0) { // (not at the north pole)
+                vertexPositions.push_back(Point3f(p[0][0]));
+                vertexPositions.push_back(Point3f(p[1][0]));
+                vertexPositions.push_back(Point3f(p[0][1]));
+            }
+            if (i < nLatitudes - 1) { // (not at the south pole)
+                vertexPositions.push_back(Point3f(p[0][1]));
+                vertexPositions.push_back(Point3f(p[1][0]));
+                vertexPositions.push_back(Point3f(p[1][1]));
+            }
+        }
+    }
+}
+
+
+static const int simplifyAndReport(MeshSimplifier &simplifier,
+                                   const int nTrianglesOriginal,
+                                   const bool mustReachTargets)
+//
+// simplifies to 50%, 25%, and 10% of `nTrianglesOriginal` triangles,
+// returning the number of levels that failed (missing their target,
+// if `mustReachTargets`)
+//
+{
+    const double fractions[] = { 0.50, 0.25, 0.10 };
+    int nFailures = 0;
+
+    cout << "      level  triangles  max. error\n";
+    cout << "      -----  ---------  ----------\n";
+    for (int iLevel = 0; iLevel < 3; iLevel++) {
+        int nTarget = static_cast<int>(fractions[iLevel]
+                                       * nTrianglesOriginal);
+
+        simplifier.simplify(nTarget);
+        cout << "      " << 100 * fractions[iLevel] << "%"
+             << "\t" << simplifier.nTriangles()
+             << "\t  " << simplifier.maxError() << "\n";
+
+        vector<Point3f> positions;
+        vector<Vector3f> normals;
+        simplifier.getTriangles(positions, normals);
+        if ((mustReachTargets && simplifier.nTriangles() > nTarget)
+                || static_cast<int>(positions.size())
+                       != 3 * simplifier.nTriangles())
+            nFailures++;
+    }
+    return nFailures;
+}
+
+
+int main(int argc, char **argv)
+{
+    vector<Point3f> vertexPositions;
+    int nFailures = 0;
+
+    if (argc > 1) {
+        vector<Point3> objPositions;
+        vector<Vector3> objNormals;
+        vector<Point2> objTextureCoordinates;
+        vector<Face> objFaces;
+
+        if (!readObj(argv[1], objPositions, objNormals,
+                     objTextureCoordinates, objFaces)) {
+            cerr << "unable to read \"" << argv[1] << "\" -- exiting\n";
+            exit(EXIT_FAILURE);
+        }
+        for (unsigned int iFace = 0; iFace < objFaces.size(); iFace++) {
+            const Face &face = objFaces[iFace];
+            vertexPositions.push_back(
+                Point3f(objPositions[face.faceVertex0.positionIndex]));
+            vertexPositions.push_back(
+                Point3f(objPositions[face.faceVertex1.positionIndex]));
+            vertexPositions.push_back(
+                Point3f(objPositions[face.faceVertex2.positionIndex]));
+        }
+        cout << argv[1];
+    } else {
+        addSphere(vertexPositions, 64, 128, false);
+        cout << "sphere";
+    }
+
+    // (Errors are only meaningful relative to the size of the mesh.)
+    Point3 pMin(vertexPositions[0]), pMax(vertexPositions[0]);
+    for (unsigned int iVertex = 0; iVertex < vertexPositions.size();
+         iVertex++) {
+        for (int c = 0; c < 3; c++) {
+            pMin.u.a[c] = min(pMin.u.a[c],
+                              double(vertexPositions[iVertex].u.a[c]));
+            pMax.u.a[c] = max(pMax.u.a[c],
+                              double(vertexPositions[iVertex].u.a[c]));
+        }
+    }
+    cout << " (bounding box diagonal " << (pMax - pMin).mag() << "):\n";
+
+    //
+    // An OBJ file may be made of many open pieces, whose boundaries
+    // can keep it from being simplified as far as we'd like.
+    //
+    MeshSimplifier simplifier(&vertexPositions[0], vertexPositions.size());
+    nFailures += simplifyAndReport(simplifier, vertexPositions.size() / 3,
+                                   argc <= 1);
+
+    //
+    // Simplify a hemisphere, preserving its boundary, and make sure
+    // the boundary (the equator) is exactly the same afterwards.
+    //
+    vector<Point3f> hemispherePositions;
+    addSphere(hemispherePositions, 64, 128, true);
+    PositionSet boundaryBefore = boundaryPositions(hemispherePositions);
+    MeshSimplifier hemisphereSimplifier(&hemispherePositions[0],
+                                        hemispherePositions.size(), true);
+    cout << "hemisphere (preserving boundary):\n";
+    nFailures += simplifyAndReport(hemisphereSimplifier,
+                                   hemispherePositions.size() / 3, true);
+
+    vector<Point3f> positions;
+    vector<Vector3f> normals;
+    hemisphereSimplifier.getTriangles(positions, normals);
+    PositionSet boundaryAfter = boundaryPositions(positions);
+    cout << "      boundary vertices: " << boundaryBefore.size()
+         << " before, " << boundaryAfter.size() << " after\n";
+    // (The equator has 128 vertices.)
+    if (boundaryBefore.size() != 128
+            || boundaryAfter.size() != boundaryBefore.size()
+            || !includes(boundaryBefore.begin(), boundaryBefore.end(),
+                         boundaryAfter.begin(), boundaryAfter.end(),
+                         PositionLess())) {
+        cerr << "hemisphere boundary not preserved\n";
+        nFailures++;
+    }
+
+    if (nFailures > 0) {
+        cerr << nFailures << " failures\n";
+        exit(EXIT_FAILURE);
+    }
+}
+#endif // TEST
@@ -0,0 +1,105 @@
+#ifndef INCLUDED_MESH_SIMPLIFIER
+
+//
+// The "mesh_simplifier" module provides the MeshSimplifier class (see
+// below).
+//
+
+#include <queue>
+#include <vector>
+
+#include "geometry.h"
+
+using namespace std;
+
+//
+// MeshSimplifier treats vertices within this distance (in each
+// coordinate) of each other as the same vertex.
+//
+const double SIMPLIFIER_WELD_TOLERANCE = 1.0e-6;
+
+
+class MeshSimplifier
+//
+// reduces the number of triangles in a mesh by collapsing edges, in
+// order of increasing quadric error (after Garland and Heckbert,
+// "Surface Simplification Using Quadric Error Metrics", SIGGRAPH 97)
+//
+// The mesh is given the way IrregularMesh stores it, as three vertex
+// positions per triangle, which are welded into shared vertices. Each
+// vertex accumulates the (area-weighted) planes of its original
+// triangles as a quadric, and an edge collapse moves the merged vertex
+// to where the sum of its two quadrics is least. Collapses that would
+// flip a triangle or make the mesh non-manifold are skipped.
+//
+// Simplification is incremental: simplify() can be called with
+// successively smaller targets to get a chain of levels of detail,
+// calling getTriangles() after each.
+//
+// If `preserveBoundary` is set, vertices on the boundary of an open
+// mesh (ones on an edge with only one triangle) never move, so holes
+// and silhouettes of open meshes keep their shape.
+//
+{
+    struct Quadric {
+        // the upper triangle of the symmetric 4x4 matrix, row by row
+        double a[10];
+
+        Quadric(void);
+        Quadric(const Vector3 &normal, const double offset,
+                const double weight);
+        void operator+=(const Quadric &other);
+        const double error(const Point3 &p) const;
+        const bool minimizer(Point3 &p) const;
+    };
+
+    struct Collapse {
+        double cost;
+        int iVertex0, iVertex1;
+        int stamp0, stamp1; // of the vertices when this was queued
+        Point3 p; // where the merged vertex goes
+
+        const bool operator<(const Collapse &other) const
+        {
+            return cost > other.cost; // (so the least cost is on top)
+        };
+    };
+
+    // welded vertices
+    vector<Point3> positions;
+    vector<Quadric> quadrics;
+    vector<bool> isLocked; // can't move (a boundary vertex, if preserved)
+    vector<int> stamps; // incremented whenever a vertex changes
+    vector< vector<int> > trianglesOfVertex; // (may include deleted ones)
+
+    vector<int> triangles; // 3 vertex indices per triangle
+    vector<bool> isDeleted; // per triangle
+    int nTrianglesLeft;
+
+    // original (welded) vertex positions and the vertex each became
+    vector<Point3> originalPositions;
+    vector<int> mergedInto;
+
+    const bool collapseIsValid(const int iVertex0, const int iVertex1,
+                               const Point3 &p) const;
+    const int find(int iVertex) const;
+    void queueCollapse(const int iVertex0, const int iVertex1,
+                       priority_queue<Collapse> &queue) const;
+    const vector<int> neighbors(const int iVertex) const;
+
+public:
+    MeshSimplifier(const Point3f *vertexPositions, const int nVertices,
+                   const bool preserveBoundary = true);
+
+    void getTriangles(vector<Point3f> &vertexPositions,
+                      vector<Vector3f> &vertexNormals) const;
+    const double maxError(void) const;
+    const int nTriangles(void) const
+    {
+        return nTrianglesLeft;
+    };
+    void simplify(const int nTrianglesTarget);
+};
+
+#define INCLUDED_MESH_SIMPLIFIER
+#endif // INCLUDED_MESH_SIMPLIFIER
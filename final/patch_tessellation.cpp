@@ -0,0 +1,73 @@
+#include "arena.h"
+#include "check_gl.h"
+#include "patch_tessellation.h"
+#include "render_stats.h"
+#include "shader_programs.h"
+
+// control vertices per (bicubic) patch
+static const int N_PATCH_VERTICES = 16;
+
+
+void PatchTessellation::allocateBuffers(void)
+{
+    CHECK_GL(glGenBuffers(1, &controlVerticesBufferId));
+}
+
+
+PatchTessellation::PatchTessellation(const Point3 patchCvs[][4][4],
+                                     const int nPatches_)
+    : nPatches(nPatches_)
+{
+    controlVertices = newArray<Point3f[4][4]>(nPatches);
+    for (int iPatch = 0; iPatch < nPatches; iPatch++) {
+        for (int i = 0; i < 4; i++) {
+            for (int j = 0; j < 4; j++)
+                controlVertices[iPatch][i][j]
+                    = Point3f(patchCvs[iPatch][i][j]);
+        }
+    }
+
+    allocateBuffers();
+    //
+    // The patches are evaluated in model coordinates, so (as for
+    // Meshes) the control vertices only need to be downloaded once.
+    //
+    updateBuffers();
+}
+
+
+PatchTessellation::~PatchTessellation()
+{
+    deleteArray(controlVertices);
+    CHECK_GL(glDeleteBuffers(1, &controlVerticesBufferId));
+}
+
+
+const void PatchTessellation::render(void)
+{
+    GLint vpai = ShaderProgram::getCurrentAttributeIndex("vertexPosition");
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, controlVerticesBufferId));
+    CHECK_GL(glEnableVertexAttribArray(vpai));
+    CHECK_GL(glVertexAttribPointer(
+                 vpai, // index of attribute
+                 3, // # of elements per attribute
+                 GL_FLOAT, // type of each component
+                 GL_FALSE,  // don't normalized fixed-point values
+                 0, // offset between consecutive generic vertex attributes
+                 BUFFER_OFFSET(0)));
+
+    CHECK_GL(glPatchParameteri(GL_PATCH_VERTICES, N_PATCH_VERTICES));
+    CHECK_GL(glDrawArrays(GL_PATCHES, 0, N_PATCH_VERTICES * nPatches));
+
+    renderStats.ctPatches += nPatches;
+}
+
+
+void PatchTessellation::updateBuffers(void)
+{
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, controlVerticesBufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                          sizeof(controlVertices[0]) * nPatches,
+                          controlVertices, GL_STATIC_DRAW));
+}
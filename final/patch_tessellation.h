@@ -0,0 +1,37 @@
+#ifndef INCLUDED_PATCH_TESSELLATION
+
+//
+// The "patch_tessellation" module provides the PatchTessellation
+// class (see below).
+//
+
+#include "geometry.h"
+#include "tessellation.h"
+
+
+class PatchTessellation : public Tessellation
+//
+// a set of bicubic Bezier patches that are tessellated on the GPU
+//
+// Only the control vertices are kept (and sent to the GPU), 16 per
+// patch, in BezierPatch's `cvs[i][j]` order. render() draws them as
+// GL_PATCHES, so the current ShaderProgram must be a
+// BezierPatchShaderProgram, which chooses the level of detail per
+// patch and per frame.
+//
+{
+    Point3f (*controlVertices)[4][4]; // there are nPatches of these
+    int nPatches;
+    unsigned int controlVerticesBufferId;
+
+public:
+    PatchTessellation(const Point3 patchCvs[][4][4], const int nPatches_);
+    ~PatchTessellation();
+
+    void allocateBuffers(void);
+    const void render(void);
+    void updateBuffers(void);
+};
+
+#define INCLUDED_PATCH_TESSELLATION
+#endif // INCLUDED_PATCH_TESSELLATION
@@ -0,0 +1,194 @@
+#include "point_grid.h"
+#include "wrap_cmath_inclusion.h"
+
+//
+// Cell indices are limited to this magnitude, well within a long long
+// (even after adding the +/-1 to get a neighbor), and exactly
+// representable as a double.
+//
+static const double MAX_CELL_INDEX = 4503599627370496.0; // (2^52)
+
+
+PointGrid::PointGrid(const double tolerance_, const int nPointsExpected)
+    : tolerance(tolerance_)
+{
+    assert(tolerance > 0.0);
+    points.reserve(nPointsExpected);
+    nextInCell.reserve(nPointsExpected);
+    firstInCell.reserve(nPointsExpected);
+}
+
+
+static const long long cellIndex(const double x, const double tolerance)
+//
+// helper: returns the index of the cells containing coordinate `x`
+// (clamped to +/-MAX_CELL_INDEX, since converting a double that's
+// out of range of a long long is undefined)
+//
+{
+    double index = floor(x / tolerance);
+
+    if (!(index > -MAX_CELL_INDEX)) // (also catches NaN)
+        index = -MAX_CELL_INDEX;
+    else if (index > MAX_CELL_INDEX)
+        index = MAX_CELL_INDEX;
+    return (long long) index;
+}
+
+
+const PointGrid::Cell PointGrid::cellOf(const Point3 &p) const
+//
+// helper: returns the cell containing `p`
+//
+{
+    Cell cell;
+
+    cell.i = cellIndex(p.u.g.x, tolerance);
+    cell.j = cellIndex(p.u.g.y, tolerance);
+    cell.k = cellIndex(p.u.g.z, tolerance);
+    return cell;
+}
+
+
+const int PointGrid::add(const Point3 &p)
+//
+// adds `p` to the grid (whether or not there's already a point near
+// it) and returns its index
+//
+{
+    int iPoint = points.size();
+    Cell cell = cellOf(p);
+    unordered_map<Cell, int, CellHash>::iterator first
+        = firstInCell.find(cell);
+
+    points.push_back(p);
+    if (first == firstInCell.end()) {
+        nextInCell.push_back(-1);
+        firstInCell[cell] = iPoint;
+    } else {
+        // push it on the front of the cell's list
+        nextInCell.push_back(first->second);
+        first->second = iPoint;
+    }
+    return iPoint;
+}
+
+
+const int PointGrid::findNear(const Point3 &p) const
+//
+// returns the index of a point in the grid whose coordinates all
+// differ from those of `p` by less than the tolerance, or
+// NO_NEAR_POINT if there isn't one
+//
+{
+    Cell center = cellOf(p);
+
+    for (int di = -1; di <= 1; di++) {
+        for (int dj = -1; dj <= 1; dj++) {
+            for (int dk = -1; dk <= 1; dk++) {
+                Cell cell = { center.i + di, center.j + dj, center.k + dk };
+                unordered_map<Cell, int, CellHash>::const_iterator first
+                    = firstInCell.find(cell);
+                if (first == firstInCell.end())
+                    continue;
+                for (int iPoint = first->second; iPoint != -1;
+                     iPoint = nextInCell[iPoint]) {
+                    const Point3 &q = points[iPoint];
+                    if (   fabs(q.u.g.x - p.u.g.x) < tolerance
+                        && fabs(q.u.g.y - p.u.g.y) < tolerance
+                        && fabs(q.u.g.z - p.u.g.z) < tolerance)
+                        return iPoint;
+                }
+            }
+        }
+    }
+    return NO_NEAR_POINT;
+}
+
+
+#ifdef TEST
+//
+// checks PointGrid::findNear() against a brute force search and
+// times both, and checks points too far out to have their own cells
+//
+#include <cstdlib>
+#include <iostream>
+using namespace std;
+
+#include "clock.h"
+
+static double randomDouble(void)
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+
+int main(int argc, char **argv)
+{
+    const int nPoints = (argc > 1) ? atoi(argv[1]) : 20000;
+    const double tolerance = 1.0e-6;
+    vector<Point3> points;
+
+    // random points, every 10th of which is (nearly) a copy of an
+    // earlier one
+    for (int iPoint = 0; iPoint < nPoints; iPoint++) {
+        if (iPoint % 10 == 9) {
+            Point3 p = points[rand() % iPoint];
+            p.u.g.x += 0.5 * tolerance * randomDouble();
+            points.push_back(p);
+        } else {
+            points.push_back(Point3(randomDouble(), randomDouble(),
+                                    randomDouble()));
+        }
+    }
+
+    double startTime = clock_.read();
+    PointGrid pointGrid(tolerance, nPoints);
+    vector<int> gridNear;
+    for (int iPoint = 0; iPoint < nPoints; iPoint++) {
+        gridNear.push_back(pointGrid.findNear(points[iPoint]));
+        pointGrid.add(points[iPoint]);
+    }
+    double gridTime = clock_.read() - startTime;
+
+    startTime = clock_.read();
+    int nMismatches = 0, nDuplicates = 0;
+    for (int iPoint = 0; iPoint < nPoints; iPoint++) {
+        const Point3 &p = points[iPoint];
+        bool isDuplicate = false;
+        for (int jPoint = 0; jPoint < iPoint; jPoint++) {
+            const Point3 &q = points[jPoint];
+            if (   fabs(p.u.g.x - q.u.g.x) < tolerance
+                && fabs(p.u.g.y - q.u.g.y) < tolerance
+                && fabs(p.u.g.z - q.u.g.z) < tolerance) {
+                isDuplicate = true;
+                break;
+            }
+        }
+        nDuplicates += isDuplicate;
+        if (isDuplicate != (gridNear[iPoint] != NO_NEAR_POINT))
+            nMismatches++;
+    }
+    double bruteForceTime = clock_.read() - startTime;
+
+    cout << nPoints << " points, " << nDuplicates << " near duplicates\n";
+    cout << "grid: " << gridTime << " s, brute force: "
+         << bruteForceTime << " s\n";
+    if (nMismatches > 0) {
+        cerr << nMismatches << " points where grid and brute force disagree\n";
+        exit(EXIT_FAILURE);
+    }
+
+    // (With a tiny tolerance, these are far beyond MAX_CELL_INDEX.)
+    PointGrid farGrid(1.0e-12);
+    const Point3 farPoint(1.0e10, -3.0e20, 5.0);
+    farGrid.add(farPoint);
+    farGrid.add(Point3(2.0e10, -3.0e20, 5.0));
+    if (farGrid.findNear(farPoint) != 0
+            || farGrid.findNear(Point3(1.0e10, 3.0e20, 5.0))
+                   != NO_NEAR_POINT) {
+        cerr << "far points not found correctly\n";
+        exit(EXIT_FAILURE);
+    }
+}
+#endif // TEST
@@ -0,0 +1,72 @@
+#ifndef INCLUDED_POINT_GRID
+
+//
+// The "point_grid" module provides the PointGrid class (see below).
+//
+
+#include <unordered_map>
+#include <vector>
+
+#include "geometry.h"
+
+using namespace std;
+
+// returned by PointGrid::findNear() when there's no nearby point
+const int NO_NEAR_POINT = -1;
+
+
+class PointGrid
+//
+// a spatial hash of points, for finding coincident (or nearly so)
+// points in expected O(1) time per point
+//
+// Space is divided into cubical cells `tolerance` on a side, so any
+// point within `tolerance` (in each coordinate) of a given point is
+// either in the same cell or in one of the 26 around it. (Cells too
+// far from the origin to number are merged into those at the limit,
+// which only makes them slower to search.)
+//
+{
+    struct Cell {
+        long long i, j, k;
+
+        bool operator==(const Cell &other) const
+        {
+            return i == other.i && j == other.j && k == other.k;
+        };
+    };
+
+    struct CellHash {
+        size_t operator()(const Cell &cell) const
+        {
+            // (large primes, after Teschner et al., in unsigned
+            // arithmetic, which wraps around rather than overflowing)
+            return ((unsigned long long) cell.i * 73856093ULL)
+                ^ ((unsigned long long) cell.j * 19349663ULL)
+                ^ ((unsigned long long) cell.k * 83492791ULL);
+        };
+    };
+
+    double tolerance;
+    vector<Point3> points;
+    vector<int> nextInCell; // the next point in the same cell, or -1
+    unordered_map<Cell, int, CellHash> firstInCell;
+
+    const Cell cellOf(const Point3 &p) const;
+
+public:
+    PointGrid(const double tolerance_, const int nPointsExpected = 0);
+    const int add(const Point3 &p);
+    const int findNear(const Point3 &p) const;
+    const int nPoints(void) const
+    {
+        return points.size();
+    };
+    const Point3 &operator[](const int iPoint) const
+    {
+        return points[iPoint];
+    };
+};
+
+#define INCLUDED_POINT_GRID
+#endif // INCLUDED_POINT_GRID
@@ -1,3 +1,4 @@
+#include "arena.h"
 #include "check_gl.h"
 #include "color.h"
 #include "controller.h"
@@ -12,6 +13,12 @@
 
 void PolyLine::allocateBuffers(void)
 {
+    vertexPositionsOffset = 0;
+    if (usage == STREAMED_VERTEX_DATA) {
+        vertexPositionsBufferId = scene->streamBuffer->bufferId;
+        return;
+    }
+
     // Allocate a buffer for the vertex coordinates ...
     CHECK_GL(glGenBuffers(1, &vertexPositionsBufferId));
 }
@@ -19,23 +26,42 @@ void PolyLine::allocateBuffers(void)
 
 void PolyLine::updateBuffers(void)
 {
+    if (usage == STREAMED_VERTEX_DATA) {
+        vertexPositionsOffset = scene->streamBuffer->upload(
+            vertexPositions, nVertices * sizeof(vertexPositions[0]));
+        return;
+    }
     CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
     CHECK_GL(glBufferData(GL_ARRAY_BUFFER, nVertices*sizeof(vertexPositions[0]),
                           vertexPositions, GL_STATIC_DRAW));
 }
 
 
-PolyLine::PolyLine(Point3 *vertexPositions_, int nVertices_, bool wrapI_)
-    : nVertices(nVertices_), wrapI(wrapI_)
+PolyLine::PolyLine(Point3f *vertexPositions_, int nVertices_, bool wrapI_,
+                   const ArrayOwnership ownership,
+                   const VertexDataUsage usage_)
+    : nVertices(nVertices_), wrapI(wrapI_), usage(usage_)
 {
-    vertexPositions = new Point3[nVertices];
-    for (int i = 0; i < nVertices; i++)
-        vertexPositions[i] = vertexPositions_[i];
+    if (ownership == ADOPT_ARRAYS) {
+        vertexPositions = vertexPositions_;
+    } else {
+        vertexPositions = newArray<Point3f>(nVertices);
+        for (int i = 0; i < nVertices; i++)
+            vertexPositions[i] = vertexPositions_[i];
+    }
     allocateBuffers();
     updateBuffers();
 }
 
 
+PolyLine::~PolyLine()
+{
+    deleteArray(vertexPositions);
+    if (usage == STATIC_VERTEX_DATA)
+        CHECK_GL(glDeleteBuffers(1, &vertexPositionsBufferId));
+}
+
+
 const void PolyLine::render(void)
 {
     CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
@@ -43,10 +69,10 @@ const void PolyLine::render(void)
     CHECK_GL(glVertexAttribPointer(
                  0, // index of attribute
                  3, // # of elements per attribute
-                 GL_DOUBLE, // type of each component
+                 GL_FLOAT, // type of each component
                  GL_FALSE,  // don't normalized fixed-point values
                  0, // offset between consecutive generic vertex attributes
-                 BUFFER_OFFSET(0)));
+                 BUFFER_OFFSET(vertexPositionsOffset)));
     if (wrapI)
         CHECK_GL(glDrawArrays(GL_LINE_LOOP, 0, nVertices));
     else
@@ -22,8 +22,9 @@ class PolyLine : public Tessellation
 //
 {
 public:
-    Point3 *vertexPositions;
+    Point3f *vertexPositions;
     unsigned int vertexPositionsBufferId;
+    size_t vertexPositionsOffset; // (in bytes) within that buffer
     int nVertices;
     //
     // A convention we will follow for polylines (and beyond) is that
@@ -38,9 +39,13 @@ public:
     // points are still distinct.
     //
     bool wrapI;
+    VertexDataUsage usage;
 
 public:
-    PolyLine(Point3 *vertexPositions, int nI, bool wrapI);
+    PolyLine(Point3f *vertexPositions, int nI, bool wrapI,
+             const ArrayOwnership ownership = COPY_ARRAYS,
+             const VertexDataUsage usage_ = STATIC_VERTEX_DATA);
+    ~PolyLine();
 
     void allocateBuffers(void);
     // Transforms will be set in the draw() method.
@@ -1,10 +1,18 @@
 #include <cassert>
 
+#include "arena.h"
+#include "point_grid.h"
 #include "render_stats.h"
 #include "regular_mesh.h"
 
 #include <iostream>
 
+//
+// RegularMesh::pointsAreDistinct() reports (at most) this many pairs
+// of coincident vertices.
+//
+static const int MAX_COINCIDENT_VERTICES_REPORTED = 10;
+
 void RegularMesh::allocateBuffers(void)
 {
     //
@@ -37,41 +45,41 @@ void RegularMesh::updateBuffers(void)
 
 bool RegularMesh::pointsAreDistinct(void)
 //
-// helper: Make sure all vertices in a regular mesh are distinct.
+// helper: Make sure all vertices in a regular mesh are distinct,
+// reporting any that aren't.
 //
 {
+    //
+    // Comparing all pairs of vertices takes O(n^2) time, which is
+    // far too slow for big meshes (even in debug builds), so use a
+    // spatial hash instead.
+    //
+    PointGrid pointGrid(EPSILON, nVertices);
+    int nCoincident = 0;
+
     for (int iVertex = 0; iVertex < nVertices; iVertex++) {
-        for (int jVertex = 0; jVertex < iVertex; jVertex++) {
-            //
-            // Interesting programming note: The body of this loop
-            // originally looked like this:
-            //
-            //   Vector3 diff = vertexPositions[iVertex]
-            //            - vertexPositions[jVertex];
-            //   if (       fabs(diff.u.g.x) < EPSILON
-            //           && fabs(diff.u.g.y) < EPSILON
-            //           && fabs(diff.u.g.z) < EPSILON)
-            //       return false;
-            //
-            // But rewriting it as below cut the time by 60%:
-            //
-            double dx = vertexPositions[iVertex].u.g.x
-                - vertexPositions[jVertex].u.g.x;
-            double dy = vertexPositions[iVertex].u.g.y
-                - vertexPositions[jVertex].u.g.y;
-            double dz = vertexPositions[iVertex].u.g.z
-                - vertexPositions[jVertex].u.g.z;
-            if (     -EPSILON < dx && dx < EPSILON
-                  && -EPSILON < dy && dy < EPSILON
-                  && -EPSILON < dz && dz < EPSILON)
-                      return false;
+        int jVertex = pointGrid.findNear(Point3(vertexPositions[iVertex]));
+        if (jVertex != NO_NEAR_POINT) {
+            if (nCoincident < MAX_COINCIDENT_VERTICES_REPORTED) {
+                cerr << "RegularMesh: vertices (" << jVertex % nI << ", "
+                     << jVertex / nI << ") and (" << iVertex % nI << ", "
+                     << iVertex / nI << ") coincide at "
+                     << vertexPositions[iVertex] << "\n";
+            }
+            nCoincident++;
         }
+        pointGrid.add(Point3(vertexPositions[iVertex]));
     }
-    return true;
+    if (nCoincident > MAX_COINCIDENT_VERTICES_REPORTED) {
+        cerr << "RegularMesh: (and "
+             << nCoincident - MAX_COINCIDENT_VERTICES_REPORTED
+             << " more coincident vertices)\n";
+    }
+    return nCoincident == 0;
 }
 
 
-void RegularMesh::quadBoundary(int iLeft, int jLower, Point3 p[4])
+void RegularMesh::quadBoundary(int iLeft, int jLower, Point3f p[4])
 //
 // possible helper: returns (in p[]) the four points bounding the two
 // faces of the quad in CCW order. It takes account of wrapping in
@@ -129,7 +137,7 @@ const void RegularMesh::render(void)
     CHECK_GL(glVertexAttribPointer(
                  vpai, // index of attribute
                  3, // # of elements per attribute
-                 GL_DOUBLE, // type of each component
+                 GL_FLOAT, // type of each component
                  GL_FALSE,  // don't normalized fixed-point values
                  0, // offset between consecutive generic vertex attributes
                  BUFFER_OFFSET(0)));
@@ -144,7 +152,7 @@ const void RegularMesh::render(void)
        CHECK_GL(glVertexAttribPointer(
                     vnai, // index of attribute
                     3, // # of elements per attribute
-                    GL_DOUBLE, // type of each component
+                    GL_FLOAT, // type of each component
                     GL_FALSE,  // don't normalized fixed-point values
                     0, // offset between consecutive generic vertex attributes
                     BUFFER_OFFSET(0)));
@@ -182,7 +190,7 @@ void RegularMesh::createVertexIndices(void)
     int nIndicesPerTriangleStrip = 2 * (nI + wrapI);
     int nTriangleStrips = nJ - 1 + wrapJ;
     nVertexIndices = nIndicesPerTriangleStrip * nTriangleStrips;
-    vertexIndices = new unsigned int [nVertexIndices];
+    vertexIndices = newArray<unsigned int>(nVertexIndices);
     int iVertexIndices = 0;
     for (int j = 0; j < nJ - 1 + wrapJ; j++) {
         int jTop = j + 1;
@@ -203,16 +211,21 @@ void RegularMesh::createVertexIndices(void)
 }
 
 
-RegularMesh::RegularMesh(Point3 *vertexPositions_, Vector3 *vertexNormals_,
-           int nI_, int nJ_, bool wrapI_, bool wrapJ_)
+RegularMesh::RegularMesh(Point3f *vertexPositions_, Vector3f *vertexNormals_,
+           int nI_, int nJ_, bool wrapI_, bool wrapJ_,
+           const ArrayOwnership ownership)
     : nI(nI_), nJ(nJ_), wrapI(wrapI_), wrapJ(wrapJ_)
 {
     nVertices = nI * nJ;
-    vertexPositions = new Point3[nVertices];
-    vertexNormals = new Vector3[nVertices];
-    for (int i = 0; i < nVertices; i++) {
-        vertexPositions[i] = vertexPositions_[i];
-        vertexNormals[i] = vertexNormals_[i];
+    if (ownership == ADOPT_ARRAYS) {
+        vertexPositions = vertexPositions_;
+        vertexNormals = vertexNormals_;
+    } else {
+        vertexPositions = newArray<Point3f>(nVertices);
+        vertexNormals = newArray<Vector3f>(nVertices);
+        copy(vertexPositions_, vertexPositions_ + nVertices,
+             vertexPositions);
+        copy(vertexNormals_, vertexNormals_ + nVertices, vertexNormals);
     }
 
     // This enforces our requirement for distinct mesh points and thus
@@ -226,7 +239,8 @@ RegularMesh::RegularMesh(Point3 *vertexPositions_, Vector3 *vertexNormals_,
     assert(pointsAreDistinct());
 
     createVertexIndices();
-    createFaceNormalsAndCentroids();
+    // (face normals and centroids are created on demand)
+    nFaces = 2 * (nI + wrapI - 1) * (nJ + wrapJ - 1);
 
     allocateBuffers();
     //
@@ -238,6 +252,13 @@ RegularMesh::RegularMesh(Point3 *vertexPositions_, Vector3 *vertexNormals_,
 }
 
 
+RegularMesh::~RegularMesh()
+{
+    deleteArray(vertexIndices);
+    CHECK_GL(glDeleteBuffers(1, &indexBufferId));
+}
+
+
 const void RegularMesh::createFaceNormalsAndCentroids(void)
 {
     //
@@ -246,11 +267,11 @@ const void RegularMesh::createFaceNormalsAndCentroids(void)
     int iFaces = nI + wrapI - 1;
     int jFaces = nJ + wrapJ - 1;
 
-    nFaces = iFaces * jFaces * 2;
+    assert(nFaces == iFaces * jFaces * 2);
 
     // create the faceNormals and faceCentroids
-    faceNormals = new Vector3[nFaces];
-    faceCentroids = new Point3[nFaces];
+    faceNormals = newArray<Vector3f>(nFaces);
+    faceCentroids = newArray<Point3f>(nFaces);
 
     for(int i = 0; i < iFaces; i++){
       for (int j = 0; j < jFaces; j++) {
@@ -258,7 +279,7 @@ const void RegularMesh::createFaceNormalsAndCentroids(void)
           int ulIndex = faceIndex(i, j, true);
           int lrIndex = faceIndex(i, j, false);
 
-          Point3 *p = new Point3[4];
+          Point3f p[4];
 
           // get the quad boundary into the point p;
           quadBoundary(i, j, p);
@@ -269,9 +290,6 @@ const void RegularMesh::createFaceNormalsAndCentroids(void)
 
           faceNormals[ulIndex] = faceNormal(p[0], p[2], p[3]);
           faceNormals[lrIndex] = faceNormal(p[0], p[1], p[2]);
-
-          // delete the points we allocated for quadboundary
-          delete[] p;
       }
     }
 }
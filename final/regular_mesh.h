@@ -50,7 +50,7 @@ class RegularMesh : public Mesh
     static const int MAX_INCIDENT_FACES_ON_VERTEX = 6;
     int incidentFaceIndices(const int i, const int j,
                             int iFs[MAX_INCIDENT_FACES_ON_VERTEX]);
-    void quad(int i, int j, Point3 pQuad[4]);
+    void quad(int i, int j, Point3f pQuad[4]);
 
     const int vertexIndex(int i, int j) const
     //
@@ -67,8 +67,10 @@ class RegularMesh : public Mesh
     };
 
 public:
-    RegularMesh(Point3 *vertexPositions_, Vector3 *vertexNormals_,
-        int nI, int nJ, bool wrapI, bool wrapJ);
+    RegularMesh(Point3f *vertexPositions_, Vector3f *vertexNormals_,
+        int nI, int nJ, bool wrapI, bool wrapJ,
+        const ArrayOwnership ownership = COPY_ARRAYS);
+    ~RegularMesh();
 
     const void render(void);
     void updateBuffers(void);
@@ -78,7 +80,7 @@ private:
     const void createFaceNormalsAndCentroids(void);
     void createVertexIndices(void);
     bool pointsAreDistinct(void);
-    void quadBoundary(int i, int j, Point3 p[4]);
+    void quadBoundary(int i, int j, Point3f p[4]);
     const void renderTriangleStrip(const int j) const;
 };
 
@@ -53,8 +53,8 @@ void RenderStats::display()
     }
     meanFrameTimeUsec = 1.e6 * meanFrameTime; // in microseconds
     frameRate = 1.0 / meanFrameTime;
-    triangleRate = (ctTrianglesInIrregularMeshes + ctTrianglesInRegularMeshes)
-        / meanFrameTime;
+    triangleRate = (ctTrianglesInIrregularMeshes + ctTrianglesInRegularMeshes
+                    + ctTrianglesInIndexedMeshes) / meanFrameTime;
     // display speed in m/s
     double observerSpeed = scene->cameraSpeed() * METERS_PER_LENGTH_UNIT;
 
@@ -72,7 +72,12 @@ void RenderStats::display()
                                       true, -1, &ctTrianglesInIrregularMeshes },
         { "triangles (in regular meshes)",
                                       true, -1, &ctTrianglesInRegularMeshes },
+        { "triangles (in indexed meshes)",
+                                      true, -1, &ctTrianglesInIndexedMeshes },
         { "triangle strips",          true, -1, &ctTriangleStrips },
+        { "patches (GPU tessellated)",
+                                      true, -1, &ctPatches },
+        { "bytes streamed",           true, -1, &ctBytesStreamed },
         { "mean frame time (usec)",    true, 1, &meanFrameTimeUsec },
         { "frames/sec",                true, 1, &frameRate },
         { "triangles/sec",             true, 1, &triangleRate },
@@ -123,6 +128,9 @@ void RenderStats::reset(void)
     ctLineStrips = 0;
     ctTrianglesInIrregularMeshes = 0;
     ctTrianglesInRegularMeshes = 0;
+    ctTrianglesInIndexedMeshes = 0;
     ctTriangleStrips = 0;
+    ctPatches = 0;
+    ctBytesStreamed = 0;
     startTime = clock_.read();
 }
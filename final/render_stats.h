@@ -27,14 +27,19 @@ public:
     int ctLineStrips;
     int ctTrianglesInIrregularMeshes;
     int ctTrianglesInRegularMeshes;
+    int ctTrianglesInIndexedMeshes;
     int ctTriangleStrips;
+    int ctPatches; // tessellated on the GPU
+    int ctBytesStreamed; // vertex data sent to the GPU this frame
 
 RenderStats()
     :
         startTime(0.0), meanFrameTime(0.0), resetFrameTimer(true),
         frameNumber(0), ctVertices(0), ctLines(0), ctLineStrips(0)
         , ctTrianglesInIrregularMeshes(0)
-        , ctTrianglesInRegularMeshes(0), ctTriangleStrips(0)
+        , ctTrianglesInRegularMeshes(0), ctTrianglesInIndexedMeshes(0)
+        , ctTriangleStrips(0), ctPatches(0)
+        , ctBytesStreamed(0)
         { };
 
     bool pendingFrameTimerReset(void) {
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 
 #include "camera.h"
@@ -7,6 +8,7 @@
 #include "controller.h"
 #include "curve.h"
 #include "death_star.h"
+#include "frame_context.h"
 #include "n_elem.h"
 #include "render_stats.h"
 #include "rocket.h"
@@ -69,27 +71,32 @@ void Scene::display(void)
 //
 {
     //
-    // The argument to the draw() methods is the
-    // "model-view-projection" transform (note the name change from
-    // "view" transform), which is initially just the view-projection
-    // transform. We'll pass this down the calling stack ultimately to
-    // the render() methods, concatenating individual model transforms
-    // to the modelview transform (by right-multiplying them) as we
-    // descend the scene graph, which we implement in our call graph.
+    // Everything about the camera that the display() methods need is
+    // computed once here, so that (for instance) the first person
+    // camera path is evaluated once per frame rather than once per
+    // draw. The second argument to the display() methods is the world
+    // transform, which is initially the identity. We'll pass both
+    // down the calling stack ultimately to the render() methods,
+    // concatenating individual model transforms to the world
+    // transform (by right-multiplying them) as we descend the scene
+    // graph, which we implement in our call graph.
     //
-    Transform viewProjectionTransform
-        = camera.projectionTransform() * camera.viewTransform();
+    ArenaScope arenaScope(arena);
+    FrameContext frameContext = camera.frameContext();
     renderStats.reset(); // for this frame
+    streamBuffer->beginFrame();
+    eadsShaderProgram->updateFrameBlock(frameContext);
     for (unsigned int i = 0; i < sceneObjects.size(); i++) {
         Transform identityTransform; // world transform, initially
 
-        sceneObjects[i]->display(viewProjectionTransform, identityTransform);
+        sceneObjects[i]->display(frameContext, identityTransform);
     }
     if (controller.axesEnabled) {
         Transform identityTransform;
 
-        coordinateAxes->display(viewProjectionTransform, identityTransform);
+        coordinateAxes->display(frameContext, identityTransform);
     }
+    streamBuffer->endFrame();
     if (controller.statsEnabled)
         renderStats.display();
     if (controller.viewHelpEnabled)
@@ -97,6 +104,29 @@ void Scene::display(void)
 }
 
 
+void Scene::reloadTrack(void)
+//
+// replaces the track with a new one built from the current layout
+// (re-reading its control vertices, if any), keeping the cars and
+// camera at the same parametric positions on it
+//
+{
+    Track *oldTrack = track;
+
+    track = new Track(layout, ground);
+    track->addTies();
+    replace(sceneObjects.begin(), sceneObjects.end(),
+            static_cast<SceneObject *>(oldTrack),
+            static_cast<SceneObject *>(track));
+    for (int i = 0; i < nCars; i++)
+        cars[i]->path = track->guideCurve;
+    camera.setPath(track->guideCurve);
+
+    // also frees all of the old track's geometry arrays
+    delete oldTrack;
+}
+
+
 void Scene::step(double dtReq)
 //
 // moves each of the cars and the camera (for use in first person
@@ -136,11 +166,20 @@ void Scene::step(double dtReq)
 }
 
 
-Scene::Scene(const Layout layout)
+Scene::Scene(const Layout layout_)
+    : arena(new Arena()), layout(layout_), track(NULL)
 {
+    ArenaScope arenaScope(arena);
+
     uniformColorShaderProgram = new UniformColorShaderProgram(
             "UniformColorShaderProgram");
     eadsShaderProgram = new EadsShaderProgram();
+    if (HedgehogShaderProgram::isSupported())
+        hedgehogShaderProgram = new HedgehogShaderProgram();
+    else
+        hedgehogShaderProgram = NULL;
+    bezierPatchShaderProgram = NULL; // (until a Teapot needs it)
+    streamBuffer = new StreamBuffer();
 
     coordinateAxes = new CoordinateAxes();
 
@@ -157,11 +196,11 @@ Scene::Scene(const Layout layout)
     addLight(new Light(.50 * whiteColor, Vector3(0, 1, 0)));
 
     // add the ground to the scene
-    Ground *g = new Ground((double) extent_);
-    // addSceneObject(g);
+    ground = new Ground((double) extent_);
+    // addSceneObject(ground);
 
     // add the track to the scene
-    Track *t = new Track(layout, g);
+    Track *t = new Track(layout, ground);
     if(track == NULL)
       track = t;
     addSceneObject(t);
@@ -185,3 +224,23 @@ Scene::Scene(const Layout layout)
 
     camera.setPath(t->guideCurve);
 }
+
+
+Scene::~Scene()
+{
+    for (unsigned int i = 0; i < sceneObjects.size(); i++)
+        delete sceneObjects[i]; // includes `track` and `cars[]`
+    delete [] cars;
+    delete ground;
+    for (unsigned int i = 0; i < lights.size(); i++)
+        delete lights[i];
+    delete coordinateAxes;
+    delete bezierPatchShaderProgram;
+    delete eadsShaderProgram;
+    delete hedgehogShaderProgram;
+    delete streamBuffer;
+    delete uniformColorShaderProgram;
+
+    // releases all of the remaining geometry arrays at once
+    delete arena;
+}
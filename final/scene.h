@@ -3,6 +3,7 @@
 #include <vector>
 using namespace std;
 
+#include "arena.h"
 #include "car.h"
 #include "coordinate_axes.h"
 #include "color.h"
@@ -12,6 +13,7 @@ using namespace std;
 #include "poly_line.h"
 #include "scene_object.h"
 #include "shader_programs.h"
+#include "stream_buffer.h"
 #include "track.h"
 
 //
@@ -31,10 +33,25 @@ class Scene {
     // vector of SceneObjects in the scene
     vector<SceneObject *> sceneObjects;
 
+    // geometry arrays of everything but the Track (which has its own
+    // Arena, so that it can be reloaded) are allocated from this
+    Arena *arena;
+    Layout layout;
+    Ground *ground;
+
 public:
     UniformColorShaderProgram *uniformColorShaderProgram;
+    // draws hedgehogs on the GPU (NULL if geometry shaders aren't
+    // supported, in which case Hedgehogs compute their quills)
+    HedgehogShaderProgram *hedgehogShaderProgram;
+    // per-frame vertex data for all Tessellations that stream it
+    StreamBuffer *streamBuffer;
     static const Color skyColor;
     EadsShaderProgram *eadsShaderProgram;
+    // evaluates Bezier patches on the GPU (NULL until a Teapot is
+    // drawn with it, or if tessellation shaders aren't supported, in
+    // which case they're tessellated on the CPU)
+    BezierPatchShaderProgram *bezierPatchShaderProgram;
 
     // `coordinateAxes` are a SceneObject, but we have to treat them
     // separately as their visibility can be turned on and off in the
@@ -45,11 +62,13 @@ public:
     static const int nCars = 6; // number of cars on the track
     Car **cars; // array of Car (pointers) to cars for later manipulation
 
-    Scene(const Layout layout);
+    Scene(const Layout layout_);
+    ~Scene();
     const double cameraSpeed(void) const;
     void addLight(Light *light);
     void addSceneObject(SceneObject *sceneObject);
     void display(void);
+    void reloadTrack(void);
     void step(double dT);
 };
 
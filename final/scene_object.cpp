@@ -3,46 +3,80 @@
 #include "hedgehog.h"
 #include "transform.h"
 
+SceneObject::~SceneObject()
+{
+    deleteHedgehogs();
+}
+
+
 #if PA >= PA04_HEDGHOG_CAR
 
 const void SceneObject::addHedgehogs(Mesh *mesh)
 //
-// creates face and vertex hedgehogs for the Tube and appends them to
-// the `faceHedgehog` and `vertexHedgehog` vectors.
+// arranges for face and vertex hedgehogs for `mesh` to be displayed
+// (and created the first time they are)
 //
 {
-    Hedgehog *faceHedgehog;
-    Hedgehog *vertexHedgehog;
-
     if (mesh) { // will be NULL in the template
-        mesh->createHedgehogs(faceHedgehog, vertexHedgehog);
-        faceHedgehogs.push_back(faceHedgehog);
-        vertexHedgehogs.push_back(vertexHedgehog);
+        hedgehogMeshes.push_back(mesh);
+        faceHedgehogs.push_back(NULL);
+        vertexHedgehogs.push_back(NULL);
     }
 }
 
 #endif // PA >= PA04_HEDGEHOG_CAR
 
+
+void SceneObject::deleteHedgehogs(void)
+//
+// deletes all of the SceneObject's hedgehogs
+//
+// Children whose hedgehogs live in an Arena they own must call this
+// before they delete the Arena.
+//
+{
+    for (unsigned int i = 0; i < faceHedgehogs.size(); i++)
+        delete faceHedgehogs[i];
+    faceHedgehogs.clear();
+    for (unsigned int i = 0; i < vertexHedgehogs.size(); i++)
+        delete vertexHedgehogs[i];
+    vertexHedgehogs.clear();
+    hedgehogMeshes.clear();
+}
+
 const void SceneObject::displayHedgehogs(
-    const Transform &viewProjectionTransform,
+    const FrameContext &frameContext,
+    Transform worldTransform,
+    const double quillLength)
+{
+    for (unsigned int i = 0; i < hedgehogMeshes.size(); i++)
+        displayHedgehog(hedgehogMeshes[i], faceHedgehogs[i],
+                        vertexHedgehogs[i], frameContext, worldTransform,
+                        quillLength);
+}
+
+
+const void SceneObject::displayHedgehog(
+    Mesh *mesh, Hedgehog *&faceHedgehog, Hedgehog *&vertexHedgehog,
+    const FrameContext &frameContext,
     Transform worldTransform,
-    const double quillLength) const
+    const double quillLength)
+//
+// draws `mesh`'s face or vertex hedgehog (as the controller says), if
+// hedgehogs are enabled, creating it (in `faceHedgehog` or
+// `vertexHedgehog`) if it's still NULL
+//
 {
     if (controller.normalHedgehogEnabled
             || controller.lightHedgehogIndex != LIGHT_HEDGEHOG_DISABLED) {
         if (controller.useVertexNormals) {
-            for (unsigned int i = 0; i < vertexHedgehogs.size(); i++) {
-                Hedgehog *hedgehog = vertexHedgehogs[i];
-                hedgehog->draw(viewProjectionTransform, worldTransform,
-                               quillLength);
-            }
+            if (!vertexHedgehog)
+                vertexHedgehog = mesh->createVertexHedgehog();
+            vertexHedgehog->draw(frameContext, worldTransform, quillLength);
         } else {
-            for (unsigned int i = 0; i < faceHedgehogs.size(); i++) {
-                Hedgehog *hedgehog = faceHedgehogs[i];
-                hedgehog->draw(viewProjectionTransform, worldTransform,
-                quillLength);
-            }
+            if (!faceHedgehog)
+                faceHedgehog = mesh->createFaceHedgehog();
+            faceHedgehog->draw(frameContext, worldTransform, quillLength);
         }
     }
 }
-
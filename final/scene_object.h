@@ -5,6 +5,7 @@
 // below).
 //
 
+#include "frame_context.h"
 #include "hedgehog.h"
 #include "mesh.h"
 #include "transform.h"
@@ -18,29 +19,41 @@ class SceneObject
 //
 {
 protected:
+    //
+    // Hedgehogs are only created when they're first displayed, so
+    // `faceHedgehogs[i]` and `vertexHedgehogs[i]` are NULL until
+    // `hedgehogMeshes[i]` needs them.
+    //
+    vector<Mesh *> hedgehogMeshes;
     vector<Hedgehog *> faceHedgehogs;
     vector<Hedgehog *> vertexHedgehogs;
 
+    void deleteHedgehogs(void);
+
 public:
     Transform modelTransform; // model coordinates to world coordinates
 
-    // At least one older g++ compiler complains if this is missing.
-    virtual ~SceneObject() { };
+    virtual ~SceneObject();
 
     //
     // Force all child classes to implement their own display()
     // methods.
     //
-    virtual void display(const Transform &viewProjectionTransform,
+    virtual void display(const FrameContext &frameContext,
                          Transform worldTransform)
         = 0;
 
 public:
     const void addHedgehogs(Mesh *mesh);
     const void displayHedgehogs(
-        const Transform &viewProjectionTransform,
+        const FrameContext &frameContext,
+        Transform worldTransform,
+        const double quillLength);
+    static const void displayHedgehog(
+        Mesh *mesh, Hedgehog *&faceHedgehog, Hedgehog *&vertexHedgehog,
+        const FrameContext &frameContext,
         Transform worldTransform,
-        const double quillLength) const;
+        const double quillLength);
 };
 
 #define INCLUDED_SCENE_OBJECT
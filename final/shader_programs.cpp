@@ -19,13 +19,13 @@ using namespace std;
 #include <unistd.h>
 #endif
 
-#include "camera.h"
 #include "check_gl.h"
 #include "controller.h"
 #include "n_elem.h"
 #include "light.h"
 #include "scene.h"
 #include "shader_programs.h"
+#include "view.h"
 #include "wrap_gl_inclusion.h"
 
 GLuint ShaderProgram::currentProgramId = 0; // never returned by glGetProgram()
@@ -143,6 +143,9 @@ char *readFile(string fname)
 ShaderProgram::ShaderProgram(string name_)
     : name(name_),
       fragmentShaderId(undefinedShaderId),
+      geometryShaderId(undefinedShaderId),
+      tessControlShaderId(undefinedShaderId),
+      tessEvaluationShaderId(undefinedShaderId),
       vertexShaderId(undefinedShaderId),
       programId(undefinedShaderId)
 //
@@ -153,6 +156,47 @@ ShaderProgram::ShaderProgram(string name_)
 }
 
 
+ShaderProgram::~ShaderProgram()
+//
+// frees the shader program (and its shaders) in the GPU
+//
+{
+    if (fragmentShaderId != undefinedShaderId)
+        glDeleteShader(fragmentShaderId);
+    if (geometryShaderId != undefinedShaderId)
+        glDeleteShader(geometryShaderId);
+    if (tessControlShaderId != undefinedShaderId)
+        glDeleteShader(tessControlShaderId);
+    if (tessEvaluationShaderId != undefinedShaderId)
+        glDeleteShader(tessEvaluationShaderId);
+    if (vertexShaderId != undefinedShaderId)
+        glDeleteShader(vertexShaderId);
+    if (currentProgramId == programId)
+        disableCurrent();
+    CHECK_GL(glDeleteProgram(programId));
+}
+
+
+void ShaderProgram::bindUniformBlock(const string blockName,
+                                     const GLuint bindingPoint) const
+//
+// connects the uniform block `blockName` declared in this program's
+// shaders to the UniformBlock(s) bound at `bindingPoint`
+//
+{
+    GLuint blockIndex;
+
+    CHECK_GL(blockIndex = glGetUniformBlockIndex(programId,
+                                                 blockName.c_str()));
+    if (blockIndex == GL_INVALID_INDEX) {
+        cerr << "unable to find uniform block \"" << blockName << "\"\n"
+             << "    in the shader named \"" << name  << "\"\n";
+        return;
+    }
+    CHECK_GL(glUniformBlockBinding(programId, blockIndex, bindingPoint));
+}
+
+
 void ShaderProgram::compileFragmentShader(string glslCode)
 //
 // compiles the fragment shader in `glslCode`
@@ -166,6 +210,20 @@ void ShaderProgram::compileFragmentShader(string glslCode)
 }
 
 
+void ShaderProgram::compileGeometryShader(string glslCode)
+//
+// compiles the geometry shader in `glslCode`
+//
+{
+    // If there's already a geometry shader in this shader program,
+    // delete it.
+    if (geometryShaderId != undefinedShaderId)
+        glDeleteShader(geometryShaderId);
+    geometryShaderId = compileShader("geometry", GL_GEOMETRY_SHADER,
+                                     glslCode);
+}
+
+
 const GLuint ShaderProgram::compileShader(const string typeName,
                                           GLenum shaderType,
                                           string glslSource)
@@ -226,6 +284,35 @@ const GLuint ShaderProgram::compileShader(const string typeName,
 }
 
 
+void ShaderProgram::compileTessControlShader(string glslCode)
+//
+// compiles the tessellation control shader in `glslCode`
+//
+{
+    // If there's already a tessellation control shader in this shader
+    // program, delete it.
+    if (tessControlShaderId != undefinedShaderId)
+        glDeleteShader(tessControlShaderId);
+    tessControlShaderId = compileShader("tessellation control",
+                                        GL_TESS_CONTROL_SHADER, glslCode);
+}
+
+
+void ShaderProgram::compileTessEvaluationShader(string glslCode)
+//
+// compiles the tessellation evaluation shader in `glslCode`
+//
+{
+    // If there's already a tessellation evaluation shader in this
+    // shader program, delete it.
+    if (tessEvaluationShaderId != undefinedShaderId)
+        glDeleteShader(tessEvaluationShaderId);
+    tessEvaluationShaderId = compileShader("tessellation evaluation",
+                                           GL_TESS_EVALUATION_SHADER,
+                                           glslCode);
+}
+
+
 void ShaderProgram::compileVertexShader(string glslCode)
 //
 // compiles the vertex shader in `glslCode`
@@ -286,6 +373,26 @@ const void ShaderProgram::dumpStatus(void) const
 
 
 
+const bool ShaderProgram::glVersionIsAtLeast(const int major,
+                                             const int minor)
+//
+// returns true iff the OpenGL implementation's version is at least
+// `major`.`minor`
+//
+{
+    int actualMajor, actualMinor;
+    const char *version;
+
+    CHECK_GL(version = reinterpret_cast<const char *>(
+                 glGetString(GL_VERSION)));
+    if (version == NULL
+            || sscanf(version, "%d.%d", &actualMajor, &actualMinor) != 2)
+        return false;
+    return actualMajor > major
+        || (actualMajor == major && actualMinor >= minor);
+}
+
+
 const GLint ShaderProgram::getCurrentAttributeIndex(const string name)
 //
 // gets the attribute index of the attribute referred to as `name` in
@@ -369,6 +476,21 @@ const void ShaderProgram::setUniform(const string name, int val) const
 }
 
 
+const void ShaderProgram::setUniform(const string name, const Point2 &p)
+    const
+//
+// set a uniform Point2 (GLSL vec2) value
+//
+{
+    GLint location;
+
+    if (getUniformLocation(name, location))
+        CHECK_GL(glUniform2f(location,
+                             static_cast<GLfloat>(p.u.g.x),
+                             static_cast<GLfloat>(p.u.g.y)));
+}
+
+
 const void ShaderProgram::setUniform(const string name, const Vec3 &v)
     const
 //
@@ -470,13 +592,93 @@ const void UniformColorShaderProgram::start(void) const
 }
 
 
+HedgehogShaderProgram::HedgehogShaderProgram(void)
+    : ShaderProgram("HedgehogShaderProgram"),
+      quillLength(0.0),
+      normalDotThreshold(0.0),
+      showNormals(true)
+//
+// reads the GLSL source for the vertex, geometry, and fragment
+// shaders and compiles them
+//
+{
+    char *fileContents;
+
+    fileContents = readFile("hedgehog_vertex_shader.glsl");
+    compileVertexShader(fileContents);
+    free(fileContents);
+
+    fileContents = readFile("hedgehog_geometry_shader.glsl");
+    compileGeometryShader(fileContents);
+    free(fileContents);
+
+    fileContents = readFile("passthru_fragment_shader.glsl");
+    compileFragmentShader(fileContents);
+    free(fileContents);
+}
+
+
+const bool HedgehogShaderProgram::isSupported(void)
+//
+// returns true iff the OpenGL implementation has geometry shaders
+// (i.e. is version 3.2 or later)
+//
+{
+    return glVersionIsAtLeast(3, 2);
+}
+
+
+const void HedgehogShaderProgram::start(void) const
+//
+// enables the shader program
+//
+{
+    select();
+
+    setUniform("color", color);
+    setUniform("modelViewProjectionMatrix", modelViewProjectionMatrix, 4);
+    setUniform("quillNormalMatrix", quillNormalMatrix, 3);
+    setUniform("quillLength", quillLength);
+    setUniform("showNormals", showNormals ? 1 : 0);
+    if (!showNormals) {
+        setUniform("lightQuillVector", lightQuillVector);
+        setUniform("normalDotThreshold", normalDotThreshold);
+    }
+}
+
+
+//
+// std140 byte offsets of the members of "FrameBlock" and
+// "ObjectBlock" (see "eads_vertex_shader.glsl"). "MaterialBlock" is
+// handled by the Material class.
+//
+enum {
+    VIEW_PROJECTION_MATRIX_OFFSET      =   0, // mat4
+    CAMERA_POSITION_OFFSET             =  64, // vec3
+    USE_ORTHOGRAPHIC_OFFSET            =  76, // int
+    ORTHOGRAPHIC_TOWARDS_OFFSET        =  80, // vec3
+    N_LIGHTS_OFFSET                    =  92, // int
+    AMBIENT_REFLECTION_ENABLED_OFFSET  =  96, // int
+    DIFFUSE_REFLECTION_ENABLED_OFFSET  = 100, // int
+    SPECULAR_REFLECTION_ENABLED_OFFSET = 104, // int
+    LIGHTS_OFFSET                      = 112, // Light[MAX_LIGHTS]
+    LIGHT_IRRADIANCE_OFFSET            =   0, // vec3 (in Light)
+    LIGHT_TOWARDS_OFFSET               =  16, // vec3 (in Light)
+    LIGHT_STRIDE                       =  32, // std140 struct array stride
+    MAX_LIGHTS                         =  10,
+    FRAME_BLOCK_SIZE = LIGHTS_OFFSET + MAX_LIGHTS * LIGHT_STRIDE
+};
+
+enum {
+    WORLD_MATRIX_OFFSET                =   0, // mat4
+    NORMAL_MATRIX_OFFSET               =  64, // mat3 (3 vec4 columns)
+    OBJECT_BLOCK_SIZE                  = 112
+};
+
+
 EadsShaderProgram::EadsShaderProgram(void)
     : ShaderProgram("EadsShaderProgram"),
-      emittance(Color(0,0,0)),
-      ambientReflectivity(Rgb(0,0,0)),
-      maximumDiffuseReflectivity(Rgb(0,0,0)),
-      maximumSpecularReflectivity(Rgb(0,0,0)),
-      specularExponent(1.0) // avoids ambiguity caused if == 0.0
+      material(NULL)
 {
     //
     // Copy your previous (PA05) solution here.
@@ -490,6 +692,42 @@ EadsShaderProgram::EadsShaderProgram(void)
     fileContents = readFile("passthru_fragment_shader.glsl");
     compileFragmentShader(fileContents);
     free(fileContents);
+
+    createUniformBlocks();
+}
+
+
+EadsShaderProgram::EadsShaderProgram(const string name)
+    : ShaderProgram(name),
+      material(NULL)
+//
+// for derived classes, which compile their own shaders (which must
+// declare the same uniform blocks) and then call createUniformBlocks()
+//
+{
+}
+
+
+EadsShaderProgram::~EadsShaderProgram()
+{
+    delete frameBlock;
+    delete objectBlock;
+}
+
+
+void EadsShaderProgram::createUniformBlocks(void)
+//
+// helper: binds the program's uniform blocks and creates the
+// UniformBlocks that feed the per-frame and per-object ones (Materials
+// have their own)
+//
+{
+    bindUniformBlock("FrameBlock", FRAME_BLOCK_BINDING);
+    bindUniformBlock("MaterialBlock", MATERIAL_BLOCK_BINDING);
+    bindUniformBlock("ObjectBlock", OBJECT_BLOCK_BINDING);
+
+    frameBlock = new UniformBlock(FRAME_BLOCK_BINDING, FRAME_BLOCK_SIZE);
+    objectBlock = new UniformBlock(OBJECT_BLOCK_BINDING, OBJECT_BLOCK_SIZE);
 }
 
 
@@ -497,62 +735,120 @@ const void EadsShaderProgram::start(void) const
 {
     select();
 
-    // set camera properties
-    setUniform("useOrthographic", controller.useOrthographic);
-    if (controller.useOrthographic) {
-        setUniform("orthographicTowards", camera.orthographic.towards);
-    } else {
-        setUniform("cameraPosition",
-                   (*camera.firstPerson.path)(camera.firstPerson.u));
-    }
-
     // set transform matrices
-    setUniform("modelViewProjectionMatrix", modelViewProjectionMatrix, 4);
-    setUniform("worldMatrix", worldMatrix, 4);
-    setUniform("normalMatrix", normalMatrix, 3);
+    objectBlock->set(WORLD_MATRIX_OFFSET, worldMatrix, 4);
+    objectBlock->set(NORMAL_MATRIX_OFFSET, normalMatrix, 3);
+    objectBlock->update();
+    objectBlock->bind();
+
+    // set camera and light properties (already sent once this frame)
+    frameBlock->bind();
 
     // set material properties
-    if (controller.ambientReflectionEnabled)
-        setUniform("ambientReflectivity", ambientReflectivity);
-    else
-        setUniform("ambientReflectivity", blackRgb);
-    if (controller.diffuseReflectionEnabled)
-        setUniform("maximumDiffuseReflectivity", maximumDiffuseReflectivity);
+    assert(material != NULL); // call setMaterial() before start()
+    material->bind();
+}
+
+
+void EadsShaderProgram::updateFrameBlock(const FrameContext &frameContext)
+//
+// sends the per-frame (i.e. camera, light, and GUI) uniforms to the
+// GPU, which need only be done once per frame
+//
+{
+    frameBlock->set(VIEW_PROJECTION_MATRIX_OFFSET,
+                    frameContext.viewProjectionTransform, 4);
+
+    // set camera properties
+    frameBlock->set(USE_ORTHOGRAPHIC_OFFSET, frameContext.useOrthographic);
+    if (frameContext.useOrthographic)
+        frameBlock->set(ORTHOGRAPHIC_TOWARDS_OFFSET,
+                        frameContext.orthographicTowards);
     else
-        setUniform("maximumDiffuseReflectivity", blackRgb);
-    setUniform("emittance", emittance);
-    if (controller.specularReflectionEnabled) {
-        setUniform("maximumSpecularReflectivity", maximumSpecularReflectivity);
-        setUniform("specularExponent", specularExponent);
-    } else {
-        setUniform("maximumSpecularReflectivity", blackRgb);
-        setUniform("specularExponent", 1.0); // avoid pow(0.0, 0.0) ambiguity
-    }
+        frameBlock->set(CAMERA_POSITION_OFFSET, frameContext.eye);
+
+    // set the switches that enable material properties
+    frameBlock->set(AMBIENT_REFLECTION_ENABLED_OFFSET,
+                    controller.ambientReflectionEnabled);
+    frameBlock->set(DIFFUSE_REFLECTION_ENABLED_OFFSET,
+                    controller.diffuseReflectionEnabled);
+    frameBlock->set(SPECULAR_REFLECTION_ENABLED_OFFSET,
+                    controller.specularReflectionEnabled);
 
     // set light properties
+    int nLights = scene->lights.size();
+    assert(nLights <= MAX_LIGHTS);
+    frameBlock->set(N_LIGHTS_OFFSET, nLights);
+    for (int i = 0; i < nLights; i++) {
+        int lightOffset = LIGHTS_OFFSET + i * LIGHT_STRIDE;
+
+        // set the components of each light
+        if (controller.lightHedgehogIndex == LIGHT_HEDGEHOG_DISABLED
+                || i == controller.lightHedgehogIndex)
+            frameBlock->set(lightOffset + LIGHT_IRRADIANCE_OFFSET,
+                            scene->lights[i]->irradiance);
+        else
+            frameBlock->set(lightOffset + LIGHT_IRRADIANCE_OFFSET,
+                            blackColor);
+        frameBlock->set(lightOffset + LIGHT_TOWARDS_OFFSET,
+                        scene->lights[i]->towards());
+    }
+    frameBlock->update();
+}
+
+
+BezierPatchShaderProgram::BezierPatchShaderProgram(void)
+    : EadsShaderProgram("BezierPatchShaderProgram"),
+      maxScreenError(0.5)
+//
+// reads the GLSL source for the vertex, tessellation, and fragment
+// shaders and compiles them
+//
+{
+    char *fileContents;
+
+    fileContents = readFile("bezier_patch_vertex_shader.glsl");
+    compileVertexShader(fileContents);
+    free(fileContents);
 
     //
-    // Copy your previous (PA06) solution here.
+    // (The evaluation shader goes first, since a program may link
+    // without a control shader, but not without an evaluation shader.)
     //
-    int nLights = scene->lights.size();
-    assert(nLights <= 10);
+    fileContents = readFile("bezier_patch_tess_evaluation_shader.glsl");
+    compileTessEvaluationShader(fileContents);
+    free(fileContents);
+
+    fileContents = readFile("bezier_patch_tess_control_shader.glsl");
+    compileTessControlShader(fileContents);
+    free(fileContents);
 
-    // set nLights
-    setUniform("nLights", nLights);
-    string indices[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+    fileContents = readFile("passthru_fragment_shader.glsl");
+    compileFragmentShader(fileContents);
+    free(fileContents);
 
-    for(int i = 0; i < nLights; i++){
-      // create variable names for setting values
-      string irradianceVar = "light[" + indices[i] + "].irradiance";
-      string towardsVar = "light[" + indices[i] + "].towards";
+    createUniformBlocks();
+}
 
-      // set the components of each light
-      if(controller.lightHedgehogIndex == LIGHT_HEDGEHOG_DISABLED ||
-          i == controller.lightHedgehogIndex)
-        setUniform(irradianceVar, scene->lights[i]->irradiance);
-      else
-        setUniform(irradianceVar, blackColor);
 
-      setUniform(towardsVar, scene->lights[i]->towards());
-    }
+const bool BezierPatchShaderProgram::isSupported(void)
+//
+// returns true iff the OpenGL implementation has tessellation shaders
+// (i.e. is version 4.0 or later)
+//
+{
+    return glVersionIsAtLeast(4, 0);
+}
+
+
+const void BezierPatchShaderProgram::start(void) const
+//
+// enables the shader program
+//
+{
+    EadsShaderProgram::start();
+
+    setUniform("modelViewProjectionMatrix", modelViewProjectionMatrix, 4);
+    setUniform("viewportSize", view.canvasSize());
+    setUniform("maxScreenError", maxScreenError);
 }
@@ -10,7 +10,11 @@ using namespace std;
 #include "wrap_gl_inclusion.h"
 
 #include "color.h"
+#include "frame_context.h"
+#include "geometry.h"
+#include "material.h"
 #include "transform.h"
+#include "uniform_block.h"
 
 // This macro helps avoid compiler warnings when calling
 // glVertexPointer().
@@ -36,6 +40,9 @@ private:
     static GLuint currentProgramId;
 
     GLuint fragmentShaderId;
+    GLuint geometryShaderId;
+    GLuint tessControlShaderId;
+    GLuint tessEvaluationShaderId;
     GLuint vertexShaderId;
 
     const bool getUniformLocation(const string name, GLint &location)
@@ -46,25 +53,33 @@ public:
 
     const void dumpStatus(void) const;
     static const GLint getCurrentAttributeIndex(const string name);
+    static const bool glVersionIsAtLeast(const int major, const int minor);
 
 protected:
     Matrix4 modelViewProjectionMatrix;
 
     const void select(void) const;
 
+    void bindUniformBlock(const string blockName, const GLuint bindingPoint)
+        const;
     const GLuint compileShader(const string typeName,
                                GLenum shaderType, string glslSource);
     const void setUniform(const string name, const Matrix4 &matrix, int wh)
         const;
     const void setUniform(const string name, double val) const;
     const void setUniform(const string name, int val) const;
+    const void setUniform(const string name, const Point2 &p) const;
     const void setUniform(const string name, const Vec3 &v) const;
     const void setUniform(const string name, const Mat4 &m) const;
 
 public:
     ShaderProgram(const string name);
+    virtual ~ShaderProgram();
 
     void compileFragmentShader(string glslSource);
+    void compileGeometryShader(string glslSource);
+    void compileTessControlShader(string glslSource);
+    void compileTessEvaluationShader(string glslSource);
     void compileVertexShader(string glslSource);
 
     static const void disableCurrent(void);
@@ -96,47 +111,92 @@ public:
 };
 
 
-class EadsShaderProgram : public ShaderProgram
+class HedgehogShaderProgram : public ShaderProgram
 //
-// ShaderProgram that computes emissive-ambient-diffuse-specular
-// (classic OpenGL) lighting
+// ShaderProgram that draws a Hedgehog's quills entirely on the GPU:
+// its geometry shader turns each (position, normal) point into a
+// quill
+//
+// Geometry shaders need OpenGL 3.2. Check isSupported() before
+// instancing one.
 //
 {
-    Matrix4 normalMatrix;
-    Matrix4 worldMatrix;
-
-    Color emittance;
-    Rgb ambientReflectivity;
-    Rgb maximumDiffuseReflectivity;
-    Rgb maximumSpecularReflectivity;
-    double specularExponent;
+    Color color;
+    Matrix4 quillNormalMatrix;
+    Vector3 lightQuillVector;
+    double quillLength;
+    double normalDotThreshold;
+    bool showNormals;
 
 public:
+    HedgehogShaderProgram(void);
 
-    EadsShaderProgram(void);
-
+    static const bool isSupported(void);
     const void start(void) const;
 
-    void setAmbient(const Rgb &ambientReflectivity_)
+    void setColor(const Color &color_)
+    {
+        color = color_;
+    }
+
+    void setLightQuills(const Vector3 &lightQuillVector_,
+                        const double normalDotThreshold_)
     {
-        ambientReflectivity = ambientReflectivity_;
+        lightQuillVector = lightQuillVector_;
+        normalDotThreshold = normalDotThreshold_;
+        showNormals = false;
     }
 
-    void setEmittance(const Color &emittance_)
+    void setNormalQuills(void)
     {
-        emittance = emittance_;
+        showNormals = true;
     }
 
-    void setDiffuse(const Rgb &maximumDiffuseReflectivity_)
+    void setQuillLength(const double quillLength_)
     {
-        maximumDiffuseReflectivity = maximumDiffuseReflectivity_;
+        quillLength = quillLength_;
     }
 
-    void setSpecular(const Rgb &maximumSpecularReflectivity_,
-                     double specularExponent_)
+    void setQuillNormalMatrix(const Matrix4 &quillNormalMatrix_)
     {
-        maximumSpecularReflectivity = maximumSpecularReflectivity_;
-        specularExponent = specularExponent_;
+        quillNormalMatrix = quillNormalMatrix_;
+    }
+};
+
+
+class EadsShaderProgram : public ShaderProgram
+//
+// ShaderProgram that computes emissive-ambient-diffuse-specular
+// (classic OpenGL) lighting
+//
+// Its uniforms are kept in three UniformBlocks: one for per-frame
+// data (updated once per frame by updateFrameBlock()), one for each
+// Material (see setMaterial()), and one for the per-object matrices
+// (updated by start()).
+//
+{
+    Matrix4 normalMatrix;
+    Matrix4 worldMatrix;
+
+    Material *material;
+    UniformBlock *frameBlock;
+    UniformBlock *objectBlock;
+
+protected:
+    EadsShaderProgram(const string name);
+    void createUniformBlocks(void);
+
+public:
+
+    EadsShaderProgram(void);
+    virtual ~EadsShaderProgram();
+
+    const void start(void) const;
+    void updateFrameBlock(const FrameContext &frameContext);
+
+    void setMaterial(Material *material_)
+    {
+        material = material_;
     }
 
     void setNormalMatrix(const Matrix4 &normalMatrix_)
@@ -151,6 +211,38 @@ public:
 };
 
 
+class BezierPatchShaderProgram : public EadsShaderProgram
+//
+// EadsShaderProgram that evaluates and lights bicubic Bezier patches
+// in its tessellation shaders, given only their control vertices (see
+// the "patch_tessellation" module)
+//
+// The tessellation levels are chosen per patch so that the surface is
+// within `maxScreenError` pixels of its tessellation on the screen.
+// Like every EadsShaderProgram, it needs its updateFrameBlock() called
+// once per frame. Before start(), also set the model-view-projection
+// matrix, which the tessellation control shader uses to project the
+// control vertices.
+//
+// Tessellation shaders need OpenGL 4.0. Check isSupported() before
+// instancing one.
+//
+{
+    double maxScreenError;
+
+public:
+    BezierPatchShaderProgram(void);
+
+    static const bool isSupported(void);
+    const void start(void) const;
+
+    void setMaxScreenError(const double maxScreenError_)
+    {
+        maxScreenError = maxScreenError_;
+    }
+};
+
+
 #define INCLUDED_SHADER_PROGRAMS
 #endif // INCLUDED_SHADER_PROGRAMS
 
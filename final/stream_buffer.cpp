@@ -0,0 +1,125 @@
+#include <cassert>
+#include <cstring>
+
+#include "check_gl.h"
+#include "render_stats.h"
+#include "stream_buffer.h"
+#include "wrap_gl_inclusion.h"
+
+// how long (in nanoseconds) to wait on a fence before checking again
+static const GLuint64 FENCE_TIMEOUT = 1000000000; // 1 s
+
+
+StreamBuffer::StreamBuffer(const size_t regionSize_)
+    : regionSize(regionSize_), iRegion(0), nBytesUsed(0)
+//
+// allocates the ring of N_STREAM_REGIONS `regionSize_`-byte regions
+// in the GPU
+//
+{
+    for (int i = 0; i < N_STREAM_REGIONS; i++)
+        fences[i] = NULL;
+    CHECK_GL(glGenBuffers(1, &bufferId));
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, bufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER, N_STREAM_REGIONS * regionSize,
+                          NULL, GL_STREAM_DRAW));
+}
+
+
+StreamBuffer::~StreamBuffer()
+{
+    for (int i = 0; i < N_STREAM_REGIONS; i++) {
+        if (fences[i])
+            CHECK_GL(glDeleteSync(fences[i]));
+    }
+    CHECK_GL(glDeleteBuffers(1, &bufferId));
+}
+
+
+void StreamBuffer::beginFrame(void)
+//
+// moves on to the next region, first waiting (if necessary) for the
+// GPU to finish with the frame that last used it
+//
+{
+    iRegion = (iRegion + 1) % N_STREAM_REGIONS;
+    nBytesUsed = 0;
+    if (fences[iRegion]) {
+        GLenum status;
+
+        do {
+            CHECK_GL(status = glClientWaitSync(fences[iRegion],
+                                               GL_SYNC_FLUSH_COMMANDS_BIT,
+                                               FENCE_TIMEOUT));
+        } while (status == GL_TIMEOUT_EXPIRED);
+        CHECK_GL(glDeleteSync(fences[iRegion]));
+        fences[iRegion] = NULL;
+    }
+}
+
+
+void StreamBuffer::endFrame(void)
+//
+// marks the point in the command stream after which the current
+// region may be reused
+//
+{
+    if (fences[iRegion])
+        CHECK_GL(glDeleteSync(fences[iRegion]));
+    CHECK_GL(fences[iRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+}
+
+
+void StreamBuffer::grow(const size_t nBytesNeeded)
+//
+// helper: orphans the buffer's storage (which the GPU keeps until
+// it's done with it) and replaces it with regions large enough for
+// `nBytesNeeded` more bytes this frame
+//
+{
+    while (regionSize < nBytesUsed + nBytesNeeded)
+        regionSize *= 2;
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, bufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER, N_STREAM_REGIONS * regionSize,
+                          NULL, GL_STREAM_DRAW));
+
+    // None of the new storage is in use.
+    for (int i = 0; i < N_STREAM_REGIONS; i++) {
+        if (fences[i]) {
+            CHECK_GL(glDeleteSync(fences[i]));
+            fences[i] = NULL;
+        }
+    }
+    nBytesUsed = 0;
+}
+
+
+const size_t StreamBuffer::upload(const void *data, const size_t nBytes)
+//
+// copies `nBytes` of `data` into the current frame's region, returning
+// its (byte) offset in the buffer
+//
+{
+    size_t offset = (nBytesUsed + STREAM_ALIGNMENT - 1)
+        & ~static_cast<size_t>(STREAM_ALIGNMENT - 1);
+
+    if (offset + nBytes > regionSize) {
+        grow(nBytes);
+        offset = 0;
+    }
+    offset += iRegion * regionSize;
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, bufferId));
+    void *dst;
+    CHECK_GL(dst = glMapBufferRange(GL_ARRAY_BUFFER, offset, nBytes,
+                                    GL_MAP_WRITE_BIT
+                                    | GL_MAP_INVALIDATE_RANGE_BIT
+                                    | GL_MAP_UNSYNCHRONIZED_BIT));
+    assert(dst != NULL);
+    memcpy(dst, data, nBytes);
+    CHECK_GL(glUnmapBuffer(GL_ARRAY_BUFFER));
+
+    nBytesUsed = offset - iRegion * regionSize + nBytes;
+    renderStats.ctBytesStreamed += nBytes;
+    return offset;
+}
@@ -0,0 +1,57 @@
+#ifndef INCLUDED_STREAM_BUFFER
+
+//
+// The "stream_buffer" module provides the StreamBuffer class (see
+// below).
+//
+
+#include <cstddef>
+
+#include "wrap_gl_inclusion.h"
+
+enum {
+    N_STREAM_REGIONS = 3, // frames that may be in flight at once
+    STREAM_ALIGNMENT = 16 // (bytes) of every upload
+};
+
+// initial size of each region (it grows as needed)
+const size_t DEFAULT_STREAM_REGION_SIZE = 1 << 20; // 1 MiB
+
+
+class StreamBuffer
+//
+// a ring of vertex data that changes every frame
+//
+// The buffer is split into N_STREAM_REGIONS regions, one per frame.
+// During a frame, upload() appends data to that frame's region
+// (without synchronizing with the GPU) and returns where it put it.
+// When a frame ends, a fence is put in the command stream, and before
+// the region is reused N_STREAM_REGIONS frames later, beginFrame()
+// waits on it, so the GPU is never reading what we're writing.
+//
+// If a frame's uploads don't fit in its region, the buffer is
+// orphaned and reallocated with larger regions.
+//
+// Data must be re-uploaded in every frame it's drawn.
+//
+{
+    size_t regionSize;
+    int iRegion; // region for the current frame
+    size_t nBytesUsed; // in the current region
+    GLsync fences[N_STREAM_REGIONS]; // NULL: nothing pending
+
+    void grow(const size_t nBytesNeeded);
+
+public:
+    GLuint bufferId;
+
+    StreamBuffer(const size_t regionSize_ = DEFAULT_STREAM_REGION_SIZE);
+    ~StreamBuffer();
+
+    void beginFrame(void);
+    void endFrame(void);
+    const size_t upload(const void *data, const size_t nBytes);
+};
+
+#define INCLUDED_STREAM_BUFFER
+#endif // INCLUDED_STREAM_BUFFER
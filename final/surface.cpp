@@ -1,11 +1,29 @@
+#include <algorithm>
 #include <assert.h>
 
+#include "arena.h"
 #include "geometry.h"
+#include "grid_welder.h"
 #include "mesh.h"
+#include "n_elem.h"
 #include "scene_object.h"
 #include "surface.h"
 
 
+//
+// drawAdaptively() starts from a grid of quadtree roots about this many
+// of the Surface's (nominal, i.e. nI x nJ) quads on a side
+//
+static const int NOMINAL_QUADS_PER_ROOT = 4;
+
+
+Surface::~Surface()
+{
+    delete tessellationMesh;
+    delete adaptiveTessellation;
+}
+
+
 void Surface::draw(SceneObject *sceneObject)
 {
     if (!tessellationMesh) {
@@ -16,22 +34,26 @@ void Surface::draw(SceneObject *sceneObject)
     tessellationMesh->render();
 }
 
-void Surface::tessellate(void)
+void Surface::evaluate(const int nI_, const int nJ_,
+                       Point3f *vertexPositions,
+                       Vector3f *vertexNormals) const
+//
+// helper: fills the nI_ x nJ_ `vertexPositions` and `vertexNormals`
+// (row-major in j) with the points and normals of the surface at
+// evenly-spaced (u, v)s
+//
 {
     //
     // Copy your previous (PA07) solution here.
     //
-    Point3 *vertexPositions = new Point3[nJ * nI];
-    Vector3 *vertexNormals = new Vector3[nJ * nI];
-
     double v = 0.0;
 
     // slower incrementer
-    for(int j = 0; j < nJ; j++){
+    for(int j = 0; j < nJ_; j++){
       double u = 0.0;
 
       // most rapidly-varying incrementer
-      for(int i = 0; i < nI; i++){
+      for(int i = 0; i < nI_; i++){
         Vector3 tangentU, tangentV;
 
         // get point
@@ -40,21 +62,149 @@ void Surface::tessellate(void)
         // get n from tU and tV
         Vector3 n = (tangentV.cross(tangentU)).normalized();
 
-        // set them in the arrays
-        vertexPositions[j * nI + i] = p;
-        vertexNormals[j * nI + i] = n;
+        // set them in the (single precision) arrays
+        vertexPositions[j * nI_ + i] = Point3f(p);
+        vertexNormals[j * nI_ + i] = Vector3f(n);
 
         // increment u
-        u += 1.0 / (nI + wrapI - 1);
+        u += 1.0 / (nI_ + wrapI - 1);
       }
       // increment v
-      v += 1.0 / (nJ + wrapJ - 1);
+      v += 1.0 / (nJ_ + wrapJ - 1);
     }
+}
+
+
+void Surface::drawAdaptively(const FrameContext &frameContext,
+                             const Transform &worldTransform)
+//
+// draws the Surface with only as many triangles as its view (with
+// `worldTransform` as its world transform) requires (see
+// AdaptiveTessellation), rather than its nominal nI x nJ vertices
+//
+{
+    if (!adaptiveTessellation) {
+        int nRootsI = (nI + wrapI - 1 + NOMINAL_QUADS_PER_ROOT - 1)
+            / NOMINAL_QUADS_PER_ROOT;
+        int nRootsJ = (nJ + wrapJ - 1 + NOMINAL_QUADS_PER_ROOT - 1)
+            / NOMINAL_QUADS_PER_ROOT;
+
+        adaptiveTessellation = new AdaptiveTessellation(
+            this, max(nRootsI, 1), max(nRootsJ, 1), wrapI, wrapJ);
+    }
+    adaptiveTessellation->update(frameContext, worldTransform);
+    adaptiveTessellation->render();
+}
+
+
+void Surface::tessellate(void)
+{
+    tessellationMesh = tessellation(nI, nJ);
+}
+
+
+RegularMesh *Surface::tessellation(const int nI_, const int nJ_) const
+//
+// helper: returns a new tessellation of the Surface with nI_ x nJ_
+// vertices (rather than its nominal nI x nJ)
+//
+{
+    Point3f *vertexPositions = newArray<Point3f>(nJ_ * nI_);
+    Vector3f *vertexNormals = newArray<Vector3f>(nJ_ * nI_);
+
+    evaluate(nI_, nJ_, vertexPositions, vertexNormals);
 
     // mesh up
-    tessellationMesh = new RegularMesh(vertexPositions, vertexNormals, nI, nJ, wrapI, wrapJ);
+    // (The mesh takes over the arrays, so there's no need to copy them.)
+    return new RegularMesh(vertexPositions, vertexNormals,
+                           nI_, nJ_, wrapI, wrapJ, ADOPT_ARRAYS);
+}
+
+
+const double Surface::tessellationError(const int nI_, const int nJ_) const
+//
+// helper: returns the (approximate) largest distance between the
+// Surface and its tessellation with nI_ x nJ_ vertices, as measured at
+// the centers and edge midpoints of the tessellation's quads
+//
+{
+    Point3f *positions = new Point3f[nJ_ * nI_];
+    Vector3f *normals = new Vector3f[nJ_ * nI_];
+    const double dU = 1.0 / (nI_ + wrapI - 1);
+    const double dV = 1.0 / (nJ_ + wrapJ - 1);
+    double result = 0.0;
+
+    evaluate(nI_, nJ_, positions, normals);
+    for (int j = 0; j < nJ_ + wrapJ - 1; j++) {
+        const int jUpper = (j + 1) % nJ_;
+
+        for (int i = 0; i < nI_ + wrapI - 1; i++) {
+            const int iRight = (i + 1) % nI_;
+            const Point3 p00(positions[j * nI_ + i]);
+            const Point3 p10(positions[j * nI_ + iRight]);
+            const Point3 p01(positions[jUpper * nI_ + i]);
+            const Point3 p11(positions[jUpper * nI_ + iRight]);
+            const struct {
+                double u, v;
+                Point3 approximation;
+            } samples[] = {
+                { (i + 0.5) * dU, j * dV,         p00 + 0.5 * (p10 - p00) },
+                { i * dU,         (j + 0.5) * dV, p00 + 0.5 * (p01 - p00) },
+                { (i + 0.5) * dU, (j + 0.5) * dV,
+                  p00 + 0.25 * ((p10 - p00) + (p01 - p00) + (p11 - p00)) },
+            };
+
+            for (unsigned int k = 0; k < N_ELEM(samples); k++) {
+                Vector3 tangentU, tangentV;
+                Point3 p = (*this)(samples[k].u, samples[k].v,
+                                   tangentU, tangentV);
+                double error = (p - samples[k].approximation).mag();
+
+                if (error > result)
+                    result = error;
+            }
+        }
+    }
+    delete [] positions;
+    delete [] normals;
+    return result;
+}
+
+
+IndexedMesh *Surface::tessellateWelded(const vector<Surface *> &surfaces)
+//
+// returns a single IndexedMesh of all the `surfaces`' tessellations
+// in which vertices that coincide along the seams between them are
+// shared (with their normals averaged), so the whole collection can
+// be drawn at once
+//
+{
+    int nVerticesMax = 0;
+    for (unsigned int iSurface = 0; iSurface < surfaces.size(); iSurface++)
+        nVerticesMax += surfaces[iSurface]->nI * surfaces[iSurface]->nJ;
+
+    GridWelder welder(WELD_TOLERANCE, nVerticesMax);
+    for (unsigned int iSurface = 0; iSurface < surfaces.size(); iSurface++) {
+        const Surface *surface = surfaces[iSurface];
+        const int nI = surface->nI;
+        const int nJ = surface->nJ;
+        Point3f *positions = new Point3f[nI * nJ];
+        Vector3f *normals = new Vector3f[nI * nJ];
+
+        surface->evaluate(nI, nJ, positions, normals);
+        welder.add(positions, normals, nI, nJ, surface->wrapI,
+                   surface->wrapJ);
+        delete [] positions;
+        delete [] normals;
+    }
+
+    const int nVertices = welder.nVertices();
+    const int nFaces = welder.nFaces();
+    Point3f *vertexPositions = newArray<Point3f>(nVertices);
+    Vector3f *vertexNormals = newArray<Vector3f>(nVertices);
+    unsigned int *vertexIndices = newArray<unsigned int>(3 * nFaces);
+    welder.getMesh(vertexPositions, vertexNormals, vertexIndices);
 
-    // delete em
-    delete[] vertexPositions;
-    delete[] vertexNormals;
+    return new IndexedMesh(vertexPositions, vertexNormals, nVertices,
+                           vertexIndices, nFaces, ADOPT_ARRAYS);
 }
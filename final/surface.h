@@ -4,13 +4,23 @@
 // The "surface" module provides the Surface class (see below).
 //
 
+#include "adaptive_tessellation.h"
+#include "frame_context.h"
 #include "geometry.h"
 #include "geometrical_object.h"
+#include "indexed_mesh.h"
 #include "regular_mesh.h"
 #include "scene_object.h"
 #include "shader_programs.h"
 #include "transform.h"
 
+//
+// Surfaces welded into one IndexedMesh share vertices that are within
+// this distance (in each coordinate) of each other.
+//
+const double WELD_TOLERANCE = 1.0e-6;
+
+
 class Surface : public GeometricalObject
 //
 // represents a surface (a 2D manifold, possibly with a boundary)
@@ -30,20 +40,31 @@ protected:
     bool wrapI; // ... in the horizontal (topological) direction
     bool wrapJ; // ... in the vertical (topological) direction
 
+    void evaluate(const int nI_, const int nJ_,
+                  Point3f *vertexPositions, Vector3f *vertexNormals) const;
+    RegularMesh *tessellation(const int nI_, const int nJ_) const;
+    const double tessellationError(const int nI_, const int nJ_) const;
+
 public:
     // when the Surface is tessellated...
     RegularMesh *tessellationMesh;
+    // ... or, when it's drawn with drawAdaptively(), view-dependently
+    AdaptiveTessellation *adaptiveTessellation;
 
     Surface(int nI_, int nJ_, int wrapI_, int wrapJ_)
         : nI(nI_), nJ(nJ_), wrapI(wrapI_), wrapJ(wrapJ_),
-          tessellationMesh(NULL)
+          tessellationMesh(NULL), adaptiveTessellation(NULL)
     { };
+    virtual ~Surface();
 
     virtual const Point3 operator()(const double u, const double v,
                                     Vector3 &tangentU, Vector3 &tangentV)
         const = 0;
     void draw(SceneObject *sceneObject);
+    void drawAdaptively(const FrameContext &frameContext,
+                        const Transform &worldTransform);
     void tessellate(void);
+    static IndexedMesh *tessellateWelded(const vector<Surface *> &surfaces);
 };
 
 #define INCLUDED_SURFACES
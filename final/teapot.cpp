@@ -6,41 +6,69 @@
 #include "teapot_cvs.h"
 
 
-void Teapot::display(const Transform &viewProjectionTransform,
+void Teapot::display(const FrameContext &frameContext,
                      Transform worldTransform)
 {
-    Rgb veryRedRgb(0.976, 0.051, 0.008);
+    if (patchTessellation) {
+        // Only Teapots use it, so it's compiled when the first one is
+        // drawn and, as they're all it draws, its frame block is
+        // updated here.
+        if (!scene->bezierPatchShaderProgram)
+            scene->bezierPatchShaderProgram = new BezierPatchShaderProgram();
+        BezierPatchShaderProgram *program = scene->bezierPatchShaderProgram;
 
-    if (scene->eadsShaderProgram) { // will be NULL in the template
-        scene->eadsShaderProgram->setEmittance(blackColor);
-        scene->eadsShaderProgram->setDiffuse(0.3*veryRedRgb);
-        scene->eadsShaderProgram->setAmbient(0.3*veryRedRgb);
-        scene->eadsShaderProgram->setSpecular(Rgb(0.3, 0.3, 0.3), 30.0);
-        scene->eadsShaderProgram->setModelViewProjectionMatrix(
-            viewProjectionTransform * worldTransform);
-        scene->eadsShaderProgram->setWorldMatrix(worldTransform);
-        scene->eadsShaderProgram->setNormalMatrix(
-            worldTransform.getNormalTransform());
-        scene->eadsShaderProgram->start();
+        program->updateFrameBlock(frameContext);
+        program->setMaterial(material);
+        program->setWorldMatrix(worldTransform);
+        program->setNormalMatrix(worldTransform.getNormalTransform());
+        program->setModelViewProjectionMatrix(
+            frameContext.viewProjectionTransform * worldTransform);
+        program->start();
+        patchTessellation->render();
+    } else {
+        if (scene->eadsShaderProgram) { // will be NULL in the template
+            scene->eadsShaderProgram->setMaterial(material);
+            scene->eadsShaderProgram->setWorldMatrix(worldTransform);
+            scene->eadsShaderProgram->setNormalMatrix(
+                worldTransform.getNormalTransform());
+            scene->eadsShaderProgram->start();
+        }
+        tessellationMesh->render();
     }
 
-    // draw the individual patches
-    for (unsigned int i = 0; i < bezierPatches.size(); i++)
-        bezierPatches[i]->draw(this);
-
-    // draw their hedgehogs
     const double quillLength = 0.01;
-    for (unsigned int i = 0; i < bezierPatches.size(); i++) {
-        displayHedgehogs(viewProjectionTransform, worldTransform, quillLength);
-    }
+    displayHedgehogs(frameContext, worldTransform, quillLength);
 }
 
 
 Teapot::Teapot(void)
 {
+    Rgb veryRedRgb(0.976, 0.051, 0.008);
+
+    material = new Material(blackColor,
+                            0.3*veryRedRgb,
+                            0.3*veryRedRgb,
+                            Rgb(0.3, 0.3, 0.3), 30.0);
     for (int i = 0; i < nTeapotBezierPatches; i++) {
         BezierPatch *bezierPatch = new BezierPatch(
             teapotBezierPatches[i], nI, nJ);
         bezierPatches.push_back(bezierPatch);
     }
+    tessellationMesh = Surface::tessellateWelded(bezierPatches);
+    addHedgehogs(tessellationMesh);
+    if (BezierPatchShaderProgram::isSupported())
+        patchTessellation = new PatchTessellation(teapotBezierPatches,
+                                                  nTeapotBezierPatches);
+    else
+        patchTessellation = NULL;
+}
+
+
+Teapot::~Teapot()
+{
+    delete patchTessellation;
+    delete tessellationMesh;
+    for (unsigned int i = 0; i < bezierPatches.size(); i++)
+        delete bezierPatches[i];
+    delete material;
 }
@@ -9,6 +9,9 @@ using namespace std;
 #include "bezier_patch.h"
 #include "coordinate_axes.h"
 #include "geometry.h"
+#include "indexed_mesh.h"
+#include "material.h"
+#include "patch_tessellation.h"
 #include "scene_object.h"
 #include "shader_programs.h"
 #include "surface.h"
@@ -18,19 +21,26 @@ class Teapot : public SceneObject
 // SceneObject representing the classic Newell teapot
 //
 {
-    // A Teapot is made up of a collection of BezierPatches.
-    vector<BezierPatch *> bezierPatches;
+    // A Teapot is made up of a collection of BezierPatches, welded
+    // into a single mesh so it can be drawn at once. When the GPU can
+    // tessellate, though, the patches are drawn from their control
+    // vertices instead and the mesh is only used for hedgehogs.
+    vector<Surface *> bezierPatches;
+    IndexedMesh *tessellationMesh;
+    PatchTessellation *patchTessellation; // (NULL if unsupported)
 
     // Each patch will be made of the same material and will get an nI
     // x nJ tessellation.
     static const int nI = 8;
     static const int nJ = 8;
     Vector3 offset; // displacement from the modeling coordinate origin
+    Material *material;
 
 public:
     Teapot(void);
+    ~Teapot();
 
-    void display(const Transform &viewProjectionTransform,
+    void display(const FrameContext &frameContext,
                  Transform worldTransform);
 };
 
@@ -0,0 +1,222 @@
+#include <cassert>
+
+#include "check_gl.h"
+#include "render_stats.h"
+#include "shader_programs.h"
+#include "terrain.h"
+
+
+void Terrain::createBuffers(void)
+//
+// helper: creates the vertex buffers (with room for `nSlots` tiles) and
+// the index buffer of each level of detail, including its skirt
+//
+{
+    // (Tiles are drawn with a base vertex, so short indices suffice.)
+    assert(TERRAIN_TILE_VERTICES <= 1 << 16);
+
+    CHECK_GL(glGenBuffers(1, &vertexPositionsBufferId));
+    CHECK_GL(glGenBuffers(1, &vertexNormalBufferId));
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                          sizeof(Point3f) * nSlots * TERRAIN_TILE_VERTICES,
+                          NULL, GL_STATIC_DRAW));
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexNormalBufferId));
+    CHECK_GL(glBufferData(GL_ARRAY_BUFFER,
+                          sizeof(Vector3f) * nSlots * TERRAIN_TILE_VERTICES,
+                          NULL, GL_STATIC_DRAW));
+
+    CHECK_GL(glGenBuffers(N_TERRAIN_LODS, indexBufferIds));
+    for (int iLod = 0; iLod < N_TERRAIN_LODS; iLod++) {
+        vector<unsigned short> indices;
+
+        lodIndices(iLod, indices);
+        nIndices[iLod] = indices.size();
+        CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBufferIds[iLod]));
+        CHECK_GL(glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                              sizeof(indices[0]) * indices.size(),
+                              &indices[0], GL_STATIC_DRAW));
+    }
+}
+
+
+void Terrain::download(const BuiltTile &builtTile)
+//
+// helper: downloads `builtTile` into the slot of the vertex buffers it
+// was loaded into
+//
+{
+    const int baseVertex = tiles[builtTile.iTile].slot * TERRAIN_TILE_VERTICES;
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
+    CHECK_GL(glBufferSubData(GL_ARRAY_BUFFER,
+                             sizeof(Point3f) * baseVertex,
+                             sizeof(Point3f) * TERRAIN_TILE_VERTICES,
+                             &builtTile.vertexPositions[0]));
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexNormalBufferId));
+    CHECK_GL(glBufferSubData(GL_ARRAY_BUFFER,
+                             sizeof(Vector3f) * baseVertex,
+                             sizeof(Vector3f) * TERRAIN_TILE_VERTICES,
+                             &builtTile.vertexNormals[0]));
+}
+
+
+const void Terrain::render(void)
+//
+// draws the tiles that were visible at the last update(), grouped by
+// level of detail so each index buffer is only bound once
+//
+{
+    GLint vpai = ShaderProgram::getCurrentAttributeIndex("vertexPosition");
+
+    CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexPositionsBufferId));
+    CHECK_GL(glEnableVertexAttribArray(vpai));
+    CHECK_GL(glVertexAttribPointer(
+                 vpai, // index of attribute
+                 3, // # of elements per attribute
+                 GL_FLOAT, // type of each component
+                 GL_FALSE,  // don't normalized fixed-point values
+                 0, // offset between consecutive generic vertex attributes
+                 BUFFER_OFFSET(0)));
+
+    GLint vnai = ShaderProgram::getCurrentAttributeIndex("vertexNormal");
+
+    if (vnai != NO_SUCH_ATTRIBUTE) {
+        CHECK_GL(glBindBuffer(GL_ARRAY_BUFFER, vertexNormalBufferId));
+        CHECK_GL(glEnableVertexAttribArray(vnai));
+        CHECK_GL(glVertexAttribPointer(
+                     vnai, // index of attribute
+                     3, // # of elements per attribute
+                     GL_FLOAT, // type of each component
+                     GL_FALSE,  // don't normalized fixed-point values
+                     0, // offset between consecutive generic vertex attributes
+                     BUFFER_OFFSET(0)));
+    }
+
+    for (int iLod = 0; iLod < N_TERRAIN_LODS; iLod++) {
+        bool isBound = false;
+
+        for (unsigned int iTile = 0; iTile < tiles.size(); iTile++) {
+            const Tile &tile = tiles[iTile];
+
+            if (!tile.isVisible || tile.state != TILE_LOADED
+                    || tile.iLod != iLod)
+                continue;
+            if (!isBound) {
+                CHECK_GL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                                      indexBufferIds[iLod]));
+                isBound = true;
+            }
+            const int baseVertex = tile.slot * TERRAIN_TILE_VERTICES;
+            CHECK_GL(glDrawElementsBaseVertex(GL_TRIANGLES, nIndices[iLod],
+                                              GL_UNSIGNED_SHORT,
+                                              BUFFER_OFFSET(0), baseVertex));
+
+            renderStats.ctVertices += nIndices[iLod];
+            renderStats.ctTrianglesInIndexedMeshes += nIndices[iLod] / 3;
+        }
+    }
+}
+
+
+Terrain::Terrain(const Point3 (*positionAndPartials_)(
+                     const double u, const double v,
+                     Vector3 &dp_du, Vector3 &dp_dv),
+                 const int nTilesPerSide_)
+    : TerrainTiles(positionAndPartials_, nTilesPerSide_),
+      nTrianglesVisible(0)
+//
+// creates a Terrain of `nTilesPerSide_` x `nTilesPerSide_` tiles (so
+// `nTilesPerSide_` * TERRAIN_TILE_QUADS quads on a side) of
+// `positionAndPartials_` (see TerrainTiles), all of which are built now
+//
+{
+    BuiltTile builtTile;
+
+    createBuffers();
+    for (int iTile = 0; iTile < nSlots; iTile++) {
+        buildTile(iTile, builtTile);
+        loadTile(builtTile, iTile);
+        download(builtTile);
+    }
+}
+
+
+Terrain::Terrain(const Point3 (*positionAndPartials_)(
+                     const double u, const double v,
+                     Vector3 &dp_du, Vector3 &dp_dv),
+                 const int nTilesPerSide_,
+                 const int nSlots_, const double zMin, const double zMax)
+    : TerrainTiles(positionAndPartials_, nTilesPerSide_,
+                   nSlots_, zMin, zMax),
+      nTrianglesVisible(0)
+//
+// creates a streaming Terrain of `nTilesPerSide_` x `nTilesPerSide_`
+// tiles of `positionAndPartials_`, at most `nSlots_` of which are loaded
+// at a time (see TerrainTiles)
+//
+{
+    createBuffers();
+}
+
+
+Terrain::~Terrain()
+{
+    CHECK_GL(glDeleteBuffers(1, &vertexPositionsBufferId));
+    CHECK_GL(glDeleteBuffers(1, &vertexNormalBufferId));
+    CHECK_GL(glDeleteBuffers(N_TERRAIN_LODS, indexBufferIds));
+}
+
+
+const bool Terrain::isSupported(void)
+//
+// returns true iff the OpenGL implementation can draw with a base
+// vertex (i.e. is version 3.2 or later)
+//
+// (Ground checks every frame, but the version can't change, so it's
+// only looked up once.)
+//
+{
+    static const bool hasBaseVertex = ShaderProgram::glVersionIsAtLeast(3, 2);
+
+    return hasBaseVertex;
+}
+
+
+void Terrain::update(const FrameContext &frameContext,
+                     const Transform &worldTransform)
+//
+// culls the tiles outside the view (with `worldTransform` as the
+// Terrain's world transform) and picks each other tile's level of
+// detail, and (if the Terrain is streaming) downloads the tiles that
+// have been built and requests those that are needed
+//
+{
+    const double worldScale = worldTransform.maxScale();
+    vector<BuiltTile *> loadedTiles;
+
+    beginFrame(loadedTiles);
+    for (unsigned int k = 0; k < loadedTiles.size(); k++) {
+        download(*loadedTiles[k]);
+        delete loadedTiles[k];
+    }
+
+    nTrianglesVisible = 0;
+    for (unsigned int iTile = 0; iTile < tiles.size(); iTile++) {
+        const Tile &tile = tiles[iTile];
+        Point3 worldCenter = worldTransform * tile.center;
+        double worldRadius = worldScale * tile.radius;
+
+        if (!frameContext.sphereIsVisible(worldCenter, worldRadius))
+            continue;
+
+        // (pixels per model coordinate unit at the tile's nearest point)
+        double pixelsPerUnit = worldScale
+            * frameContext.pixelsPerUnit(worldCenter, worldRadius);
+
+        markVisible(iTile, pixelsPerUnit);
+        if (tile.state == TILE_LOADED)
+            nTrianglesVisible += nIndices[tile.iLod] / 3;
+    }
+    endFrame();
+}
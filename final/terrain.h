@@ -0,0 +1,80 @@
+#ifndef INCLUDED_TERRAIN
+
+//
+// The "terrain" module provides the Terrain class (see below).
+//
+
+#include "frame_context.h"
+#include "geometry.h"
+#include "terrain_tiles.h"
+#include "transform.h"
+
+using namespace std;
+
+
+class Terrain : public TerrainTiles
+//
+// a height field (see TerrainTiles) tessellated as a grid of square
+// tiles, each drawn at its own level of detail ("geomipmapping")
+//
+// Level `l` of a tile samples every 2^l-th vertex of its full-detail
+// grid. Every frame, update() skips tiles whose bounding spheres are
+// outside the view frustum and picks the coarsest level of each of the
+// others whose (precomputed) geometric error is within
+// TERRAIN_LOD_MAX_SCREEN_ERROR pixels.
+//
+// All tiles have the same vertex layout, so the triangles of each
+// level are a single index buffer shared by every tile, which is drawn
+// with the tile's offset in one large vertex buffer. Tiles at
+// different levels don't match along their common edges; instead of
+// stitching them (which would need an index buffer for every
+// combination of neighboring levels), each tile hangs a vertical
+// "skirt" down from its edges, deep enough to hide any crack.
+//
+// TerrainTiles builds the tiles and decides which are loaded where, and
+// their vertex data exists only on the GPU, in "slots" of one tile
+// each. A Terrain either builds all of its tiles when it's created or,
+// if it's "streaming", keeps only a bounded number of them: a worker
+// thread builds the visible tiles that aren't loaded (nearest first),
+// and update() downloads them into the slots of the tiles that have
+// been out of view the longest. (Until a tile is loaded, there's a
+// hole where it should be.)
+//
+// Tiles are drawn with glDrawElementsBaseVertex(), which needs OpenGL
+// 3.2. Check isSupported() before instancing one.
+//
+{
+    int nTrianglesVisible;
+
+    unsigned int vertexPositionsBufferId;
+    unsigned int vertexNormalBufferId;
+    unsigned int indexBufferIds[N_TERRAIN_LODS];
+    int nIndices[N_TERRAIN_LODS];
+
+    void createBuffers(void);
+    void download(const BuiltTile &builtTile);
+
+public:
+    Terrain(const Point3 (*positionAndPartials_)(
+                const double u, const double v,
+                Vector3 &dp_du, Vector3 &dp_dv),
+            const int nTilesPerSide_);
+    Terrain(const Point3 (*positionAndPartials_)(
+                const double u, const double v,
+                Vector3 &dp_du, Vector3 &dp_dv),
+            const int nTilesPerSide_,
+            const int nSlots_, const double zMin, const double zMax);
+    ~Terrain();
+
+    static const bool isSupported(void);
+    const int nTriangles(void) const
+    {
+        return nTrianglesVisible;
+    };
+    const void render(void);
+    void update(const FrameContext &frameContext,
+                const Transform &worldTransform);
+};
+
+#define INCLUDED_TERRAIN
+#endif // INCLUDED_TERRAIN
@@ -0,0 +1,977 @@
+#include <algorithm>
+#include <functional>
+
+#include "terrain_tiles.h"
+
+// (in TerrainTiles::tileOfSlot and TerrainTiles::iTileBuilding)
+static const int NO_TILE = -1;
+
+//
+// Each tile's vertices are its full-detail grid of (TERRAIN_TILE_QUADS
+// + 1)^2 vertices (row-major in j) followed by a copy of each of its
+// four edges (in the order below), moved down to form the skirt.
+//
+enum {
+    TILE_SIDE_VERTICES = TERRAIN_TILE_QUADS + 1,
+    N_TILE_GRID_VERTICES = TILE_SIDE_VERTICES * TILE_SIDE_VERTICES,
+};
+
+enum {
+    BOTTOM_EDGE, // j == 0
+    RIGHT_EDGE,  // i == TERRAIN_TILE_QUADS
+    TOP_EDGE,    // j == TERRAIN_TILE_QUADS
+    LEFT_EDGE,   // i == 0
+    N_EDGES
+};
+
+//
+// A skirt hangs this fraction of the tile's width below its deepest
+// possible crack, to cover the (sub-pixel) cracks at T-junctions
+// between tiles that have no geometric error.
+//
+static const double SKIRT_MARGIN = 0.01;
+
+
+static const int gridVertex(const int i, const int j)
+//
+// returns the index (within a tile) of vertex (`i`, `j`) of the tile's
+// full-detail grid
+//
+{
+    return j * TILE_SIDE_VERTICES + i;
+}
+
+
+static const int edgeVertex(const int edge, const int k)
+//
+// returns the index (within a tile) of the `k`th grid vertex (in
+// increasing i or j) along `edge`
+//
+{
+    switch (edge) {
+    case BOTTOM_EDGE:
+        return gridVertex(k, 0);
+    case RIGHT_EDGE:
+        return gridVertex(TERRAIN_TILE_QUADS, k);
+    case TOP_EDGE:
+        return gridVertex(k, TERRAIN_TILE_QUADS);
+    default:
+        return gridVertex(0, k);
+    }
+}
+
+
+static const int skirtVertex(const int edge, const int k)
+//
+// returns the index (within a tile) of the skirt vertex below
+// edgeVertex(`edge`, `k`)
+//
+{
+    return N_TILE_GRID_VERTICES + edge * TILE_SIDE_VERTICES + k;
+}
+
+
+static void addQuad(vector<unsigned short> &indices,
+                    const int q0, const int q1, const int q2, const int q3)
+//
+// appends the two triangles of quad (`q0`, `q1`, `q2`, `q3`) (CCW in
+// (u, v)) to `indices`, split as Surface's tessellations are
+//
+{
+    const int triangles[2][3] = {
+        { q0, q2, q3 },
+        { q0, q1, q2 },
+    };
+
+    for (int t = 0; t < 2; t++)
+        for (int k = 0; k < 3; k++)
+            indices.push_back(triangles[t][k]);
+}
+
+
+TerrainTiles::TerrainTiles(const Point3 (*positionAndPartials_)(
+                               const double u, const double v,
+                               Vector3 &dp_du, Vector3 &dp_dv),
+                           const int nTilesPerSide_)
+    : positionAndPartials(positionAndPartials_),
+      nTilesPerSide(nTilesPerSide_), frameNumber(0),
+      nSlots(nTilesPerSide_ * nTilesPerSide_), nLoadedVisible(0),
+      iTileBuilding(NO_TILE), isStopping(false)
+//
+// creates the TerrainTiles of a Terrain all of whose tiles are loaded
+// (by loadTile(), in the slot with the tile's index) when it's created
+//
+{
+    tiles.resize(nSlots);
+    tileOfSlot.resize(nSlots, NO_TILE);
+    for (int iTile = 0; iTile < nSlots; iTile++) {
+        Tile &tile = tiles[iTile];
+
+        tile.state = TILE_ABSENT;
+        tile.slot = NO_TILE;
+        tile.lastFrameVisible = -1;
+        tile.isVisible = false;
+        tile.iLod = N_TERRAIN_LODS - 1;
+    }
+}
+
+
+TerrainTiles::TerrainTiles(const Point3 (*positionAndPartials_)(
+                               const double u, const double v,
+                               Vector3 &dp_du, Vector3 &dp_dv),
+                           const int nTilesPerSide_,
+                           const int nSlots_,
+                           const double zMin, const double zMax)
+    : positionAndPartials(positionAndPartials_),
+      nTilesPerSide(nTilesPerSide_), frameNumber(0),
+      nSlots(min(nSlots_, nTilesPerSide_ * nTilesPerSide_)),
+      nLoadedVisible(0), iTileBuilding(NO_TILE), isStopping(false)
+//
+// creates the TerrainTiles of a streaming Terrain, at most `nSlots_` of
+// whose tiles are loaded at a time
+//
+// The heights of `positionAndPartials_` must be between `zMin` and
+// `zMax` (which bound the tiles that haven't been loaded yet), and it
+// must be safe to evaluate in another thread.
+//
+{
+    const int nTiles = nTilesPerSide * nTilesPerSide;
+
+    tiles.resize(nTiles);
+    tileOfSlot.resize(nSlots, NO_TILE);
+    for (int iTile = 0; iTile < nTiles; iTile++) {
+        Tile &tile = tiles[iTile];
+        const int iTileI = iTile % nTilesPerSide;
+        const int iTileJ = iTile / nTilesPerSide;
+        Point3 boxMin, boxMax;
+
+        tile.state = TILE_ABSENT;
+        tile.slot = NO_TILE;
+        tile.lastFrameVisible = -1;
+        tile.isVisible = false;
+        tile.iLod = N_TERRAIN_LODS - 1;
+
+        // The tile's corners bound it in x and y.
+        for (int k = 0; k < 4; k++) {
+            Vector3 dp_du, dp_dv; // (ignored)
+            Point3 corner = (*positionAndPartials)(
+                (double) (iTileI + k % 2) / nTilesPerSide,
+                (double) (iTileJ + k / 2) / nTilesPerSide, dp_du, dp_dv);
+
+            if (k == 0)
+                boxMin = boxMax = corner;
+            for (int kk = 0; kk < 2; kk++) {
+                boxMin.u.a[kk] = min(boxMin.u.a[kk], corner.u.a[kk]);
+                boxMax.u.a[kk] = max(boxMax.u.a[kk], corner.u.a[kk]);
+            }
+        }
+        boxMin.u.g.z = zMin;
+        boxMax.u.g.z = zMax;
+        tile.center = boxMin + 0.5 * (boxMax - boxMin);
+        tile.radius = (boxMax - tile.center).mag();
+    }
+
+    worker = thread(&TerrainTiles::buildTiles, this);
+}
+
+
+TerrainTiles::~TerrainTiles()
+{
+    if (worker.joinable()) {
+        {
+            lock_guard<mutex> lock(queueMutex);
+            isStopping = true;
+        }
+        requestsQueued.notify_one();
+        worker.join();
+    }
+    for (unsigned int k = 0; k < builtTiles.size(); k++)
+        delete builtTiles[k];
+}
+
+
+void TerrainTiles::beginFrame(vector<BuiltTile *> &loadedTiles)
+//
+// starts a frame (in which no tile is visible yet) by loading (at most
+// TERRAIN_MAX_DOWNLOADS_PER_FRAME of) the tiles the worker thread has
+// built, each into a free slot or that of the loaded tile that has
+// been out of view the longest
+//
+// The tiles that are loaded are returned in `loadedTiles`, for the
+// caller to download into their slots and delete.
+//
+{
+    vector<BuiltTile *> ready;
+
+    frameNumber++;
+    nLoadedVisible = 0;
+    wantedTiles.clear();
+    for (unsigned int iTile = 0; iTile < tiles.size(); iTile++)
+        tiles[iTile].isVisible = false;
+
+    loadedTiles.clear();
+    if (!isStreaming())
+        return;
+    {
+        lock_guard<mutex> lock(queueMutex);
+
+        while (!builtTiles.empty()
+               && (int) ready.size() < TERRAIN_MAX_DOWNLOADS_PER_FRAME) {
+            ready.push_back(builtTiles.front());
+            builtTiles.pop_front();
+        }
+    }
+
+    for (unsigned int k = 0; k < ready.size(); k++) {
+        BuiltTile *builtTile = ready[k];
+        int slot = NO_TILE;
+        int oldestFrame = frameNumber - 1; // (Visible tiles are kept.)
+
+        for (int iSlot = 0; iSlot < nSlots; iSlot++) {
+            if (tileOfSlot[iSlot] == NO_TILE) {
+                slot = iSlot;
+                break;
+            }
+            const Tile &loadedTile = tiles[tileOfSlot[iSlot]];
+            if (loadedTile.lastFrameVisible < oldestFrame) {
+                slot = iSlot;
+                oldestFrame = loadedTile.lastFrameVisible;
+            }
+        }
+
+        if (slot != NO_TILE) {
+            if (tileOfSlot[slot] != NO_TILE)
+                tiles[tileOfSlot[slot]].state = TILE_ABSENT;
+            loadTile(*builtTile, slot);
+            loadedTiles.push_back(builtTile);
+        } else {
+            // (There's no room for it now, but it can be requested again.)
+            tiles[builtTile->iTile].state = TILE_ABSENT;
+            delete builtTile;
+        }
+    }
+}
+
+
+void TerrainTiles::buildTile(const int iTile, BuiltTile &builtTile) const
+//
+// evaluates the tiles' function at tile `iTile`'s vertices (and
+// computes its errors and bounding sphere) into `builtTile`
+//
+// This runs in the worker thread of a streaming TerrainTiles, so it may
+// only read the members that never change.
+//
+{
+    const int iTileI = iTile % nTilesPerSide;
+    const int iTileJ = iTile / nTilesPerSide;
+    const double dUV = 1.0 / (nTilesPerSide * TERRAIN_TILE_QUADS);
+    vector<Point3> grid(N_TILE_GRID_VERTICES);
+    vector<Point3f> &positions = builtTile.vertexPositions;
+    vector<Vector3f> &normals = builtTile.vertexNormals;
+
+    builtTile.iTile = iTile;
+    positions.resize(TERRAIN_TILE_VERTICES);
+    normals.resize(TERRAIN_TILE_VERTICES);
+    for (int j = 0; j < TILE_SIDE_VERTICES; j++) {
+        for (int i = 0; i < TILE_SIDE_VERTICES; i++) {
+            const double u = (iTileI * TERRAIN_TILE_QUADS + i) * dUV;
+            const double v = (iTileJ * TERRAIN_TILE_QUADS + j) * dUV;
+            const int iVertex = gridVertex(i, j);
+            Vector3 dp_du, dp_dv;
+
+            grid[iVertex] = (*positionAndPartials)(u, v, dp_du, dp_dv);
+            positions[iVertex] = Point3f(grid[iVertex]);
+            // (as Surface::evaluate() computes them)
+            normals[iVertex] = Vector3f(dp_dv.cross(dp_du).normalized());
+        }
+    }
+
+    //
+    // The error of a level is the farthest any full-detail vertex is
+    // from the level's triangles.
+    //
+    builtTile.errors[0] = 0.0;
+    for (int iLod = 1; iLod < N_TERRAIN_LODS; iLod++) {
+        const int step = 1 << iLod;
+        double error = builtTile.errors[iLod - 1];
+
+        for (int j = 0; j < TILE_SIDE_VERTICES; j++) {
+            const int j0 = min(j / step * step, TERRAIN_TILE_QUADS - step);
+            const double b = (double) (j - j0) / step;
+
+            for (int i = 0; i < TILE_SIDE_VERTICES; i++) {
+                const int i0 = min(i / step * step, TERRAIN_TILE_QUADS - step);
+                const double a = (double) (i - i0) / step;
+                const Point3 &p00 = grid[gridVertex(i0, j0)];
+                const Point3 &p10 = grid[gridVertex(i0 + step, j0)];
+                const Point3 &p11 = grid[gridVertex(i0 + step, j0 + step)];
+                const Point3 &p01 = grid[gridVertex(i0, j0 + step)];
+                // (on the same triangle of the quad as addQuad())
+                const Point3 approximation = (b >= a)
+                    ? p00 + a * (p11 - p01) + b * (p01 - p00)
+                    : p00 + a * (p10 - p00) + b * (p11 - p10);
+
+                error = max(error,
+                            (grid[gridVertex(i, j)] - approximation).mag());
+            }
+        }
+        builtTile.errors[iLod] = error;
+    }
+
+    Point3 boxMin = grid[0];
+    Point3 boxMax = grid[0];
+    for (int iVertex = 1; iVertex < N_TILE_GRID_VERTICES; iVertex++)
+        for (int k = 0; k < 3; k++) {
+            boxMin.u.a[k] = min(boxMin.u.a[k], grid[iVertex].u.a[k]);
+            boxMax.u.a[k] = max(boxMax.u.a[k], grid[iVertex].u.a[k]);
+        }
+
+    //
+    // Along an edge, any level of either tile that shares it is within
+    // the coarsest error of this one (the edge's samples are the same),
+    // so a skirt twice that deep covers any crack between them.
+    //
+    const double skirtDepth = 2.0 * builtTile.errors[N_TERRAIN_LODS - 1]
+        + SKIRT_MARGIN * (boxMax.u.g.x - boxMin.u.g.x);
+
+    for (int edge = 0; edge < N_EDGES; edge++)
+        for (int k = 0; k < TILE_SIDE_VERTICES; k++) {
+            const int iSkirtVertex = skirtVertex(edge, k);
+
+            positions[iSkirtVertex] = positions[edgeVertex(edge, k)];
+            positions[iSkirtVertex].u.g.z -= skirtDepth;
+            normals[iSkirtVertex] = normals[edgeVertex(edge, k)];
+        }
+
+    boxMin.u.g.z -= skirtDepth;
+    builtTile.center = boxMin + 0.5 * (boxMax - boxMin);
+    builtTile.radius = (boxMax - builtTile.center).mag();
+}
+
+
+void TerrainTiles::buildTiles(void)
+//
+// helper: the worker thread of a streaming TerrainTiles, which builds
+// the requested tiles until the TerrainTiles is destroyed
+//
+{
+    unique_lock<mutex> lock(queueMutex);
+
+    for (;;) {
+        while (!isStopping && requests.empty())
+            requestsQueued.wait(lock);
+        if (isStopping)
+            return;
+
+        const int iTile = requests.front();
+        requests.pop_front();
+        iTileBuilding = iTile;
+        lock.unlock();
+
+        BuiltTile *builtTile = new BuiltTile;
+        buildTile(iTile, *builtTile);
+
+        lock.lock();
+        builtTiles.push_back(builtTile);
+        iTileBuilding = NO_TILE;
+    }
+}
+
+
+void TerrainTiles::endFrame(void)
+//
+// ends a frame by requesting (if the TerrainTiles is streaming) the
+// tiles that were visible in it but aren't loaded
+//
+{
+    if (isStreaming())
+        requestTiles();
+}
+
+
+const bool TerrainTiles::isIdle(void)
+//
+// returns true iff the worker thread (if any) has no tiles to build
+//
+{
+    lock_guard<mutex> lock(queueMutex);
+
+    return requests.empty() && iTileBuilding == NO_TILE;
+}
+
+
+void TerrainTiles::loadTile(const BuiltTile &builtTile, const int slot)
+//
+// makes `builtTile` the tile loaded in `slot`
+//
+{
+    Tile &tile = tiles[builtTile.iTile];
+
+    tile.state = TILE_LOADED;
+    tile.slot = slot;
+    tile.center = builtTile.center;
+    tile.radius = builtTile.radius;
+    copy(builtTile.errors, builtTile.errors + N_TERRAIN_LODS, tile.errors);
+    tileOfSlot[slot] = builtTile.iTile;
+}
+
+
+void TerrainTiles::lodIndices(const int iLod, vector<unsigned short> &indices)
+//
+// sets `indices` to the triangles (including the skirt) of level of
+// detail `iLod` of any tile, as indices within the tile's vertices
+//
+{
+    const int step = 1 << iLod;
+    const int n = TERRAIN_TILE_QUADS / step;
+
+    indices.clear();
+    for (int j = 0; j < n; j++)
+        for (int i = 0; i < n; i++)
+            addQuad(indices,
+                    gridVertex(i * step,       j * step),
+                    gridVertex((i + 1) * step, j * step),
+                    gridVertex((i + 1) * step, (j + 1) * step),
+                    gridVertex(i * step,       (j + 1) * step));
+
+    // skirts, wound as if they were the adjoining row or column
+    for (int k = 0; k < n; k++) {
+        const int a = k * step;
+        const int b = (k + 1) * step;
+
+        addQuad(indices,
+                skirtVertex(BOTTOM_EDGE, a), skirtVertex(BOTTOM_EDGE, b),
+                edgeVertex(BOTTOM_EDGE, b), edgeVertex(BOTTOM_EDGE, a));
+        addQuad(indices,
+                edgeVertex(RIGHT_EDGE, a), skirtVertex(RIGHT_EDGE, a),
+                skirtVertex(RIGHT_EDGE, b), edgeVertex(RIGHT_EDGE, b));
+        addQuad(indices,
+                edgeVertex(TOP_EDGE, a), edgeVertex(TOP_EDGE, b),
+                skirtVertex(TOP_EDGE, b), skirtVertex(TOP_EDGE, a));
+        addQuad(indices,
+                skirtVertex(LEFT_EDGE, a), edgeVertex(LEFT_EDGE, a),
+                edgeVertex(LEFT_EDGE, b), skirtVertex(LEFT_EDGE, b));
+    }
+}
+
+
+void TerrainTiles::markVisible(const int iTile, const double pixelsPerUnit)
+//
+// marks tile `iTile`, whose nearest point has `pixelsPerUnit` pixels
+// per model coordinate unit, as visible in this frame and, if it's
+// loaded, picks its level of detail
+//
+{
+    Tile &tile = tiles[iTile];
+
+    tile.isVisible = true;
+    tile.lastFrameVisible = frameNumber;
+    if (tile.state != TILE_LOADED) {
+        // Nearer tiles (with more pixels per unit) come first.
+        wantedTiles.push_back(make_pair(pixelsPerUnit, iTile));
+        return;
+    }
+    tile.iLod = selectLod(tile.errors, tile.iLod, pixelsPerUnit);
+    nLoadedVisible++;
+}
+
+
+void TerrainTiles::requestTiles(void)
+//
+// helper: replaces the worker thread's queue with those of this frame's
+// `wantedTiles` that aren't already built or being built, in
+// decreasing order of priority
+//
+// Only as many tiles are requested as will fit in the slots of loaded
+// tiles that weren't visible (which can be reused), or tiles that
+// can't be kept would be built over and over again.
+//
+{
+    lock_guard<mutex> lock(queueMutex);
+
+    // Requests that are still queued can be reordered (or dropped)...
+    for (unsigned int k = 0; k < requests.size(); k++)
+        tiles[requests[k]].state = TILE_ABSENT;
+    requests.clear();
+    // ...but the worker thread has taken the rest.
+    for (unsigned int k = 0; k < lastRequests.size(); k++)
+        if (tiles[lastRequests[k]].state == TILE_REQUESTED)
+            tiles[lastRequests[k]].state = TILE_BUILDING;
+    lastRequests.clear();
+
+    int nFreeSlots = nSlots - nLoadedVisible;
+    int nPending = builtTiles.size() + (iTileBuilding != NO_TILE);
+    vector< pair<double, int> > absentTiles;
+    for (unsigned int k = 0; k < wantedTiles.size(); k++)
+        if (tiles[wantedTiles[k].second].state == TILE_ABSENT)
+            absentTiles.push_back(wantedTiles[k]);
+    const int n = min(nFreeSlots - nPending, (int) absentTiles.size());
+    if (n <= 0)
+        return;
+
+    partial_sort(absentTiles.begin(), absentTiles.begin() + n,
+                 absentTiles.end(), greater< pair<double, int> >());
+    for (int k = 0; k < n; k++) {
+        const int iTile = absentTiles[k].second;
+
+        requests.push_back(iTile);
+        tiles[iTile].state = TILE_REQUESTED;
+    }
+    lastRequests.assign(requests.begin(), requests.end());
+    requestsQueued.notify_one();
+}
+
+
+const int TerrainTiles::selectLod(const double errors[N_TERRAIN_LODS],
+                                  int iLod, const double pixelsPerUnit)
+//
+// returns the level of detail to draw a tile with `errors` at, given
+// that it was drawn at `iLod` and its nearest point has
+// `pixelsPerUnit` pixels per model coordinate unit
+//
+{
+    while (iLod > 0
+           && errors[iLod] * pixelsPerUnit > TERRAIN_LOD_MAX_SCREEN_ERROR)
+        iLod--;
+    while (iLod < N_TERRAIN_LODS - 1
+           && TERRAIN_LOD_HYSTERESIS * errors[iLod + 1] * pixelsPerUnit
+               <= TERRAIN_LOD_MAX_SCREEN_ERROR)
+        iLod++;
+    return iLod;
+}
+
+
+#ifdef TEST
+//
+// builds tiles of fields whose errors are known and checks them, their
+// skirts, and the levels of detail selected for them, then streams the
+// tiles of a synthetic height field through a few slots, checking which
+// are loaded where (and when)
+//
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <math.h> // for fabs()
+
+// (the fields span [-1, 1] x [-1, 1], as 4 x 4 tiles)
+static const int nTestTilesPerSide = 4;
+
+// the width of a full-detail quad
+static const double quadWidth
+    = 2.0 / (nTestTilesPerSide * TERRAIN_TILE_QUADS);
+
+// z = PARABOLA_CURVATURE * x^2
+static const double PARABOLA_CURVATURE = 0.5;
+
+static const double tolerance = 1.0e-9;
+
+
+static const Point3 flatPositionAndPartials(const double u, const double v,
+                                            Vector3 &dp_du, Vector3 &dp_dv)
+//
+// a tilted plane
+//
+{
+    const double x = 2.0 * u - 1.0;
+    const double y = 2.0 * v - 1.0;
+
+    dp_du = Vector3(2.0, 0.0, 2.0 * 0.3);
+    dp_dv = Vector3(0.0, 2.0, 2.0 * -0.2);
+    return Point3(x, y, 0.3 * x - 0.2 * y + 1.0);
+}
+
+
+static const Point3 parabolicPositionAndPartials(
+    const double u, const double v, Vector3 &dp_du, Vector3 &dp_dv)
+//
+// a trough curved in x only, so a level's largest error (at the middle
+// of one of its quads) is exactly PARABOLA_CURVATURE * (w / 2)^2, where
+// w is the width of its quads
+//
+{
+    const double x = 2.0 * u - 1.0;
+    const double y = 2.0 * v - 1.0;
+
+    dp_du = Vector3(2.0, 0.0, 2.0 * 2.0 * PARABOLA_CURVATURE * x);
+    dp_dv = Vector3(0.0, 2.0, 0.0);
+    return Point3(x, y, PARABOLA_CURVATURE * x * x);
+}
+
+
+static const Point3 hillyPositionAndPartials(const double u, const double v,
+                                             Vector3 &dp_du, Vector3 &dp_dv)
+//
+// rolling hills, curved every which way
+//
+{
+    const double x = 2.0 * u - 1.0;
+    const double y = 2.0 * v - 1.0;
+
+    dp_du = Vector3(2.0, 0.0, 2.0 * 0.2 * 3.0 * cos(3.0 * x) * cos(5.0 * y));
+    dp_dv = Vector3(0.0, 2.0, 2.0 * 0.2 * -5.0 * sin(3.0 * x) * sin(5.0 * y));
+    return Point3(x, y, 0.2 * sin(3.0 * x) * cos(5.0 * y));
+}
+
+
+// (how many times streamedPositionAndPartials() has been called)
+static atomic<int> nStreamedEvaluations(0);
+
+
+static const Point3 streamedPositionAndPartials(
+    const double u, const double v, Vector3 &dp_du, Vector3 &dp_dv)
+//
+// the hilly field, counting its evaluations (in any thread)
+//
+{
+    nStreamedEvaluations++;
+    return hillyPositionAndPartials(u, v, dp_du, dp_dv);
+}
+
+
+static int checkTile(const char *name, const TerrainTiles &terrainTiles,
+                     const int iTile, const bool isFlat,
+                     const bool isParabolic)
+//
+// builds tile `iTile` of `terrainTiles` and returns the number of
+// things wrong with it
+//
+{
+    TerrainTiles::BuiltTile builtTile;
+    int nErrors = 0;
+
+    terrainTiles.buildTile(iTile, builtTile);
+    const double *errors = builtTile.errors;
+
+    for (int iLod = 0; iLod < N_TERRAIN_LODS; iLod++) {
+        if (iLod > 0 && errors[iLod] < errors[iLod - 1])
+            nErrors++; // (Coarser levels are never more accurate.)
+        if (isFlat && fabs(errors[iLod]) > tolerance)
+            nErrors++;
+        if (isParabolic && iLod > 0) { // (Level 0 is exact.)
+            const double halfWidth = 0.5 * (1 << iLod) * quadWidth;
+
+            if (fabs(errors[iLod] - PARABOLA_CURVATURE * halfWidth * halfWidth)
+                    > tolerance)
+                nErrors++;
+        }
+    }
+
+    //
+    // Each skirt vertex must be below its edge vertex, deep enough for
+    // the coarsest level, and every vertex must be in the bounding
+    // sphere.
+    //
+    const vector<Point3f> &positions = builtTile.vertexPositions;
+    for (int edge = 0; edge < N_EDGES; edge++)
+        for (int k = 0; k < TILE_SIDE_VERTICES; k++) {
+            const Point3f &top = positions[edgeVertex(edge, k)];
+            const Point3f &bottom = positions[skirtVertex(edge, k)];
+
+            if (bottom.u.g.x != top.u.g.x || bottom.u.g.y != top.u.g.y
+                    || top.u.g.z - bottom.u.g.z
+                           < 2.0 * errors[N_TERRAIN_LODS - 1] - 1.0e-6)
+                nErrors++;
+        }
+    for (int iVertex = 0; iVertex < TERRAIN_TILE_VERTICES; iVertex++)
+        if ((Point3(positions[iVertex]) - builtTile.center).mag()
+                > builtTile.radius + 1.0e-6)
+            nErrors++;
+
+    printf("%-24s tile %2d: errors", name, iTile);
+    for (int iLod = 0; iLod < N_TERRAIN_LODS; iLod++)
+        printf(" %.2e", errors[iLod]);
+    printf(" %s\n", nErrors ? "FAILED" : "ok");
+    return nErrors;
+}
+
+
+static int checkLodSelection(const TerrainTiles &terrainTiles)
+//
+// sweeps the number of pixels per unit of a tile of `terrainTiles`
+// over the range where every level is selected and returns the number
+// of selections that aren't within a pixel or don't resist switching
+//
+{
+    TerrainTiles::BuiltTile builtTile;
+    int nErrors = 0;
+
+    terrainTiles.buildTile(0, builtTile);
+    const double *errors = builtTile.errors;
+
+    for (double pixelsPerUnit = 0.01 / errors[N_TERRAIN_LODS - 1];
+         pixelsPerUnit < 100.0 / errors[1]; pixelsPerUnit *= 1.01) {
+        for (int iLodBefore = 0; iLodBefore < N_TERRAIN_LODS; iLodBefore++) {
+            const int iLod = TerrainTiles::selectLod(errors, iLodBefore,
+                                                     pixelsPerUnit);
+
+            // within a pixel...
+            if (errors[iLod] * pixelsPerUnit > TERRAIN_LOD_MAX_SCREEN_ERROR)
+                nErrors++;
+            // ...and, if it coarsened, the hysteresis allowed it
+            if (iLod > iLodBefore
+                    && TERRAIN_LOD_HYSTERESIS * errors[iLod] * pixelsPerUnit
+                        > TERRAIN_LOD_MAX_SCREEN_ERROR)
+                nErrors++;
+            // and it's stable
+            if (TerrainTiles::selectLod(errors, iLod, pixelsPerUnit) != iLod)
+                nErrors++;
+        }
+
+        //
+        // A level that's within the tolerance, but not by the
+        // hysteresis factor, is kept if it's drawn now but not
+        // coarsened to if it isn't.
+        //
+        for (int iLod = 1; iLod < N_TERRAIN_LODS; iLod++) {
+            const double scale = errors[iLod] * pixelsPerUnit;
+
+            if (scale > 0.8 && scale <= TERRAIN_LOD_MAX_SCREEN_ERROR
+                    && iLod < N_TERRAIN_LODS - 1
+                    && errors[iLod + 1] * pixelsPerUnit
+                        > TERRAIN_LOD_MAX_SCREEN_ERROR) {
+                if (TerrainTiles::selectLod(errors, iLod, pixelsPerUnit)
+                        != iLod
+                    || TerrainTiles::selectLod(errors, iLod - 1,
+                                               pixelsPerUnit) != iLod - 1)
+                    nErrors++;
+            }
+        }
+    }
+    printf("%-24s %s\n", "level of detail selection",
+           nErrors ? "FAILED" : "ok");
+    return nErrors;
+}
+
+
+static int checkLodIndices(void)
+//
+// returns the number of levels of detail whose triangles aren't all
+// there or refer to vertices that aren't
+//
+{
+    int nErrors = 0;
+
+    for (int iLod = 0; iLod < N_TERRAIN_LODS; iLod++) {
+        const int n = TERRAIN_TILE_QUADS >> iLod;
+        vector<unsigned short> indices;
+
+        TerrainTiles::lodIndices(iLod, indices);
+        // (two triangles for each quad and each quad of the skirt)
+        if ((int) indices.size() != 6 * (n * n + 4 * n))
+            nErrors++;
+        for (unsigned int k = 0; k < indices.size(); k++)
+            if (indices[k] >= TERRAIN_TILE_VERTICES) {
+                nErrors++;
+                break;
+            }
+    }
+    printf("%-24s %s\n", "level of detail indices", nErrors ? "FAILED" : "ok");
+    return nErrors;
+}
+
+
+static void waitUntilIdle(TerrainTiles &terrainTiles)
+//
+// waits until `terrainTiles`'s worker thread has built what it was asked
+// to
+//
+{
+    while (!terrainTiles.isIdle())
+        this_thread::sleep_for(chrono::milliseconds(1));
+}
+
+
+static const int runFrame(TerrainTiles &terrainTiles,
+                          const int *visibleTiles, const int nVisibleTiles)
+//
+// runs a frame of `terrainTiles` in which the `nVisibleTiles` tiles in
+// `visibleTiles` are visible (the earlier ones nearer) and returns the
+// number of tiles that were loaded in it
+//
+{
+    vector<TerrainTiles::BuiltTile *> loadedTiles;
+
+    terrainTiles.beginFrame(loadedTiles);
+    for (unsigned int k = 0; k < loadedTiles.size(); k++)
+        delete loadedTiles[k];
+    for (int k = 0; k < nVisibleTiles; k++)
+        terrainTiles.markVisible(visibleTiles[k], 1000.0 - k);
+    terrainTiles.endFrame();
+    return loadedTiles.size();
+}
+
+
+static const int nTilesIn(const TerrainTiles &terrainTiles,
+                          const TerrainTiles::TileState state)
+//
+// returns the number of `terrainTiles`'s tiles in `state`
+//
+{
+    int n = 0;
+
+    for (int iTile = 0; iTile < terrainTiles.nTiles(); iTile++)
+        n += (terrainTiles[iTile].state == state);
+    return n;
+}
+
+
+static int checkDownloadLimit(void)
+//
+// streams all 64 tiles of an 8 x 8 TerrainTiles with a slot for each
+// and returns the number of frames in which more than
+// TERRAIN_MAX_DOWNLOADS_PER_FRAME tiles (or fewer, while more were
+// waiting) were loaded
+//
+{
+    const int nTiles = 64;
+    TerrainTiles terrainTiles(streamedPositionAndPartials, 8, nTiles,
+                              -0.2, 0.2);
+    int visibleTiles[nTiles];
+    int nErrors = 0;
+    int nLoaded = 0;
+    int nFrames = 0;
+
+    for (int k = 0; k < nTiles; k++)
+        visibleTiles[k] = k;
+    runFrame(terrainTiles, visibleTiles, nTiles);
+    waitUntilIdle(terrainTiles);
+    while (nLoaded < nTiles && nFrames < nTiles) {
+        const int n = runFrame(terrainTiles, visibleTiles, nTiles);
+
+        if (n != min(nTiles - nLoaded, (int) TERRAIN_MAX_DOWNLOADS_PER_FRAME))
+            nErrors++;
+        nLoaded += n;
+        nFrames++;
+    }
+    if (nTilesIn(terrainTiles, TerrainTiles::TILE_LOADED) != nTiles)
+        nErrors++;
+    printf("%-24s %d tiles in %d frames %s\n", "download limit", nLoaded,
+           nFrames, nErrors ? "FAILED" : "ok");
+    return nErrors;
+}
+
+
+static int checkSlotReuse(void)
+//
+// streams a 3 x 3 TerrainTiles through 4 slots and returns the number of
+// frames in which it loads more tiles than fit, evicts a visible one,
+// keeps building tiles it can't keep, or doesn't reuse the slot of the
+// tile that has been out of view the longest
+//
+{
+    const int nSlots = 4;
+    TerrainTiles terrainTiles(streamedPositionAndPartials, 3, nSlots,
+                              -0.2, 0.2);
+    const int allTiles[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8 };
+    int nErrors = 0;
+
+    // With all 9 visible, the 4 nearest are loaded and the rest wait.
+    runFrame(terrainTiles, allTiles, 9);
+    if (nTilesIn(terrainTiles, TerrainTiles::TILE_REQUESTED)
+            + nTilesIn(terrainTiles, TerrainTiles::TILE_BUILDING) > nSlots)
+        nErrors++;
+    int nEvaluations = 0;
+    for (int frame = 0; frame < 4; frame++) {
+        waitUntilIdle(terrainTiles);
+        if (frame == 2)
+            nEvaluations = nStreamedEvaluations;
+        runFrame(terrainTiles, allTiles, 9);
+        if (nTilesIn(terrainTiles, TerrainTiles::TILE_LOADED) > nSlots)
+            nErrors++;
+    }
+    waitUntilIdle(terrainTiles);
+    if (nStreamedEvaluations != nEvaluations) // (nothing more was built)
+        nErrors++;
+    for (int iTile = 0; iTile < 9; iTile++)
+        if ((terrainTiles[iTile].state == TerrainTiles::TILE_LOADED)
+                != (iTile < nSlots))
+            nErrors++;
+
+    // Tile 0 goes out of view, then tile 1, and then tiles 4 and 5 come
+    // into it...
+    const int slot0 = terrainTiles[0].slot;
+    const int slot1 = terrainTiles[1].slot;
+    const int tiles123[] = { 1, 2, 3 };
+    const int tiles2345[] = { 2, 3, 4, 5 };
+    runFrame(terrainTiles, tiles123, 3);
+    runFrame(terrainTiles, tiles2345, 2);
+    runFrame(terrainTiles, tiles2345, 3);
+    waitUntilIdle(terrainTiles);
+    runFrame(terrainTiles, tiles2345, 3);
+    // ...so tile 4 takes tile 0's slot...
+    if (terrainTiles[4].state != TerrainTiles::TILE_LOADED
+            || terrainTiles[4].slot != slot0
+            || terrainTiles[0].state != TerrainTiles::TILE_ABSENT
+            || terrainTiles[1].state != TerrainTiles::TILE_LOADED)
+        nErrors++;
+    runFrame(terrainTiles, tiles2345, 4);
+    waitUntilIdle(terrainTiles);
+    runFrame(terrainTiles, tiles2345, 4);
+    // ...and tile 5 takes tile 1's.
+    if (terrainTiles[5].state != TerrainTiles::TILE_LOADED
+            || terrainTiles[5].slot != slot1
+            || terrainTiles[1].state != TerrainTiles::TILE_ABSENT)
+        nErrors++;
+    for (int k = 0; k < 4; k++)
+        if (terrainTiles[tiles2345[k]].state != TerrainTiles::TILE_LOADED)
+            nErrors++;
+
+    printf("%-24s %s\n", "slot reuse", nErrors ? "FAILED" : "ok");
+    return nErrors;
+}
+
+
+static int checkStopping(void)
+//
+// destroys a streaming TerrainTiles while its worker thread is busy and
+// returns 1 if the worker thread goes on running afterwards (or 0 if
+// it doesn't)
+//
+{
+    const int nTiles = 256;
+    TerrainTiles *terrainTiles = new TerrainTiles(
+        streamedPositionAndPartials, 16, nTiles, -0.2, 0.2);
+    int visibleTiles[nTiles];
+
+    for (int k = 0; k < nTiles; k++)
+        visibleTiles[k] = k;
+    runFrame(*terrainTiles, visibleTiles, nTiles);
+    delete terrainTiles; // (must join the worker thread)
+
+    const int nEvaluations = nStreamedEvaluations;
+    this_thread::sleep_for(chrono::milliseconds(20));
+    const bool isStopped = (nStreamedEvaluations == nEvaluations);
+
+    printf("%-24s %s\n", "stopping", isStopped ? "ok" : "FAILED");
+    return !isStopped;
+}
+
+
+int main(int argc, char **argv)
+{
+    const TerrainTiles flat(flatPositionAndPartials, nTestTilesPerSide);
+    const TerrainTiles parabolic(parabolicPositionAndPartials,
+                                 nTestTilesPerSide);
+    const TerrainTiles hilly(hillyPositionAndPartials, nTestTilesPerSide);
+    int nFailures = 0;
+
+    // (a corner tile and an interior one of each)
+    for (int iTile = 0; iTile < 6; iTile += 5) {
+        nFailures += (checkTile("flat", flat, iTile, true, false) != 0);
+        nFailures += (checkTile("parabolic", parabolic, iTile, false, true)
+                      != 0);
+        nFailures += (checkTile("hilly", hilly, iTile, false, false) != 0);
+    }
+    nFailures += (checkLodSelection(parabolic) != 0);
+    nFailures += (checkLodIndices() != 0);
+    nFailures += (checkDownloadLimit() != 0);
+    nFailures += (checkSlotReuse() != 0);
+    nFailures += checkStopping();
+
+    if (nFailures > 0) {
+        fprintf(stderr, "%d failures\n", nFailures);
+        exit(EXIT_FAILURE);
+    }
+}
+#endif // TEST
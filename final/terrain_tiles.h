@@ -0,0 +1,158 @@
+#ifndef INCLUDED_TERRAIN_TILES
+
+//
+// The "terrain_tiles" module provides the TerrainTiles class (see
+// below).
+//
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "geometry.h"
+
+using namespace std;
+
+enum {
+    TERRAIN_TILE_QUADS = 32, // quads along each side of a tile at full detail
+    N_TERRAIN_LODS = 6, // TERRAIN_TILE_QUADS, ..., 2, 1 quads a side
+
+    // the full-detail grid plus a copy of each edge (for the skirt)
+    TERRAIN_TILE_VERTICES = (TERRAIN_TILE_QUADS + 1) * (TERRAIN_TILE_QUADS + 1)
+        + 4 * (TERRAIN_TILE_QUADS + 1),
+};
+
+// A tile is drawn at the coarsest level whose error is within this
+// many pixels on the screen.
+const double TERRAIN_LOD_MAX_SCREEN_ERROR = 1.0;
+
+//
+// A tile only coarsens once the next level's error would be this many
+// times within the tolerance, so tiles near the threshold don't switch
+// levels on alternate frames.
+//
+const double TERRAIN_LOD_HYSTERESIS = 1.5;
+
+//
+// A streaming Terrain downloads at most this many newly built tiles to
+// the GPU per frame, so loading doesn't stall the frames it happens in.
+//
+const int TERRAIN_MAX_DOWNLOADS_PER_FRAME = 16;
+
+
+class TerrainTiles
+//
+// the CPU-side work of a Terrain (see the "terrain" module): building
+// the vertices of its tiles (with their errors and skirts), the
+// triangles of each level of detail, picking the level each tile is
+// drawn at, and (if it's streaming) deciding which tiles are loaded
+// into which of its slots
+//
+// Tiles sample `positionAndPartials`, a function of (u, v) from 0 to 1
+// like a HeightField's (so z = f(x, y), z up), on a grid of
+// `nTilesPerSide` x `nTilesPerSide` tiles. None of this needs OpenGL,
+// so it can be built (and tested) without it.
+//
+// Each frame, beginFrame() loads the tiles that have been built (which
+// the caller then downloads), markVisible() is called for each tile in
+// view, and endFrame() asks the worker thread of a streaming
+// TerrainTiles to build the visible tiles that aren't loaded.
+//
+{
+public:
+    enum TileState {
+        TILE_ABSENT,
+        TILE_REQUESTED, // (queued to be built)
+        TILE_BUILDING, // (or built, but not yet downloaded)
+        TILE_LOADED,
+    };
+
+    struct Tile {
+        TileState state;
+        int slot; // (if loaded)
+        int lastFrameVisible;
+        bool isVisible;
+        int iLod; // level drawn
+        Point3 center; // (model coordinates) of the tile's bounding sphere
+        double radius; // (conservative until the tile is loaded)
+        double errors[N_TERRAIN_LODS]; // (model coordinates) of each level
+    };
+
+    struct BuiltTile {
+        int iTile;
+        Point3 center;
+        double radius;
+        double errors[N_TERRAIN_LODS];
+        vector<Point3f> vertexPositions; // (TERRAIN_TILE_VERTICES of each)
+        vector<Vector3f> vertexNormals;
+    };
+
+protected:
+    const Point3 (*positionAndPartials)(const double u, const double v,
+                                        Vector3 &dp_du, Vector3 &dp_dv);
+    int nTilesPerSide;
+    vector<Tile> tiles; // row-major in j
+    int frameNumber; // (counts beginFrame()s)
+
+    int nSlots;
+    vector<int> tileOfSlot; // (NO_TILE if the slot is free)
+    vector< pair<double, int> > wantedTiles; // (priority, tile) this frame
+    int nLoadedVisible; // this frame
+    vector<int> lastRequests; // (as requestTiles() last queued them)
+
+    // These are shared with the worker thread (and `queueMutex` guards
+    // all but `worker`).
+    thread worker;
+    mutex queueMutex;
+    condition_variable requestsQueued;
+    deque<int> requests; // tiles to build, most wanted first
+    int iTileBuilding; // (NO_TILE if none)
+    deque<BuiltTile *> builtTiles; // waiting to be loaded
+    bool isStopping;
+
+    void loadTile(const BuiltTile &builtTile, const int slot);
+
+private:
+    void buildTiles(void);
+    void requestTiles(void);
+
+public:
+    TerrainTiles(const Point3 (*positionAndPartials_)(
+                     const double u, const double v,
+                     Vector3 &dp_du, Vector3 &dp_dv),
+                 const int nTilesPerSide_);
+    TerrainTiles(const Point3 (*positionAndPartials_)(
+                     const double u, const double v,
+                     Vector3 &dp_du, Vector3 &dp_dv),
+                 const int nTilesPerSide_,
+                 const int nSlots_, const double zMin, const double zMax);
+    virtual ~TerrainTiles();
+
+    void beginFrame(vector<BuiltTile *> &loadedTiles);
+    void buildTile(const int iTile, BuiltTile &builtTile) const;
+    void endFrame(void);
+    const bool isIdle(void);
+    static void lodIndices(const int iLod, vector<unsigned short> &indices);
+    void markVisible(const int iTile, const double pixelsPerUnit);
+    static const int selectLod(const double errors[N_TERRAIN_LODS],
+                               int iLod, const double pixelsPerUnit);
+
+    const bool isStreaming(void) const
+    {
+        return worker.joinable();
+    };
+    const int nTiles(void) const
+    {
+        return tiles.size();
+    };
+    const Tile &operator[](const int iTile) const
+    {
+        return tiles[iTile];
+    };
+};
+
+#define INCLUDED_TERRAIN_TILES
+#endif // INCLUDED_TERRAIN_TILES
@@ -6,12 +6,37 @@
 
 #include "transform.h"
 
+//
+// Tessellation constructors that take vertex arrays either copy them
+// or "adopt" them. An adopted array must have been allocated with
+// newArray() (see the "arena" module) and now belongs to the
+// Tessellation, which deletes it when it's destroyed (unless an Arena
+// owns it), so the caller must not use it afterwards.
+//
+enum ArrayOwnership {
+    COPY_ARRAYS,
+    ADOPT_ARRAYS
+};
+
+//
+// Tessellations whose vertex data changes every frame can send it
+// through the Scene's StreamBuffer (see the "stream_buffer" module)
+// rather than keeping a buffer of their own. They must then call
+// updateBuffers() in every frame in which they're rendered.
+//
+enum VertexDataUsage {
+    STATIC_VERTEX_DATA,
+    STREAMED_VERTEX_DATA
+};
+
+
 class Tessellation
 //
 // a virtual class for all entities OpenGL knows how to draw directly
 //
 {
 public:
+    virtual ~Tessellation() { };
     virtual void allocateBuffers(void) = 0;
     // Transforms will be set in the draw() method.
     virtual const void render(void) = 0;
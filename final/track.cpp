@@ -22,9 +22,6 @@ using namespace std;
 //  intersect (or come close) to the track.
 //
 
-// approximate rail segment length (in NDC units)
-const double Track::approxRailSegmentLength = 0.04;
-
 // approximate separation (in NDC) between ties
 const double Track::approxTieSep = railSep;
 
@@ -37,6 +34,12 @@ const Vec3 Track::freq( 1.00,  2.00, 3.00);
 // (x, y, z) magnitudes of trigonometric curve
 const Vec3 Track::mag( 0.80,  0.80, 0.20);
 
+// maximum distance (in NDC units) between a rail and its segments
+const double Track::maxRailChordError = 0.125 * Track::radius;
+
+// maximum rail segment length (in NDC units)
+const double Track::maxRailSegmentLength = 0.08;
+
 // number of supports
 const int Track::nSupports = 15;
 
@@ -118,6 +121,7 @@ void Track::addSupports(const double maxHeight, const Ground *ground)
 
           // create the line segment
           LineSegment *segment = new LineSegment(bottom, top, neverParallel);
+          segmentCurves.push_back(segment);
 
           // get ni and nj
           int nJMax = 10;
@@ -191,6 +195,7 @@ void Track::addTies()
         // works for the neverparallel
         Vector3 neverParallel(0, 0, 1);
         LineSegment *segment = new LineSegment(l, r, neverParallel);
+        segmentCurves.push_back(segment);
 
         int ni = nTheta;
         int nj = 4;
@@ -205,81 +210,58 @@ void Track::addTies()
 }
 
 
-void Track::display(const Transform &viewProjectionTransform,
+void Track::display(const FrameContext &frameContext,
                     Transform worldTransform)
 {
+    // Tubes are tessellated the first time they're drawn.
+    ArenaScope arenaScope(arena);
+
     // set matrix transform
-    scene->eadsShaderProgram->setModelViewProjectionMatrix(
-        viewProjectionTransform * worldTransform);
     scene->eadsShaderProgram->setWorldMatrix(worldTransform);
     scene->eadsShaderProgram->setNormalMatrix(
         worldTransform.getNormalTransform());
 
     // set support attributes
-    Rgb trackRgb(0.39, 0.00, 0.39);
-    Rgb whiteRgb(1.0, 1.0, 1.0);
-
-    scene->eadsShaderProgram->setEmittance(blackColor);
-    scene->eadsShaderProgram->setDiffuse(0.4 * trackRgb);
-    scene->eadsShaderProgram->setAmbient(0.4 * trackRgb);
-    scene->eadsShaderProgram->setSpecular(0.4 * whiteRgb, 40.0);
+    scene->eadsShaderProgram->setMaterial(supportMaterial);
     scene->eadsShaderProgram->start();
 
     // draw supports;
     for (unsigned int i = 0; i < supportTubes.size(); i++)
-        supportTubes[i]->draw(this);
+        supportTubes[i]->drawLod(this, frameContext, worldTransform);
 
-    // set tie attributes
-    scene->eadsShaderProgram->setEmittance(blackColor);
-    scene->eadsShaderProgram->setDiffuse(0.4 * trackRgb);
-    scene->eadsShaderProgram->setAmbient(0.4 * trackRgb);
-    scene->eadsShaderProgram->setSpecular(0.4 * whiteRgb, 40.0);
-    scene->eadsShaderProgram->start();
-
-    // draw ties
+    // draw ties (which share the support attributes)
     for (unsigned int i = 0; i < tieTubes.size(); i++)
-        tieTubes[i]->draw(this);
+        tieTubes[i]->drawLod(this, frameContext, worldTransform);
 
     // set rail attributes
-
-    // Here are some reflectance choices for metallic-looking
-    // rails. Pick one (or make up your own):
-#  if 1 // CUSTOM
-    const Rgb kAmbient(0.1, 0.1, 0.1);
-    const Rgb kDiffuse(0.1, 0.1, 0.1);
-    const Rgb kSpecular(0.1, 0.1, 0.1);
-    const double expoSpecular = 27.8974;
-#  elif   0 // chrome
-    const Rgb kAmbient(0.25, 0.25,   0.25);
-    const Rgb kDiffuse(0.4,  0.4,  0.4);
-    const Rgb kSpecular(0.75, 0.75, 0.75);
-    const double expoSpecular = 75.0;
-#  elif 0 // brass
-    const Rgb kAmbient(0.329412, 0.223529, 0.027451);
-    const Rgb kDiffuse(0.780392, 0.568627, 0.027451);
-    const Rgb kSpecular(0.992157, 0.941176, 0.807843);
-    const double expoSpecular = 27.8974;
-#  elif 0 // copper
-    const Rgb kAmbient(0.19125, 0.0735,   0.0225);
-    const Rgb kDiffuse(0.7038,  0.27048,  0.0828);
-    const Rgb kSpecular(0.25677, 0.137622, 0.086014);
-    const double expoSpecular = 12.8;
-#  endif
-    scene->eadsShaderProgram->setEmittance(blackColor);
-    scene->eadsShaderProgram->setDiffuse(kDiffuse);
-    scene->eadsShaderProgram->setAmbient(kAmbient);
-    scene->eadsShaderProgram->setSpecular(kSpecular, expoSpecular);
+    scene->eadsShaderProgram->setMaterial(railMaterial);
     scene->eadsShaderProgram->start();
 
+    //
     // draw rail(s)
-    leftRailTube->draw(this);
-    rightRailTube->draw(this);
+    //
+    // The rails run the length of the track, so most of them are
+    // usually far from the camera and can be drawn with far fewer
+    // triangles than their nominal tessellation. (Hedgehogs, though,
+    // are those of the nominal one, so it's still made.) Otherwise,
+    // like the supports and ties, they're drawn at a discrete level of
+    // detail.
+    //
+    if (controller.adaptiveTessellationEnabled) {
+        leftRailTube->tessellateOnce(this);
+        rightRailTube->tessellateOnce(this);
+        leftRailTube->drawAdaptively(frameContext, worldTransform);
+        rightRailTube->drawAdaptively(frameContext, worldTransform);
+    } else {
+        leftRailTube->drawLod(this, frameContext, worldTransform);
+        rightRailTube->drawLod(this, frameContext, worldTransform);
+    }
 
     // draw hedgehogs
 
     // all track-related quills are drawn with this length
     double quillLength = 0.002;
-    displayHedgehogs(viewProjectionTransform, worldTransform, quillLength);
+    displayHedgehogs(frameContext, worldTransform, quillLength);
 }
 
 
@@ -358,7 +340,7 @@ const double Track::speed(double u) const
 
 
 Track::Track(const Layout layout, const Ground *ground)
- : SceneObject()
+ : SceneObject(), arena(new Arena())
 {
     //
     // ASSIGNMENT (PA09)
@@ -385,6 +367,7 @@ Track::Track(const Layout layout, const Ground *ground)
     Vector3 leftOffset = (0.4 * railSep) * uDirection;
     Vector3 rightOffset = (-0.4 * railSep) * uDirection;
 
+    ArenaScope arenaScope(arena);
     setGuideCurve(layout);
 
     zMax = guideCurve->zMax();
@@ -393,11 +376,79 @@ Track::Track(const Layout layout, const Ground *ground)
     leftRailCurve = new OffsetCurve( guideCurve, leftOffset, neverParallel );
     rightRailCurve = new OffsetCurve( guideCurve, rightOffset, neverParallel );
 
-    // get nRailSegments
-    int nRailSegments = guideCurve->length() / approxRailSegmentLength;
+    //
+    // Place the rail segments by the guide curve's curvature, so
+    // they're short in tight turns and long on straightaways. (The
+    // rails are close enough to the guide curve to share them, but
+    // their banking isn't accounted for, which is one reason for the
+    // maximum segment length.)
+    //
+    vector<double> railUs = guideCurve->chordParameters(maxRailChordError,
+                                                        maxRailSegmentLength);
 
-    leftRailTube = new Tube(leftRailCurve, radius, nTheta, nRailSegments, true);
-    rightRailTube = new Tube(rightRailCurve, radius, nTheta, nRailSegments, true);
+    leftRailTube = new Tube(leftRailCurve, radius, nTheta, railUs, true);
+    rightRailTube = new Tube(rightRailCurve, radius, nTheta, railUs, true);
+
+    // set support (and tie) attributes
+    Rgb trackRgb(0.39, 0.00, 0.39);
+    Rgb whiteRgb(1.0, 1.0, 1.0);
+
+    supportMaterial = new Material(blackColor,
+                                   0.4 * trackRgb,
+                                   0.4 * trackRgb,
+                                   0.4 * whiteRgb, 40.0);
+
+    // set rail attributes
+
+    // Here are some reflectance choices for metallic-looking
+    // rails. Pick one (or make up your own):
+#  if 1 // CUSTOM
+    const Rgb kAmbient(0.1, 0.1, 0.1);
+    const Rgb kDiffuse(0.1, 0.1, 0.1);
+    const Rgb kSpecular(0.1, 0.1, 0.1);
+    const double expoSpecular = 27.8974;
+#  elif   0 // chrome
+    const Rgb kAmbient(0.25, 0.25,   0.25);
+    const Rgb kDiffuse(0.4,  0.4,  0.4);
+    const Rgb kSpecular(0.75, 0.75, 0.75);
+    const double expoSpecular = 75.0;
+#  elif 0 // brass
+    const Rgb kAmbient(0.329412, 0.223529, 0.027451);
+    const Rgb kDiffuse(0.780392, 0.568627, 0.027451);
+    const Rgb kSpecular(0.992157, 0.941176, 0.807843);
+    const double expoSpecular = 27.8974;
+#  elif 0 // copper
+    const Rgb kAmbient(0.19125, 0.0735,   0.0225);
+    const Rgb kDiffuse(0.7038,  0.27048,  0.0828);
+    const Rgb kSpecular(0.25677, 0.137622, 0.086014);
+    const double expoSpecular = 12.8;
+#  endif
+    railMaterial = new Material(blackColor, kAmbient, kDiffuse,
+                                kSpecular, expoSpecular);
+}
+
+
+Track::~Track()
+{
+    // The hedgehogs' arrays are in `arena`, so they must go first.
+    deleteHedgehogs();
+
+    for (unsigned int i = 0; i < supportTubes.size(); i++)
+        delete supportTubes[i];
+    for (unsigned int i = 0; i < tieTubes.size(); i++)
+        delete tieTubes[i];
+    for (unsigned int i = 0; i < segmentCurves.size(); i++)
+        delete segmentCurves[i];
+    delete leftRailTube;
+    delete rightRailTube;
+    delete leftRailCurve;
+    delete rightRailCurve;
+    delete guideCurve;
+    delete railMaterial;
+    delete supportMaterial;
+
+    // releases all of the Track's geometry arrays at once
+    delete arena;
 }
 
 
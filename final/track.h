@@ -6,8 +6,10 @@
 
 using namespace std;
 
+#include "arena.h"
 #include "curve.h"
 #include "ground.h"
+#include "material.h"
 #include "scene_object.h"
 #include "tube.h"
 
@@ -33,6 +35,10 @@ class Track : public SceneObject
 //
 {
 private:
+    // all of the Track's geometry arrays (including its tessellations,
+    // which are done lazily in display()) are allocated from this
+    Arena *arena;
+
     // These rail curves are now attributes.
     OffsetCurve *leftRailCurve;
     OffsetCurve *rightRailCurve;
@@ -42,17 +48,24 @@ private:
     Tube *rightRailTube;
     vector<Tube *> supportTubes;
     vector<Tube *> tieTubes;
+    vector<Curve *> segmentCurves; // paths of `supportTubes` and `tieTubes`
+
+    // materials
+    Material *railMaterial;
+    Material *supportMaterial; // also used for ties
 
     // track design parameters
 
-    static const double approxRailSegmentLength;
-    // = approximate rail segment length (in NDC units)
     static const double approxTieSep;
     // = approximate separation (in NDC units) between ties
     static const Vec3 freq;
     // = (x, y, z) frequencies of the trigonometric guide curve
     static const Vec3 mag;
     // = (x, y, z) magnitudes of the trigonometric guide curve
+    static const double maxRailChordError;
+    // = maximum distance (in NDC units) between a rail and its segments
+    static const double maxRailSegmentLength;
+    // = maximum rail segment length (in NDC units)
     static const int nSupports;
     // = number of supports
     static const int nRailSegmentsPerTie;
@@ -74,7 +87,7 @@ public:
     void addTies(void);
 
 private:
-    void display(const Transform &viewProjectionTransform,
+    void display(const FrameContext &frameContext,
                  Transform worldTransform);
 
 private:
@@ -85,6 +98,7 @@ public:
     double zMax; // maximum z value of track
 
     Track(const Layout layout, const Ground *ground);
+    ~Track();
     const double integrationStep(int &nU) const;
     const int numberOfTies(void) const;
     //
@@ -1,54 +1,303 @@
 #include "geometry.h"
+#include "matrix_kernels.h"
 #include "transform.h"
 #include "wrap_cmath_inclusion.h"
 
+//
+// how far (in units of the scalar type's epsilon) the columns of a
+// Transform's upper left 3x3 may be from orthonormal for it to be
+// treated as a RIGID_TRANSFORM
+//
+static const double RIGID_TOLERANCE_IN_EPSILONS = 1.0e3;
+
 
-const Transform Transform::getNormalTransform(void) const
+template <class Scalar>
+static Scalar cofactors(const Matrix4T<Scalar> &m, Scalar cof[3][3])
+//
+// helper: fills `cof` with the cofactors of the upper left 3x3 of `m`
+// and returns its determinant
+//
 {
-    Transform result = this->inverse().transpose();
-    // set 3rd row and column to match identity values
-    for (int i = 0; i <= 3; i++) {
-        result.a[ij(3,i)] = result.a[ij(i,3)] = (i == 3);
+    for (int i = 0; i < 3; i++) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            // (Cycling the indices takes care of the cofactor signs.)
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            cof[i][j] = m.a[m.ij(i1,j1)] * m.a[m.ij(i2,j2)]
+                      - m.a[m.ij(i1,j2)] * m.a[m.ij(i2,j1)];
+        }
     }
-    return result;
-};
+    return m.a[m.ij(0,0)] * cof[0][0]
+         + m.a[m.ij(0,1)] * cof[0][1]
+         + m.a[m.ij(0,2)] * cof[0][2];
+}
 
 
-const Point3 Transform::operator*(const Point3 &point3) const
+template <class Scalar>
+void TransformT<Scalar>::classify(void)
+//
+// sets `kind` to the least general TransformKind that fits the matrix
+//
 {
-    Point3 result;
+    normalMatrixIsValid = false;
+
+    // Products of affine matrices keep this row exactly.
+    if (a[ij(3,0)] != 0.0 || a[ij(3,1)] != 0.0 || a[ij(3,2)] != 0.0
+            || a[ij(3,3)] != 1.0) {
+        kind = PROJECTIVE_TRANSFORM;
+        return;
+    }
 
-    // We don't need i == 3 as 4th dimension of resulting point is
-    // implicitly 1.
+    bool isIdentity = true;
     for (int i = 0; i < 3; i++) {
-        // As the 4th dimension of `point3` is implicitly 1. We can
-        // initialize the sum to the last column of a[].
-        result.u.a[i] = a[ij(i,3)];
-        for (int j = 0; j < 3; j++)
-            result.u.a[i] += a[ij(i,j)] * point3.u.a[j];
+        for (int j = 0; j < 4; j++) {
+            if (a[ij(i,j)] != (i == j))
+                isIdentity = false;
+        }
     }
-    return result;
+    if (isIdentity) {
+        kind = IDENTITY_TRANSFORM;
+        return;
+    }
+
+    // rigid iff the columns of the upper left 3x3 are orthonormal
+    kind = RIGID_TRANSFORM;
+    for (int j = 0; j < 3; j++) {
+        for (int k = j; k < 3; k++) {
+            Scalar dot = 0.0;
+            for (int i = 0; i < 3; i++)
+                dot += a[ij(i,j)] * a[ij(i,k)];
+            Scalar tolerance = RIGID_TOLERANCE_IN_EPSILONS
+                * ScalarTraits<Scalar>::epsilon();
+            if (fabs(dot - (j == k)) > tolerance) {
+                kind = AFFINE_TRANSFORM;
+                return;
+            }
+        }
+    }
+}
+
+
+template <class Scalar>
+void TransformT<Scalar>::concatenate(const Matrix4T<Scalar> &matrix4,
+                                     const TransformKind matrixKind)
+//
+// helper: right-multiplies the transform by `matrix4`, which is known
+// to be of kind `matrixKind`
+//
+{
+    TransformKind resultKind = kind > matrixKind ? kind : matrixKind;
+
+    (*this) = TransformT(
+        *static_cast<const Matrix4T<Scalar> *>(this) * matrix4, resultKind);
+}
+
+
+template <class Scalar>
+void TransformT<Scalar>::updateKind(const TransformKind operationKind)
+//
+// helper: called after the transform has been modified in place by
+// an operation of kind `operationKind`
+//
+{
+    if (operationKind > kind)
+        kind = operationKind;
+    normalMatrixIsValid = false;
+}
+
+
+template <class Scalar>
+const TransformT<Scalar> TransformT<Scalar>::getNormalTransform(void) const
+//
+// returns the transform to apply to normals: the inverse transpose of
+// the upper left 3x3, with an identity 4th row and column
+//
+{
+    if (!normalMatrixIsValid) {
+        if (kind == IDENTITY_TRANSFORM || kind == RIGID_TRANSFORM) {
+            // (R^-1)^T == R for a rotation R
+            normalMatrix = *this;
+        } else if (kind == AFFINE_TRANSFORM) {
+            // (M^-1)^T is the matrix of cofactors over the determinant.
+            Scalar cof[3][3];
+            Scalar det = cofactors(*this, cof);
+            // otherwise, assume singular
+            assert(fabs(det) > ScalarTraits<Scalar>::epsilon());
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++)
+                    normalMatrix.a[ij(i,j)] = cof[i][j] / det;
+            }
+        } else {
+            normalMatrix = Matrix4T<Scalar>::inverse().transpose();
+        }
+        // set 3rd row and column to match identity values
+        for (int i = 0; i <= 3; i++) {
+            normalMatrix.a[ij(3,i)] = normalMatrix.a[ij(i,3)] = (i == 3);
+        }
+        normalMatrixIsValid = true;
+    }
+    return TransformT(normalMatrix,
+                      kind <= RIGID_TRANSFORM ? kind : AFFINE_TRANSFORM);
 };
 
 
-const Vector3 Transform::operator*(const Vector3 &vector3) const
+template <class Scalar>
+const Scalar TransformT<Scalar>::maxScale(void) const
+//
+// returns the largest factor by which the transform scales the length
+// of an axis (which, for a similarity transform, is its scale factor)
+//
+{
+    Scalar result = 0;
+    for (int j = 0; j < 3; j++) {
+        Vector3T<Scalar> column(a[ij(0,j)], a[ij(1,j)], a[ij(2,j)]);
+        if (column.mag() > result)
+            result = column.mag();
+    }
+    return result;
+}
+
+
+template <class Scalar>
+TransformT<Scalar> TransformT<Scalar>::inverse(void) const
+//
+// returns the inverse transform, using the shortcut that fits `kind`
+//
 {
-    Vector3 result;
+    if (kind == IDENTITY_TRANSFORM)
+        return *this;
+    else if (kind == PROJECTIVE_TRANSFORM)
+        return TransformT(Matrix4T<Scalar>::inverse(), PROJECTIVE_TRANSFORM);
 
-    // We don't need i == 3 as 4th dimension of resulting vector is
-    // implicitly 0.
+    //
+    // In the rigid and affine cases, the inverse of [ M t ; 0 1 ] is
+    // [ M^-1 -M^-1*t ; 0 1 ], where M^-1 is the transpose of M if M
+    // is a rotation.
+    //
+    TransformT result(*this, kind);
+    if (kind == RIGID_TRANSFORM) {
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++)
+                result.a[ij(i,j)] = a[ij(j,i)];
+        }
+    } else {
+        Scalar cof[3][3];
+        Scalar det = cofactors(*this, cof);
+        // otherwise, assume singular
+        assert(fabs(det) > ScalarTraits<Scalar>::epsilon());
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++)
+                result.a[ij(i,j)] = cof[j][i] / det;
+        }
+    }
     for (int i = 0; i < 3; i++) {
-        result.u.a[i] = 0.0;
-        // We don't need j == 3 as 4th dimension of
-        // `vector3`vector is implicitly 0.
+        result.a[ij(i,3)] = 0.0;
         for (int j = 0; j < 3; j++)
-            result.u.a[i] += a[ij(i,j)] * vector3.u.a[j];
+            result.a[ij(i,3)] -= result.a[ij(i,j)] * a[ij(j,3)];
     }
     return result;
+}
+
+
+template <class Scalar>
+const TransformT<Scalar> TransformT<Scalar>::operator*(
+    const TransformT &transform) const
+{
+    // Multiplying by the identity (e.g. an initial world transform)
+    // is common enough to be worth skipping.
+    if (kind == IDENTITY_TRANSFORM)
+        return transform;
+    if (transform.kind == IDENTITY_TRANSFORM)
+        return *this;
+
+    TransformKind resultKind = kind > transform.kind ? kind : transform.kind;
+    return TransformT(
+        *static_cast<const Matrix4T<Scalar> *>(this) * transform, resultKind);
+}
+
+
+template <class Scalar>
+const Point3T<Scalar> TransformT<Scalar>::operator*(
+    const Point3T<Scalar> &point3) const
+{
+    Point3T<Scalar> result;
+
+    transformPoints(&point3, &result, 1);
+    return result;
 };
 
 
-void Transform::rotate(const double angle, const Vector3 &direction)
+template <class Scalar>
+const Vector3T<Scalar> TransformT<Scalar>::operator*(
+    const Vector3T<Scalar> &vector3) const
+{
+    Vector3T<Scalar> result;
+
+    transformVectors(&vector3, &result, 1);
+    return result;
+};
+
+
+template <class Scalar>
+void TransformT<Scalar>::transformPoints(const Point3T<Scalar> points[],
+                                         Point3T<Scalar> result[],
+                                         const int n) const
+//
+// sets `result[i]` to the transform of `points[i]` for 0 <= `i` <
+// `n`, which is faster than transforming them one at a time
+// (`result` may be `points`)
+//
+{
+    for (int k = 0; k < n; k++) {
+        Scalar x = points[k].u.g.x, y = points[k].u.g.y, z = points[k].u.g.z;
+        for (int i = 0; i < 3; i++)
+            result[k].u.a[i] = a[i]*x + a[4+i]*y + a[8+i]*z + a[12+i];
+    }
+}
+
+
+template <class Scalar>
+void TransformT<Scalar>::transformVectors(const Vector3T<Scalar> vectors[],
+                                          Vector3T<Scalar> result[],
+                                          const int n) const
+//
+// like transformPoints(), but for Vector3s
+//
+{
+    for (int k = 0; k < n; k++) {
+        Scalar x = vectors[k].u.g.x, y = vectors[k].u.g.y,
+            z = vectors[k].u.g.z;
+        for (int i = 0; i < 3; i++)
+            result[k].u.a[i] = a[i]*x + a[4+i]*y + a[8+i]*z;
+    }
+}
+
+
+//
+// Double precision transforms use the "matrix_kernels" module, which
+// has SIMD versions of the loops above.
+//
+template <>
+void TransformT<double>::transformPoints(const Point3 points[],
+                                         Point3 result[],
+                                         const int n) const
+{
+    transformPoint3s(a, points, result, n);
+}
+
+
+template <>
+void TransformT<double>::transformVectors(const Vector3 vectors[],
+                                          Vector3 result[],
+                                          const int n) const
+{
+    transformVector3s(a, vectors, result, n);
+}
+
+
+template <class Scalar>
+void TransformT<Scalar>::rotate(const Scalar angle,
+                                const Vector3T<Scalar> &direction)
 //
 // rotates the transform by `angle` around `direction`
 //
@@ -62,11 +311,35 @@ void Transform::rotate(const double angle, const Vector3 &direction)
     // self test ("-DTEST"), code for which is included at the end of
     // this file.
     //
-    Vector3 vU = direction.normalized();
-    double cosA = cos(angle);
-    double sinA = sin(angle);
-    Matrix4 rotationMatrix;
-    double s[3][3] = {
+    Scalar cosA = cos(angle);
+    Scalar sinA = sin(angle);
+
+    //
+    // Rotations around the x, y, or z axis (by far the most common)
+    // only mix two columns of the matrix, which we can do in place.
+    //
+    for (int iAxis = 0; iAxis < 3; iAxis++) {
+        int j = (iAxis + 1) % 3;
+        int k = (iAxis + 2) % 3;
+        if (direction.u.a[j] != 0.0 || direction.u.a[k] != 0.0)
+            continue;
+        assert(direction.u.a[iAxis] != 0.0);
+        if (direction.u.a[iAxis] < 0.0)
+            sinA = -sinA;
+        for (int i = 0; i < 4; i++) {
+            Scalar m_ij = a[ij(i,j)];
+            Scalar m_ik = a[ij(i,k)];
+            a[ij(i,j)] =  cosA * m_ij + sinA * m_ik;
+            a[ij(i,k)] = -sinA * m_ij + cosA * m_ik;
+        }
+        updateKind(RIGID_TRANSFORM);
+        return;
+    }
+
+    // Otherwise, fall back on a general rotation matrix.
+    Vector3T<Scalar> vU = direction.normalized();
+    Matrix4T<Scalar> rotationMatrix;
+    Scalar s[3][3] = {
         {         0, -vU.u.g.z,  vU.u.g.y },
         {  vU.u.g.z,         0, -vU.u.g.x },
         { -vU.u.g.y,  vU.u.g.x,         0 },
@@ -76,21 +349,22 @@ void Transform::rotate(const double angle, const Vector3 &direction)
     // documentation.
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
-            double I_ij = (i == j); // identity matrix
+            Scalar I_ij = (i == j); // identity matrix
             if (i >= 3 || j >= 3) {
                 rotationMatrix.a[ij(i, j)] = I_ij;
             } else {
-                double u_uT_ij = vU.u.a[i]*vU.u.a[j];
+                Scalar u_uT_ij = vU.u.a[i]*vU.u.a[j];
                 rotationMatrix.a[ij(i, j)] = u_uT_ij
                     + cosA * (I_ij - u_uT_ij) + sinA * s[i][j];
             };
         };
     };
-    (*this) = (*this) * rotationMatrix;
+    concatenate(rotationMatrix, RIGID_TRANSFORM);
 }
 
 
-void Transform::scale(const Vector3 &factor)
+template <class Scalar>
+void TransformT<Scalar>::scale(const Vector3T<Scalar> &factor)
 //
 // scales the transform by `factor`
 //
@@ -100,40 +374,64 @@ void Transform::scale(const Vector3 &factor)
     // Remove these assertions if you ever find a good reason for
     // allowing them.
     //
-    assert(fabs(factor.u.a[0]) > EPSILON);
-    assert(fabs(factor.u.a[1]) > EPSILON);
-    assert(fabs(factor.u.a[2]) > EPSILON);
+    assert(fabs(factor.u.a[0]) > ScalarTraits<Scalar>::epsilon());
+    assert(fabs(factor.u.a[1]) > ScalarTraits<Scalar>::epsilon());
+    assert(fabs(factor.u.a[2]) > ScalarTraits<Scalar>::epsilon());
 
-    Matrix4 scaleMatrix(
-        factor.u.a[0], 0.0,           0.0,           0.0,
-        0.0,           factor.u.a[1], 0.0,           0.0,
-        0.0,           0.0,           factor.u.a[2], 0.0,
-        0.0,           0.0,           0.0,           1.0
-        );
-    (*static_cast<Matrix4 *>(this)) = (*this) * scaleMatrix;
+    // Right-multiplying by a scale matrix scales the first 3 columns.
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 4; i++)
+            a[ij(i,j)] *= factor.u.a[j];
+    }
+    updateKind(AFFINE_TRANSFORM);
 }
 
 
-void Transform::translate(const Vector3 offset) {
-    Matrix4 translateMatrix(
-        1.0, 0.0, 0.0, offset.u.a[0],
-        0.0, 1.0, 0.0, offset.u.a[1],
-        0.0, 0.0, 1.0, offset.u.a[2],
-        0.0, 0.0, 0.0, 1.0
-        );
-    (*this) *= translateMatrix;
+template <class Scalar>
+void TransformT<Scalar>::translate(const Vector3T<Scalar> offset) {
+    // Right-multiplying by a translation matrix only changes the 4th
+    // column.
+    for (int i = 0; i < 4; i++) {
+        a[ij(i,3)] += a[ij(i,0)] * offset.u.a[0]
+            + a[ij(i,1)] * offset.u.a[1]
+            + a[ij(i,2)] * offset.u.a[2];
+    }
+    updateKind(RIGID_TRANSFORM);
 }
 
 
+template class TransformT<double>;
+template class TransformT<float>;
+
+
 #ifdef TEST
 #include <iostream>
 using namespace std;
 #include <cstdlib>
 #include <cstring>
 
+static Matrix4 rotationMatrix(const double angle, const Vector3 &axis)
+//
+// returns the (general) rotation matrix for `angle` around `axis`,
+// to check the in-place Transform::rotate() against
+//
+{
+    Vector3 vU = axis.normalized();
+    double c = cos(angle), s = sin(angle), x = vU.u.g.x, y = vU.u.g.y,
+        z = vU.u.g.z;
+
+    return Matrix4(
+        x*x*(1-c) + c,   x*y*(1-c) - z*s, x*z*(1-c) + y*s, 0.0,
+        y*x*(1-c) + z*s, y*y*(1-c) + c,   y*z*(1-c) - x*s, 0.0,
+        z*x*(1-c) - y*s, z*y*(1-c) + x*s, z*z*(1-c) + c,   0.0,
+        0.0,             0.0,             0.0,             1.0);
+}
+
+
 int main(int argc, char **argv)
 {
     Transform t;
+    Matrix4 reference = t; // `t` built by generic 4x4 multiplies
 
     int i = 1;
     while (i < argc) {
@@ -146,6 +444,8 @@ int main(int argc, char **argv)
             double aZ = strtod(argv[i+4], NULL);
             i += 5;
             t.rotate(angle, aX, aY, aZ);
+            reference = reference * rotationMatrix(angle,
+                                                   Vector3(aX, aY, aZ));
         } else if (strcmp(argv[i], "-s") == 0) {
             // "s sX sY sZ" scales the transform by (sX, sY, sZ)
             double sX = strtod(argv[i+1], NULL);
@@ -153,6 +453,10 @@ int main(int argc, char **argv)
             double sZ = strtod(argv[i+3], NULL);
             i += 4;
             t.scale(sX, sY, sZ);
+            reference = reference * Matrix4(sX,  0.0, 0.0, 0.0,
+                                            0.0, sY,  0.0, 0.0,
+                                            0.0, 0.0, sZ,  0.0,
+                                            0.0, 0.0, 0.0, 1.0);
         } else if (strcmp(argv[i], "-t") == 0) {
             // "t tX tY tZ" translates the transform by (tX, tY, tZ)
             double tX = strtod(argv[i+1], NULL);
@@ -160,6 +464,10 @@ int main(int argc, char **argv)
             double tZ = strtod(argv[i+3], NULL);
             i += 4;
             t.translate(tX, tY, tZ);
+            reference = reference * Matrix4(1.0, 0.0, 0.0, tX,
+                                            0.0, 1.0, 0.0, tY,
+                                            0.0, 0.0, 1.0, tZ,
+                                            0.0, 0.0, 0.0, 1.0);
         } else {
             cerr << "unknown operation '" << argv[i] << "' -- exiting\n";
             exit(EXIT_FAILURE);
@@ -171,10 +479,60 @@ int main(int argc, char **argv)
     cout << "t:\n";
     cout << t << "\n";
 
+    // Check the in-place operations against plain multiplication.
+    double maxReferenceError = 0.0;
+    for (int i = 0; i < 16; i++) {
+        double referenceError = fabs(t.a[i] - reference.a[i]);
+        if (referenceError > maxReferenceError)
+            maxReferenceError = referenceError;
+    }
+    cout << "max. |t - t by matrix multiplication| = "
+         << maxReferenceError << "\n\n";
+    if (maxReferenceError > 1.0e-9) {
+        cerr << "in-place transform disagrees with matrix multiplication\n";
+        exit(EXIT_FAILURE);
+    }
+
 
 
     cout << "t.transpose():\n";
     cout << t.transpose() << "\n";
 
+    const char *kindNames[] = { "identity", "rigid", "affine", "projective" };
+    cout << "t is " << kindNames[t.getKind()] << "\n\n";
+
+    //
+    // Check the shortcut inverse and normal transforms against the
+    // general (pivoting) inverse.
+    //
+    Matrix4 generalInverse = static_cast<Matrix4 &>(t).inverse();
+    Matrix4 generalNormal = generalInverse.transpose();
+    Transform tInverse = t.inverse();
+    Transform tNormal = t.getNormalTransform();
+    double maxInverseError = 0.0, maxNormalError = 0.0;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            double inverseError = fabs(tInverse.a[t.ij(i,j)]
+                                       - generalInverse.a[t.ij(i,j)]);
+            if (inverseError > maxInverseError)
+                maxInverseError = inverseError;
+            if (i < 3 && j < 3) {
+                double normalError = fabs(tNormal.a[t.ij(i,j)]
+                                          - generalNormal.a[t.ij(i,j)]);
+                if (normalError > maxNormalError)
+                    maxNormalError = normalError;
+            }
+        }
+    }
+    cout << "t.inverse():\n";
+    cout << tInverse << "\n";
+    cout << "max. |t.inverse() - general inverse| = "
+         << maxInverseError << "\n";
+    cout << "max. |t.getNormalTransform() - general normal transform| = "
+         << maxNormalError << "\n";
+    if (maxInverseError > 1.0e-9 || maxNormalError > 1.0e-9) {
+        cerr << "shortcut inverse disagrees with general inverse\n";
+        exit(EXIT_FAILURE);
+    }
 }
 #endif // TEST
@@ -7,14 +7,49 @@
 #include "geometry.h"
 #include "vec.h"
 
-class Transform : public Matrix4
+//
+// kinds of Transform, in order of increasing generality (and cost to
+// invert)
+//
+enum TransformKind {
+    IDENTITY_TRANSFORM,  // leaves everything where it is
+    RIGID_TRANSFORM,     // rotations and translations only
+    AFFINE_TRANSFORM,    // bottom row is (0, 0, 0, 1)
+    PROJECTIVE_TRANSFORM // anything else
+};
+
+
+template <class Scalar>
+class TransformT : public Matrix4T<Scalar>
 //
 // linear transforms of Point3's and Vector3's
 //
+// Each Transform keeps track of its TransformKind so that inverse()
+// and getNormalTransform() can take shortcuts for the (common)
+// identity, rigid, and affine cases. It also remembers its normal
+// transform once it's been asked for it.
+//
 {
+    template <class OtherScalar> friend class TransformT;
+
+    TransformKind kind;
+    mutable Matrix4T<Scalar> normalMatrix; // valid iff `normalMatrixIsValid`
+    mutable bool normalMatrixIsValid;
+
+    TransformT(const Matrix4T<Scalar> &matrix4, const TransformKind kind_)
+        : Matrix4T<Scalar>(matrix4), kind(kind_), normalMatrixIsValid(false)
+    { };
+    void classify(void);
+    void concatenate(const Matrix4T<Scalar> &matrix4,
+                     const TransformKind matrixKind);
+    void updateKind(const TransformKind operationKind);
+
 public:
+    using Matrix4T<Scalar>::a;
+    using Matrix4T<Scalar>::ij;
 
-    Transform(void)
+    TransformT(void)
+        : kind(IDENTITY_TRANSFORM), normalMatrixIsValid(false)
     {
         // When instanced by default, Transforms differ from Matrix4's
         // in that all transform matrices start off as identity
@@ -25,61 +60,106 @@ public:
             };
         };
     };
-    Transform(const Matrix4 &matrix4)
+    TransformT(const Matrix4T<Scalar> &matrix4)
     {
         for (int i = 0; i < 4; i++) {
             for (int j = 0; j < 4; j++) {
                 a[ij(i,j)] = matrix4.a[ij(i, j)];
             };
         };
+        classify();
     }
     // see comment for the similar Matrix4 constructor.
-    Transform(
-        double m_1, double m_5, double  m_9, double m_13,
-        double m_2, double m_6, double m_10, double m_14,
-        double m_3, double m_7, double m_11, double m_15,
-        double m_4, double m_8, double m_12, double m_16)
+    TransformT(
+        Scalar m_1, Scalar m_5, Scalar  m_9, Scalar m_13,
+        Scalar m_2, Scalar m_6, Scalar m_10, Scalar m_14,
+        Scalar m_3, Scalar m_7, Scalar m_11, Scalar m_15,
+        Scalar m_4, Scalar m_8, Scalar m_12, Scalar m_16)
     {
         a[0] = m_1; a[4] = m_5; a[8]  =  m_9; a[12] = m_13;
         a[1] = m_2; a[5] = m_6; a[9]  = m_10; a[13] = m_14;
         a[2] = m_3; a[6] = m_7; a[10] = m_11; a[14] = m_15;
         a[3] = m_4; a[7] = m_8; a[11] = m_12; a[15] = m_16;
+        classify();
     };
+    // converts between precisions (keeping the kind)
+    template <class OtherScalar>
+    explicit TransformT(const TransformT<OtherScalar> &transform)
+        : Matrix4T<Scalar>(transform), kind(transform.kind),
+          normalMatrixIsValid(false)
+    { };
 
-    const Transform getNormalTransform(void) const;
+    const TransformKind getKind(void) const
+    {
+        return kind;
+    };
 
-    const Transform operator*(const Matrix4 &matrix4) const
+    const TransformT getNormalTransform(void) const;
+    TransformT inverse(void) const;
+    const Scalar maxScale(void) const;
+
+    const TransformT operator*(const Matrix4T<Scalar> &matrix4) const
     {
-        return Transform(*static_cast<const Matrix4 *>(this) * matrix4);
+        return TransformT(
+            *static_cast<const Matrix4T<Scalar> *>(this) * matrix4);
     };
 
-    const Transform operator*=(const Matrix4 &matrix4)
+    const TransformT operator*(const TransformT &transform) const;
+
+    const TransformT operator*=(const Matrix4T<Scalar> &matrix4)
     {
         return (*this) = (*this) * matrix4;
     };
 
-    const Vector3 operator*(const Vector3 &vector3) const;
+    const TransformT operator*=(const TransformT &transform)
+    {
+        return (*this) = (*this) * transform;
+    };
+
+    const Vector3T<Scalar> operator*(const Vector3T<Scalar> &vector3) const;
 
-    const Point3 operator*(const Point3 &point3) const;
+    const Point3T<Scalar> operator*(const Point3T<Scalar> &point3) const;
 
-    void rotate(const double angle, const Vector3 &direction);
-    void rotate(const double angle,
-                const double aX, const double aY, const double aZ) {
-        rotate(angle, Vector3(aX, aY, aZ));
+    void transformPoints(const Point3T<Scalar> points[],
+                         Point3T<Scalar> result[], const int n) const;
+    void transformVectors(const Vector3T<Scalar> vectors[],
+                          Vector3T<Scalar> result[], const int n) const;
+
+    void rotate(const Scalar angle, const Vector3T<Scalar> &direction);
+    void rotate(const Scalar angle,
+                const Scalar aX, const Scalar aY, const Scalar aZ) {
+        rotate(angle, Vector3T<Scalar>(aX, aY, aZ));
     };
 
-    void scale(const Vector3 &factor);
-    void scale(const double sX, const double sY, const double sZ) {
-        scale(Vector3(sX, sY, sZ));
+    void scale(const Vector3T<Scalar> &factor);
+    void scale(const Scalar sX, const Scalar sY, const Scalar sZ) {
+        scale(Vector3T<Scalar>(sX, sY, sZ));
     }
 
-    void translate(const Vector3 offset);
-    void translate(const double offX, const double offY, const double offZ)
+    void translate(const Vector3T<Scalar> offset);
+    void translate(const Scalar offX, const Scalar offY, const Scalar offZ)
     {
-        translate(Vector3(offX, offY, offZ));
+        translate(Vector3T<Scalar>(offX, offY, offZ));
     };
 };
 
+//
+// "Transform" is double precision. "Transformf" is handy for
+// transforming (single precision) vertex data.
+//
+typedef TransformT<double> Transform;
+typedef TransformT<float> Transformf;
+
+// (Double precision uses the "matrix_kernels" module.)
+template <>
+void TransformT<double>::transformPoints(const Point3T<double> points[],
+                                         Point3T<double> result[],
+                                         const int n) const;
+template <>
+void TransformT<double>::transformVectors(const Vector3T<double> vectors[],
+                                          Vector3T<double> result[],
+                                          const int n) const;
+
 
 #define INCLUDED_TRANSFORM
 #endif // INCLUDED_TRANSFORM
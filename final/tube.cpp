@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cassert>
 #include <iostream>
 using namespace std;
 
@@ -7,21 +9,93 @@ using namespace std;
 #include "tube.h"
 #include "wrap_cmath_inclusion.h"
 
+//
+// Each level of detail divides the number of sides and segments of the
+// nominal tessellation by (about) these factors.
+//
+static const int lodDivisors[N_TUBE_LODS] = { 1, 2, 3, 4 };
+
+
+Tube::Tube(Curve *curve_, double radius_, int nI_,
+           const vector<double> &ringUs_, bool isClosed_)
+    : Surface(nI_, ringUs_.size() - isClosed_, true, isClosed_),
+      curve(curve_), radius(radius_), ringUs(ringUs_),
+      iLod(0), boundRadius(0.0)
+//
+// creates a Tube with rings at the curve parameters `ringUs_` (from 0
+// to 1, inclusive, where the last ring of a closed Tube is also its
+// first), e.g. from Curve::chordParameters()
+//
+{
+    assert(ringUs.size() >= 2);
+    assert(ringUs.front() == 0.0 && ringUs.back() == 1.0);
+    for (int i = 0; i < N_TUBE_LODS; i++)
+        lodMeshes[i] = NULL;
+}
+
+
+Tube::~Tube()
+{
+    // (lodMeshes[0] is `tessellationMesh`, which ~Surface() deletes.)
+    for (int i = 1; i < N_TUBE_LODS; i++)
+        delete lodMeshes[i];
+}
+
+
+void Tube::drawLod(SceneObject *sceneObject, const FrameContext &frameContext,
+                   const Transform &worldTransform)
+//
+// draws the coarsest of the Tube's levels of detail whose error on the
+// screen is within TUBE_LOD_MAX_SCREEN_ERROR
+//
+{
+    tessellateOnce(sceneObject);
+
+    double worldScale = worldTransform.maxScale();
+    Point3 worldCenter = worldTransform * boundCenter;
+    double worldRadius = worldScale * boundRadius;
+
+    // If the Tube can't be seen, it doesn't matter which level we draw.
+    if (frameContext.sphereIsVisible(worldCenter, worldRadius)) {
+        // (pixels per model coordinate unit at the Tube's nearest point)
+        double pixelsPerUnit = worldScale
+            * frameContext.pixelsPerUnit(worldCenter, worldRadius);
+
+        while (iLod > 0
+               && lodErrors[iLod] * pixelsPerUnit > TUBE_LOD_MAX_SCREEN_ERROR)
+            iLod--;
+        while (iLod < N_TUBE_LODS - 1
+               && TUBE_LOD_HYSTERESIS * lodErrors[iLod + 1] * pixelsPerUnit
+                   <= TUBE_LOD_MAX_SCREEN_ERROR)
+            iLod++;
+    }
+    lodMeshes[iLod]->render();
+}
+
 
 const Point3 Tube::operator()(const double u, const double v,
         Vector3 &dp_du, Vector3 &dp_dv) const
 //
 // returns a Point3 on the surface of the tube. `u` maps to the
 // aziumuthal angle around the tube. `v` maps to the axial position
-// along the curve determined by the of the guiding curve. As
-// parameters. They both vary from 0 to 1.
+// along the curve determined by the of the guiding curve (through
+// `ringUs`, if it's set). As parameters. They both vary from 0 to 1.
 //
 {
     Point3 p;
     Vector3 vU, vW, vV;
 
+    // map `v` to the curve parameter
+    double curveU = v;
+    if (!ringUs.empty()) {
+        double t = v * (ringUs.size() - 1);
+        int j = min(static_cast<int>(t), static_cast<int>(ringUs.size()) - 2);
+
+        curveU = ringUs[j] + (t - j) * (ringUs[j + 1] - ringUs[j]);
+    }
+
     // get the transform from the coordinateFrame
-    Transform transform = curve->coordinateFrame(v);
+    Transform transform = curve->coordinateFrame(curveU);
 
     // get the angle still
     double u_a = 2 * M_PI * u;
@@ -41,3 +115,54 @@ const Point3 Tube::operator()(const double u, const double v,
 
     return p; // replace (permits template to compile cleanly)
 }
+
+
+void Tube::tessellateOnce(SceneObject *sceneObject)
+//
+// creates the Tube's levels of detail, adding the hedgehogs of the
+// nominal one to `sceneObject`, unless that's already been done
+//
+{
+    if (!lodMeshes[0])
+        tessellateLods(sceneObject);
+}
+
+
+void Tube::tessellateLods(SceneObject *sceneObject)
+//
+// helper: creates the Tube's levels of detail and its bounding sphere
+//
+{
+    // The finest level is the nominal tessellation (with hedgehogs).
+    tessellate();
+    sceneObject->addHedgehogs(tessellationMesh);
+    lodMeshes[0] = tessellationMesh;
+    lodErrors[0] = 0.0;
+
+    Point3 pMin(tessellationMesh->vertexPositions[0]);
+    Point3 pMax = pMin;
+    for (int k = 1; k < tessellationMesh->nVertices; k++) {
+        Point3 p(tessellationMesh->vertexPositions[k]);
+
+        for (int c = 0; c < 3; c++) {
+            pMin.u.a[c] = min(pMin.u.a[c], p.u.a[c]);
+            pMax.u.a[c] = max(pMax.u.a[c], p.u.a[c]);
+        }
+    }
+    boundCenter = pMin + 0.5 * (pMax - pMin);
+    boundRadius = 0.5 * (pMax - pMin).mag();
+
+    for (int k = 1; k < N_TUBE_LODS; k++) {
+        // (at least a triangular cross-section)
+        int nILod = max(nI / lodDivisors[k], 3);
+        int nJLod;
+
+        if (wrapJ)
+            nJLod = max(nJ / lodDivisors[k], 3);
+        else // (at least one segment)
+            nJLod = max((nJ - 1) / lodDivisors[k], 1) + 1;
+
+        lodMeshes[k] = tessellation(nILod, nJLod);
+        lodErrors[k] = tessellationError(nILod, nJLod);
+    }
+}
@@ -5,9 +5,29 @@
 //
 
 #include "curve.h"
+#include "frame_context.h"
 #include "surface.h"
 #include "regular_mesh.h"
+#include "scene_object.h"
 #include "shader_programs.h"
+#include "transform.h"
+
+enum {
+    N_TUBE_LODS = 4 // levels of detail (including the nominal one)
+};
+
+//
+// the most error (in pixels) that a Tube's level of detail may have
+// on the screen
+//
+const double TUBE_LOD_MAX_SCREEN_ERROR = 1.0;
+
+//
+// A Tube only switches to a coarser level of detail when that level's
+// error is this factor within the tolerance, so a Tube whose error is
+// near the tolerance doesn't pop back and forth between levels.
+//
+const double TUBE_LOD_HYSTERESIS = 1.5;
 
 class Tube : public Surface
 //
@@ -16,14 +36,48 @@ class Tube : public Surface
 {
     Curve *curve;
     double radius;
+
+    //
+    // the curve parameters of the rings of vertices (evenly spaced if
+    // empty): ring `j` is at `ringUs[j]`, and `v` is interpolated
+    // linearly between rings
+    //
+    vector<double> ringUs;
+
+    //
+    // levels of detail, from finest (the nominal tessellation, which is
+    // `tessellationMesh`) to coarsest, and their (model coordinate)
+    // errors
+    //
+    RegularMesh *lodMeshes[N_TUBE_LODS];
+    double lodErrors[N_TUBE_LODS];
+    int iLod; // the level drawn last
+
+    // (model coordinate) bounding sphere
+    Point3 boundCenter;
+    double boundRadius;
+
+    void tessellateLods(SceneObject *sceneObject);
 public:
 
 Tube(Curve *curve_, double radius_, int nI_, int nJ_, bool isClosed_)
-    : Surface(nI_, nJ_, true, isClosed_), curve(curve_), radius(radius_)
+    : Surface(nI_, nJ_, true, isClosed_), curve(curve_), radius(radius_),
+      iLod(0), boundRadius(0.0)
     {
-        tessellationMesh = NULL;
+        for (int i = 0; i < N_TUBE_LODS; i++)
+            lodMeshes[i] = NULL;
     };
+    Tube(Curve *curve_, double radius_, int nI_,
+         const vector<double> &ringUs_, bool isClosed_);
+    ~Tube();
 
+    void drawLod(SceneObject *sceneObject, const FrameContext &frameContext,
+                 const Transform &worldTransform);
+    void tessellateOnce(SceneObject *sceneObject);
+    const int lod(void) const
+    {
+        return iLod;
+    };
     const Point3 operator()(const double u, const double v,
                                     Vector3 &dp_du, Vector3 &dp_dv) const;
 };
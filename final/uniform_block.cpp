@@ -0,0 +1,131 @@
+#include <cassert>
+#include <cstring>
+
+#include "check_gl.h"
+#include "uniform_block.h"
+#include "wrap_gl_inclusion.h"
+
+// never returned by glGenBuffers()
+GLuint UniformBlock::boundBufferIds[N_BLOCK_BINDINGS] = { 0, 0, 0 };
+
+
+UniformBlock::UniformBlock(const GLuint bindingPoint_, const int size_)
+    : size(size_), isDirty(true), bindingPoint(bindingPoint_)
+//
+// allocates a `size_`-byte block in host memory and a uniform buffer
+// of the same size in the GPU
+//
+{
+    assert(bindingPoint < N_BLOCK_BINDINGS);
+    assert(size % 16 == 0); // std140 blocks are multiples of a vec4
+
+    data = new unsigned char[size];
+    memset(data, 0, size);
+
+    CHECK_GL(glGenBuffers(1, &bufferId));
+    CHECK_GL(glBindBuffer(GL_UNIFORM_BUFFER, bufferId));
+    CHECK_GL(glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW));
+}
+
+
+UniformBlock::~UniformBlock()
+{
+    // (so that a later buffer reusing the id isn't taken as bound)
+    if (boundBufferIds[bindingPoint] == bufferId)
+        boundBufferIds[bindingPoint] = 0;
+    CHECK_GL(glDeleteBuffers(1, &bufferId));
+    delete [] data;
+}
+
+
+float *UniformBlock::at(const int offset, const int nBytes)
+//
+// helper: returns a pointer to the `nBytes` of the block at `offset`,
+// marking the block as needing an update
+//
+{
+    assert(offset % 4 == 0); // all std140 members are 4-byte aligned
+    assert(0 <= offset && offset + nBytes <= size);
+    isDirty = true;
+    return reinterpret_cast<float *>(data + offset);
+}
+
+
+void UniformBlock::bind(void) const
+//
+// makes this block the one that shaders see at its binding point
+//
+{
+    // Optimization: As with ShaderProgram::select(), don't rebind a
+    // buffer that's already bound.
+    if (boundBufferIds[bindingPoint] == bufferId)
+        return;
+
+    CHECK_GL(glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, bufferId));
+    boundBufferIds[bindingPoint] = bufferId;
+}
+
+
+void UniformBlock::set(const int offset, const int val)
+//
+// sets a GLSL int member
+//
+{
+    GLint glVal = val;
+
+    memcpy(at(offset, sizeof(glVal)), &glVal, sizeof(glVal));
+}
+
+
+void UniformBlock::set(const int offset, const double val)
+//
+// sets a GLSL float member
+//
+{
+    *at(offset, sizeof(float)) = static_cast<float>(val);
+}
+
+
+void UniformBlock::set(const int offset, const Vec3 &v)
+//
+// sets a GLSL vec3 member
+//
+{
+    float *f = at(offset, 3 * sizeof(float));
+
+    f[0] = static_cast<float>(v.u.g.x);
+    f[1] = static_cast<float>(v.u.g.y);
+    f[2] = static_cast<float>(v.u.g.z);
+}
+
+
+void UniformBlock::set(const int offset, const Matrix4 &matrix, const int nRC)
+//
+// sets a GLSL mat3 (`nRC` == 3) or mat4 (`nRC` == 4) member
+//
+// Under std140, every matrix column takes up a full vec4, so a mat3
+// occupies 48 (not 36) bytes.
+//
+{
+    assert(nRC == 3 || nRC == 4); // allow only 3 or 4 rows & columns
+    float *f = at(offset, 4 * nRC * sizeof(float));
+
+    for (int j = 0; j < nRC; j++) {
+        for (int i = 0; i < nRC; i++)
+            f[4*j + i] = static_cast<float>(matrix.a[matrix.ij(i, j)]);
+    }
+}
+
+
+void UniformBlock::update(void)
+//
+// sends the block to the GPU if it's changed since the last update()
+//
+{
+    if (!isDirty)
+        return;
+
+    CHECK_GL(glBindBuffer(GL_UNIFORM_BUFFER, bufferId));
+    CHECK_GL(glBufferSubData(GL_UNIFORM_BUFFER, 0, size, data));
+    isDirty = false;
+}
@@ -0,0 +1,60 @@
+#ifndef INCLUDED_UNIFORM_BLOCK
+
+//
+// The "uniform_block" module provides the UniformBlock class (see
+// below).
+//
+
+#include "wrap_gl_inclusion.h"
+
+#include "geometry.h"
+#include "vec.h"
+
+//
+// Binding points of the uniform blocks shared by the shaders. These
+// must be the same for every ShaderProgram that declares the block.
+//
+enum {
+    FRAME_BLOCK_BINDING    = 0, // changes once per frame
+    MATERIAL_BLOCK_BINDING = 1, // changes once per material
+    OBJECT_BLOCK_BINDING   = 2, // changes once per draw
+    N_BLOCK_BINDINGS
+};
+
+
+class UniformBlock
+//
+// a block of GLSL uniform variables kept in a uniform buffer object
+// (UBO)
+//
+// The block is laid out according to the GLSL "std140" rules, so the
+// caller supplies the byte offset of each member, which must agree
+// with the "layout(std140) uniform" declaration in the shader(s).
+// Values are accumulated in host memory and only sent to the GPU by
+// update() (and then only if something has changed).
+//
+{
+    static GLuint boundBufferIds[N_BLOCK_BINDINGS];
+
+    unsigned char *data; // host copy of the block
+    int size; // in bytes
+    bool isDirty; // true iff `data` hasn't been sent to the GPU
+    GLuint bindingPoint;
+    GLuint bufferId;
+
+    float *at(const int offset, const int nBytes);
+
+public:
+    UniformBlock(const GLuint bindingPoint_, const int size_);
+    ~UniformBlock();
+
+    void bind(void) const;
+    void set(const int offset, const int val);
+    void set(const int offset, const double val);
+    void set(const int offset, const Vec3 &v);
+    void set(const int offset, const Matrix4 &matrix, const int nRC);
+    void update(void);
+};
+
+#define INCLUDED_UNIFORM_BLOCK
+#endif // INCLUDED_UNIFORM_BLOCK
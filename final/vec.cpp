@@ -13,14 +13,16 @@ using namespace std;
 // conventions.
 //
 
-ostream& operator<<(ostream &out, const Vec3 t)
+template <class Scalar>
+ostream& operator<<(ostream &out, const Vec3T<Scalar> t)
 {
     out << "[ " << t.u.a[0] << " " << t.u.a[1] << " " << t.u.a[2] << " ]";
     return out;
 }
 
 
-ostream& operator<<(ostream &out, const Mat4 mat)
+template <class Scalar>
+ostream& operator<<(ostream &out, const Mat4T<Scalar> mat)
 {
     for (int i = 0; i < 4; i++) {
         if (i == 0)
@@ -39,3 +41,10 @@ ostream& operator<<(ostream &out, const Mat4 mat)
     }
     return out;
 }
+
+
+// explicit instantiations for the scalar types we use
+template ostream& operator<<(ostream &out, const Vec3T<double> t);
+template ostream& operator<<(ostream &out, const Vec3T<float> t);
+template ostream& operator<<(ostream &out, const Mat4T<double> mat);
+template ostream& operator<<(ostream &out, const Mat4T<float> mat);
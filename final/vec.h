@@ -1,10 +1,15 @@
 #ifndef INCLUDED_VEC
 
 //
-// The "vec" module provides the Vec3 and Mat4 classes (see below).
+// The "vec" module provides the Vec3T and Mat4T class templates (see
+// below).
 //
-// This implements host equivalents of the GLSL vec3 and mat4 classes,
-// although these are double precision.
+// This implements host equivalents of the GLSL vec3 and mat4 classes.
+// They're templates over the scalar type so that bulk geometry (e.g.
+// vertices on their way to the GPU) can be single precision while
+// curve math stays double precision. "Vec3" and "Mat4" are the double
+// precision versions and "Vec3f" and "Mat4f" the single precision
+// ones.
 //
 
 
@@ -14,101 +19,343 @@
 #include <iostream>
 using namespace std;
 
+//
+// If PADDED_VEC3 is nonzero, (double precision) Vec3s have a 4th,
+// always zero, coordinate and are 16-byte aligned, so that their
+// arithmetic (see Vec3Arithmetic below) can use SSE2 (or AVX, if
+// compiled with it enabled) instructions. It's on by default wherever
+// SSE2 is available. Single precision Vec3fs are never padded, as
+// arrays of them are copied directly to OpenGL vertex buffers.
+//
+#ifndef PADDED_VEC3
+#ifdef __SSE2__
+#define PADDED_VEC3 1
+#else
+#define PADDED_VEC3 0
+#endif
+#endif
+
+#if PADDED_VEC3
+#include <immintrin.h>
+#endif
+
 //
 // Floating point calculations, (e.g. Vec3 magnitudes), that result in
 // quantities with absolute values less than EPSILON should be
-// considered zero due to the effects of roundoff. If we ever choose
-// to use (single precision) float values, this quantity should be
-// increased to, say, 1.0e-6.
+// considered zero due to the effects of roundoff. For (single
+// precision) float values, ScalarTraits<float>::epsilon() is used
+// instead.
 //
 const double EPSILON = 1.0e-12;
 
-class Vec3
+template <class Scalar>
+struct ScalarTraits
+//
+// properties of the scalar types the geometry templates are used with
+//
+{
+};
+
+template <>
+struct ScalarTraits<double>
+{
+    static double epsilon(void) { return EPSILON; };
+    enum { nVec3Lanes = PADDED_VEC3 ? 4 : 3 }; // length of Vec3::u.a[]
+};
+
+template <>
+struct ScalarTraits<float>
+{
+    static float epsilon(void) { return 1.0e-6f; };
+    enum { nVec3Lanes = 3 };
+};
+
+template <class T>
+struct NonDeduced
+//
+// helper: `typename NonDeduced<T>::type` is just `T`, but keeps the
+// compiler from deducing a template's scalar type from a (e.g.
+// literal) scalar argument, so that `2 * p` works for any Point3T `p`
+//
+{
+    typedef T type;
+};
+
+template <class Scalar>
+struct Vec3Arithmetic
+//
+// the componentwise operations the Vec3T-derived classes are built
+// on, operating on their `u.a[]` arrays
+//
+// This version is plain C++. See below for the SIMD version used for
+// padded Vec3s.
+//
+{
+    static void add(Scalar a[], const Scalar b[])
+    {
+        a[0] += b[0]; a[1] += b[1]; a[2] += b[2];
+    };
+    static void subtract(Scalar a[], const Scalar b[])
+    {
+        a[0] -= b[0]; a[1] -= b[1]; a[2] -= b[2];
+    };
+    static void multiply(Scalar a[], const Scalar b[])
+    {
+        a[0] *= b[0]; a[1] *= b[1]; a[2] *= b[2];
+    };
+    static void addScalar(Scalar a[], const Scalar offset)
+    {
+        a[0] += offset; a[1] += offset; a[2] += offset;
+    };
+    static void scale(Scalar a[], const Scalar scale)
+    {
+        a[0] *= scale; a[1] *= scale; a[2] *= scale;
+    };
+    static void divide(Scalar a[], const Scalar divisor)
+    {
+        a[0] /= divisor; a[1] /= divisor; a[2] /= divisor;
+    };
+    static void negate(Scalar a[])
+    {
+        a[0] = -a[0]; a[1] = -a[1]; a[2] = -a[2];
+    };
+    static Scalar dot(const Scalar a[], const Scalar b[])
+    {
+        return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    };
+    static void cross(const Scalar a[], const Scalar b[], Scalar result[])
+    {
+        result[0] = a[1]*b[2] - a[2]*b[1];
+        result[1] = a[2]*b[0] - a[0]*b[2];
+        result[2] = a[0]*b[1] - a[1]*b[0];
+    };
+};
+
+#if PADDED_VEC3
+template <>
+struct Vec3Arithmetic<double>
+//
+// SSE2 (and, where noted, AVX) versions of the above for padded
+// Vec3s
+//
+// These use the same operations in the same order as the plain C++
+// versions, so results are identical. The (zero) 4th coordinate stays
+// zero under all of them.
+//
+{
+#ifdef __AVX__
+    static void add(double a[4], const double b[4])
+    {
+        _mm256_storeu_pd(a, _mm256_add_pd(_mm256_loadu_pd(a),
+                                          _mm256_loadu_pd(b)));
+    };
+    static void subtract(double a[4], const double b[4])
+    {
+        _mm256_storeu_pd(a, _mm256_sub_pd(_mm256_loadu_pd(a),
+                                          _mm256_loadu_pd(b)));
+    };
+    static void multiply(double a[4], const double b[4])
+    {
+        _mm256_storeu_pd(a, _mm256_mul_pd(_mm256_loadu_pd(a),
+                                          _mm256_loadu_pd(b)));
+    };
+    static void addScalar(double a[4], const double offset)
+    {
+        _mm256_storeu_pd(a, _mm256_add_pd(
+                             _mm256_loadu_pd(a),
+                             _mm256_set_pd(0.0, offset, offset, offset)));
+    };
+    static void scale(double a[4], const double scale)
+    {
+        _mm256_storeu_pd(a, _mm256_mul_pd(_mm256_loadu_pd(a),
+                                          _mm256_set1_pd(scale)));
+    };
+    static void divide(double a[4], const double divisor)
+    {
+        _mm256_storeu_pd(a, _mm256_div_pd(_mm256_loadu_pd(a),
+                                          _mm256_set1_pd(divisor)));
+    };
+#else
+    static void add(double a[4], const double b[4])
+    {
+        _mm_storeu_pd(a, _mm_add_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+        _mm_storeu_pd(a + 2,
+                      _mm_add_pd(_mm_loadu_pd(a + 2), _mm_loadu_pd(b + 2)));
+    };
+    static void subtract(double a[4], const double b[4])
+    {
+        _mm_storeu_pd(a, _mm_sub_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+        _mm_storeu_pd(a + 2,
+                      _mm_sub_pd(_mm_loadu_pd(a + 2), _mm_loadu_pd(b + 2)));
+    };
+    static void multiply(double a[4], const double b[4])
+    {
+        _mm_storeu_pd(a, _mm_mul_pd(_mm_loadu_pd(a), _mm_loadu_pd(b)));
+        _mm_storeu_pd(a + 2,
+                      _mm_mul_pd(_mm_loadu_pd(a + 2), _mm_loadu_pd(b + 2)));
+    };
+    static void addScalar(double a[4], const double offset)
+    {
+        _mm_storeu_pd(a, _mm_add_pd(_mm_loadu_pd(a), _mm_set1_pd(offset)));
+        _mm_storeu_pd(a + 2,
+                      _mm_add_pd(_mm_loadu_pd(a + 2), _mm_set_sd(offset)));
+    };
+    static void scale(double a[4], const double scale)
+    {
+        __m128d s = _mm_set1_pd(scale);
+        _mm_storeu_pd(a, _mm_mul_pd(_mm_loadu_pd(a), s));
+        _mm_storeu_pd(a + 2, _mm_mul_pd(_mm_loadu_pd(a + 2), s));
+    };
+    static void divide(double a[4], const double divisor)
+    {
+        __m128d d = _mm_set1_pd(divisor);
+        _mm_storeu_pd(a, _mm_div_pd(_mm_loadu_pd(a), d));
+        _mm_storeu_pd(a + 2, _mm_div_pd(_mm_loadu_pd(a + 2), d));
+    };
+#endif
+    static void negate(double a[4])
+    {
+        __m128d signBits = _mm_set_pd(0.0, -0.0);
+        _mm_storeu_pd(a, _mm_xor_pd(_mm_loadu_pd(a), _mm_set1_pd(-0.0)));
+        _mm_storeu_pd(a + 2, _mm_xor_pd(_mm_loadu_pd(a + 2), signBits));
+    };
+    static double dot(const double a[4], const double b[4])
+    {
+        __m128d xy = _mm_mul_pd(_mm_loadu_pd(a), _mm_loadu_pd(b));
+        __m128d zw = _mm_mul_pd(_mm_loadu_pd(a + 2), _mm_loadu_pd(b + 2));
+        __m128d sum = _mm_add_sd(xy, _mm_unpackhi_pd(xy, xy));
+        return _mm_cvtsd_f64(_mm_add_sd(sum, zw));
+    };
+    static void cross(const double a[4], const double b[4], double result[4])
+    {
+        // result.xy = a.yz * b.zx - a.zx * b.yz
+        __m128d aYZ = _mm_loadu_pd(a + 1);
+        __m128d bYZ = _mm_loadu_pd(b + 1);
+        __m128d aZX = _mm_set_pd(a[0], a[2]);
+        __m128d bZX = _mm_set_pd(b[0], b[2]);
+        __m128d xy = _mm_sub_pd(_mm_mul_pd(aYZ, bZX), _mm_mul_pd(aZX, bYZ));
+        // result.zw = (a.x * b.y - a.y * b.x, 0)
+        __m128d zw = _mm_sub_sd(
+            _mm_mul_sd(_mm_set_sd(a[0]), _mm_set_sd(b[1])),
+            _mm_mul_sd(_mm_set_sd(a[1]), _mm_set_sd(b[0])));
+        _mm_storeu_pd(result, xy);
+        _mm_storeu_pd(result + 2, zw);
+    };
+};
+#endif // PADDED_VEC3
+
+
+template <class Scalar>
+class Vec3T
 //
 // a 3D vector (low level)
 //
 {
 public:
-    union { // good example (IMHO) of union use: notational convenience
+    typedef Vec3Arithmetic<Scalar> Arithmetic;
+    enum { N_LANES = ScalarTraits<Scalar>::nVec3Lanes };
+
+    // good example (IMHO) of union use: notational convenience
+    union alignas(N_LANES == 4 ? 2 * sizeof(Scalar) : sizeof(Scalar)) {
         struct {
-            double x, y, z;
+            Scalar x, y, z;
         } g;         // when used as individual [g]eometric components
         struct {
-            double r, g, b;
+            Scalar r, g, b;
         } c;         // when used as individual [c]olor components
-        double a[3]; // when used as array
+        Scalar a[N_LANES]; // when used as array (only a[0-2] matter)
     } u;
 
-    Vec3(void)
-        { u.g.x = 0.0;   u.g.y = 0.0;   u.g.z = 0.0; };
+    Vec3T(void)
+        { u.g.x = 0.0;   u.g.y = 0.0;   u.g.z = 0.0;   clearPadding(); };
+
+    Vec3T(const Scalar x, const Scalar y, const Scalar z)
+        { u.g.x = x;     u.g.y = y;     u.g.z = z;     clearPadding(); };
 
-    Vec3(const double x, const double y, const double z)
-        { u.g.x = x;     u.g.y = y;     u.g.z = z; };
+    Vec3T(const Scalar a[3])
+        { u.a[0] = a[0]; u.a[1] = a[1]; u.a[2] = a[2]; clearPadding(); };
 
-    Vec3(const double a[3])
-        { u.a[0] = a[0]; u.a[1] = a[1]; u.a[2] = a[2]; };
+    // converts between precisions
+    template <class OtherScalar>
+    explicit Vec3T(const Vec3T<OtherScalar> &vec)
+    {
+        u.a[0] = static_cast<Scalar>(vec.u.a[0]);
+        u.a[1] = static_cast<Scalar>(vec.u.a[1]);
+        u.a[2] = static_cast<Scalar>(vec.u.a[2]);
+        clearPadding();
+    };
+
+    void clearPadding(void)
+    //
+    // zeroes the unused 4th coordinate, if there is one
+    //
+    {
+        for (int i = 3; i < N_LANES; i++)
+            u.a[i] = 0.0;
+    };
 
     const bool isZero(void) const
     {
         return u.a[0] == 0.0 && u.a[1] == 0.0 && u.a[2] == 0.0;
     }
 
-    Vec3 &operator+=(const Vec3 &vec)
+    Vec3T &operator+=(const Vec3T &vec)
     {
-        u.a[0] += vec.u.a[0];
-        u.a[1] += vec.u.a[1];
-        u.a[2] += vec.u.a[2];
+        Arithmetic::add(u.a, vec.u.a);
         return *this;
     };
 
-    const Vec3 operator+(const Vec3 &vec) const
+    const Vec3T operator+(const Vec3T &vec) const
     {
-        return Vec3(*this) += vec;
+        return Vec3T(*this) += vec;
     };
 
-    Vec3 &operator*=(const Vec3 &vec)
+    Vec3T &operator*=(const Vec3T &vec)
     {
-        u.a[0] *= vec.u.a[0];
-        u.a[1] *= vec.u.a[1];
-        u.a[2] *= vec.u.a[2];
+        Arithmetic::multiply(u.a, vec.u.a);
         return *this;
     };
 
-    const Vec3 operator*(const Vec3 &vec) const
+    const Vec3T operator*(const Vec3T &vec) const
     {
-        return Vec3(*this) *= vec;
+        return Vec3T(*this) *= vec;
     };
 
-    Vec3 &operator*=(double scale)
+    Vec3T &operator*=(Scalar scale)
     {
-        u.a[0] *= scale;
-        u.a[1] *= scale;
-        u.a[2] *= scale;
+        Arithmetic::scale(u.a, scale);
         return *this;
     };
 
-    const Vec3 operator*(double scale) const
+    const Vec3T operator*(Scalar scale) const
     {
-        return Vec3(*this) *= scale;
+        return Vec3T(*this) *= scale;
     };
 };
 
+typedef Vec3T<double> Vec3;
+typedef Vec3T<float> Vec3f;
 
-inline Vec3 operator*(const double scale, const Vec3 &vec)
+
+template <class Scalar>
+inline Vec3T<Scalar> operator*(const typename NonDeduced<Scalar>::type scale,
+                               const Vec3T<Scalar> &vec)
 {
     return vec * scale;
 };
 
-ostream& operator<<(ostream &out, const Vec3 t);
+template <class Scalar>
+ostream& operator<<(ostream &out, const Vec3T<Scalar> t);
 
-class Mat4
+template <class Scalar>
+class Mat4T
 //
 // a 4x4 matrix (low level)
 //
 {
 
 public:
-    double a[16];
+    Scalar a[16];
 
     inline int ij(const int i, const int j) const
     //
@@ -121,7 +368,11 @@ public:
     }
 };
 
-ostream& operator<<(ostream &out, const Mat4 mat);
+typedef Mat4T<double> Mat4;
+typedef Mat4T<float> Mat4f;
+
+template <class Scalar>
+ostream& operator<<(ostream &out, const Mat4T<Scalar> mat);
 
 #define INCLUDED_VEC
 #endif // INCLUDED_VEC
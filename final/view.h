@@ -33,6 +33,10 @@ View(void)
         savedCanvasWidth( defaultCanvasWidth),
         savedCanvasHeight(defaultCanvasHeight)
     { };
+    const Point2 canvasSize(void) const
+    {
+        return Point2(canvasWidth, canvasHeight);
+    };
     void init(int *argc, char **argv, string windowTitle);
     static void display(void); // "static" allows this to be used as a callback
     void displayViewHelp(void);
@@ -0,0 +1,750 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "compressed_mipmap.h"
+
+enum {
+    TEXTURE_CACHE_MAGIC = 0x504d4342, // "BCMP" (little-endian)
+    TEXTURE_CACHE_VERSION = 1,
+    TEXTURE_CACHE_HEADER_SIZE = 6 * 4,
+    TEXTURE_CACHE_MAX_SIZE = 1 << 16, // (pixels on a side)
+};
+
+
+static const int blockSize(const CompressedMipmapFormat format)
+//
+// helper: returns the bytes in each 4 x 4 block of `format`
+//
+{
+    return (format == COMPRESSED_MIPMAP_BC1) ? 8 : 16;
+}
+
+
+static const size_t levelSize(const int width, const int height,
+                              const CompressedMipmapFormat format)
+//
+// helper: returns the bytes in a `width` x `height` level of `format`
+// (Partial blocks at the edges are whole blocks.)
+//
+{
+    return (size_t) ((width + 3) / 4) * ((height + 3) / 4)
+        * blockSize(format);
+}
+
+
+static const unsigned int littleEndian32(const unsigned char *bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16)
+        | ((unsigned int) bytes[3] << 24);
+}
+
+
+static void putLittleEndian(unsigned char *bytes, const unsigned int value,
+                            const int nBytes)
+{
+    for (int b = 0; b < nBytes; b++)
+        bytes[b] = (value >> (8 * b)) & 0xff;
+}
+
+
+static const unsigned short to565(const double rgb[3])
+//
+// helper: returns the (rounded) 5:6:5-bit encoding of `rgb` (in [0, 255])
+//
+{
+    int r = (int) floor(rgb[0] * 31 / 255 + 0.5);
+    int g = (int) floor(rgb[1] * 63 / 255 + 0.5);
+    int b = (int) floor(rgb[2] * 31 / 255 + 0.5);
+
+    return (min(max(r, 0), 31) << 11) | (min(max(g, 0), 63) << 5)
+        | min(max(b, 0), 31);
+}
+
+
+static void from565(const unsigned short c, int rgb[3])
+//
+// helper: sets `rgb` (in [0, 255]) to the color a GPU decodes 5:6:5-bit
+// `c` as
+//
+{
+    int r = (c >> 11) & 0x1f;
+    int g = (c >> 5) & 0x3f;
+    int b = c & 0x1f;
+
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+
+enum { N_COLOR_BLOCK_REFINEMENTS = 2 };
+
+
+static const int chooseColorIndices(const unsigned char pixels[16][4],
+                                    unsigned short &color0,
+                                    unsigned short &color1,
+                                    unsigned int &indices)
+//
+// helper: orders endpoints `color0` and `color1` as BC1's four-color
+// mode requires, sets `indices` to the nearest of the resulting palette
+// to each of `pixels`, and returns their total squared error
+//
+{
+    //
+    // If color0 > color1 (as integers), the block has four colors (the
+    // endpoints and two between them), which is what we want. (If
+    // they're equal, the block has three, but every pixel is color0.)
+    //
+    if (color0 < color1)
+        swap(color0, color1);
+
+    int palette[4][3];
+    from565(color0, palette[0]);
+    from565(color1, palette[1]);
+    for (int k = 0; k < 3; k++) {
+        palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+        palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+    }
+
+    int totalError = 0;
+    indices = 0;
+    for (int i = 0; i < 16; i++) {
+        int iBest = 0;
+        int bestDistance2 = 1 << 30;
+
+        for (int j = 0; j < (color0 == color1 ? 1 : 4); j++) {
+            int distance2 = 0;
+
+            for (int k = 0; k < 3; k++)
+                distance2 += (pixels[i][k] - palette[j][k])
+                    * (pixels[i][k] - palette[j][k]);
+            if (distance2 < bestDistance2) {
+                iBest = j;
+                bestDistance2 = distance2;
+            }
+        }
+        indices |= iBest << (2 * i);
+        totalError += bestDistance2;
+    }
+    return totalError;
+}
+
+
+static void encodeColorBlock(const unsigned char pixels[16][4],
+                             unsigned char *block)
+//
+// helper: encodes the colors of 16 `pixels` (RGBA) as an 8-byte BC1
+// `block`
+//
+// The first endpoints are the extremes of the pixels along their
+// principal axis (the direction in which their colors vary most), which
+// is found by power iteration on their covariance. Then, given the
+// palette entry each pixel uses, the endpoints that minimize the
+// squared error are found by least squares, which is repeated as long
+// as it improves the block.
+//
+{
+    double mean[3] = { 0.0, 0.0, 0.0 };
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++)
+            mean[k] += pixels[i][k] / 16.0;
+
+    double covariance[3][3] = { { 0.0 } };
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++)
+            for (int l = 0; l < 3; l++)
+                covariance[k][l] += (pixels[i][k] - mean[k])
+                    * (pixels[i][l] - mean[l]);
+
+    double axis[3] = { 1.0, 1.0, 1.0 };
+    for (int iteration = 0; iteration < 8; iteration++) {
+        double product[3];
+        double norm = 0.0;
+
+        for (int k = 0; k < 3; k++) {
+            product[k] = covariance[k][0] * axis[0]
+                + covariance[k][1] * axis[1] + covariance[k][2] * axis[2];
+            norm = max(norm, fabs(product[k]));
+        }
+        if (norm == 0.0)
+            break; // (All the pixels are the same color.)
+        for (int k = 0; k < 3; k++)
+            axis[k] = product[k] / norm;
+    }
+
+    double tMin = 0.0, tMax = 0.0;
+    for (int i = 0; i < 16; i++) {
+        double t = 0.0;
+
+        for (int k = 0; k < 3; k++)
+            t += (pixels[i][k] - mean[k]) * axis[k];
+        tMin = min(tMin, t);
+        tMax = max(tMax, t);
+    }
+    double norm2 = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+    double endpoint0[3], endpoint1[3];
+    for (int k = 0; k < 3; k++) {
+        endpoint0[k] = mean[k] + tMax * axis[k] / norm2;
+        endpoint1[k] = mean[k] + tMin * axis[k] / norm2;
+    }
+
+    unsigned short color0 = to565(endpoint0);
+    unsigned short color1 = to565(endpoint1);
+    unsigned int indices;
+    int error = chooseColorIndices(pixels, color0, color1, indices);
+
+    for (int iteration = 0;
+         iteration < N_COLOR_BLOCK_REFINEMENTS && error > 0; iteration++) {
+        // Palette entry j is weights[j] * color0 + (1 - weights[j]) * color1.
+        static const double weights[4] = { 1.0, 0.0, 2.0 / 3, 1.0 / 3 };
+        double aa = 0.0, ab = 0.0, bb = 0.0;
+        double ap[3] = { 0.0, 0.0, 0.0 }, bp[3] = { 0.0, 0.0, 0.0 };
+
+        for (int i = 0; i < 16; i++) {
+            double a = weights[(indices >> (2 * i)) & 0x3];
+            double b = 1.0 - a;
+
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (int k = 0; k < 3; k++) {
+                ap[k] += a * pixels[i][k];
+                bp[k] += b * pixels[i][k];
+            }
+        }
+        double determinant = aa * bb - ab * ab;
+        if (fabs(determinant) < 1.0e-6)
+            break; // (All pixels use the same entry.)
+        for (int k = 0; k < 3; k++) {
+            endpoint0[k] = (bb * ap[k] - ab * bp[k]) / determinant;
+            endpoint1[k] = (aa * bp[k] - ab * ap[k]) / determinant;
+        }
+
+        unsigned short newColor0 = to565(endpoint0);
+        unsigned short newColor1 = to565(endpoint1);
+        unsigned int newIndices;
+        int newError = chooseColorIndices(pixels, newColor0, newColor1,
+                                          newIndices);
+        if (newError >= error)
+            break;
+        color0 = newColor0;
+        color1 = newColor1;
+        indices = newIndices;
+        error = newError;
+    }
+
+    putLittleEndian(block, color0, 2);
+    putLittleEndian(block + 2, color1, 2);
+    putLittleEndian(block + 4, indices, 4);
+}
+
+
+static void encodeAlphaBlock(const unsigned char pixels[16][4],
+                             unsigned char *block)
+//
+// helper: encodes the alphas of 16 `pixels` (RGBA) as the 8-byte alpha
+// half of a BC3 block
+//
+// The endpoints are the largest and smallest alphas, with six alphas
+// interpolated between them.
+//
+{
+    int alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < 16; i++) {
+        alpha0 = max(alpha0, (int) pixels[i][3]);
+        alpha1 = min(alpha1, (int) pixels[i][3]);
+    }
+
+    int palette[8] = { alpha0, alpha1 };
+    for (int j = 1; j <= 6; j++)
+        palette[j + 1] = ((7 - j) * alpha0 + j * alpha1) / 7;
+
+    unsigned long long indices = 0; // (48 bits of 3-bit indices)
+    if (alpha0 != alpha1) {
+        for (int i = 0; i < 16; i++) {
+            int iBest = 0;
+
+            for (int j = 1; j < 8; j++)
+                if (abs(pixels[i][3] - palette[j])
+                        < abs(pixels[i][3] - palette[iBest]))
+                    iBest = j;
+            indices |= (unsigned long long) iBest << (3 * i);
+        }
+    }
+    block[0] = alpha0;
+    block[1] = alpha1;
+    for (int b = 0; b < 6; b++)
+        block[2 + b] = (indices >> (8 * b)) & 0xff;
+}
+
+
+static void encodeLevel(const Image *image,
+                        const CompressedMipmapFormat format,
+                        unsigned char *blocks)
+//
+// helper: encodes `image` in `format` as `blocks`
+//
+{
+    for (int y0 = 0; y0 < image->height; y0 += 4) {
+        for (int x0 = 0; x0 < image->width; x0 += 4) {
+            unsigned char pixels[16][4];
+
+            for (int i = 0; i < 16; i++) {
+                // Partial blocks repeat the image's last row or column.
+                int x = min(x0 + i % 4, image->width - 1);
+                int y = min(y0 + i / 4, image->height - 1);
+                const unsigned char *pixel = image->data
+                    + ((size_t) y * image->width + x) * image->nBytesPerPixel;
+
+                for (int k = 0; k < 4; k++)
+                    pixels[i][k] = (k < image->nBytesPerPixel) ? pixel[k] : 255;
+            }
+            if (format == COMPRESSED_MIPMAP_BC3) {
+                encodeAlphaBlock(pixels, blocks);
+                blocks += 8;
+            }
+            encodeColorBlock(pixels, blocks);
+            blocks += 8;
+        }
+    }
+}
+
+
+CompressedMipmap::CompressedMipmap(void)
+    : format_(COMPRESSED_MIPMAP_BC1), mapping(NULL), mappingSize(0)
+{
+}
+
+
+CompressedMipmap::~CompressedMipmap()
+{
+#if !defined(_WIN32)
+    if (mapping)
+        munmap(mapping, mappingSize);
+#endif
+}
+
+
+CompressedMipmap *CompressedMipmap::encode(const Image *image)
+//
+// returns a new CompressedMipmap of `image` (in BC1 if it's RGB and BC3
+// if it's RGBA), down to 1 x 1
+//
+{
+    CompressedMipmapFormat format = (image->nBytesPerPixel == 4)
+        ? COMPRESSED_MIPMAP_BC3 : COMPRESSED_MIPMAP_BC1;
+    CompressedMipmap *mipmap = new CompressedMipmap();
+    vector<unsigned char> &contents = mipmap->contents;
+    int nLevels = 1;
+
+    while ((image->width >> (nLevels - 1)) > 1
+           || (image->height >> (nLevels - 1)) > 1)
+        nLevels++;
+
+    contents.resize(TEXTURE_CACHE_HEADER_SIZE);
+    putLittleEndian(&contents[0], TEXTURE_CACHE_MAGIC, 4);
+    putLittleEndian(&contents[4], TEXTURE_CACHE_VERSION, 4);
+    putLittleEndian(&contents[8], format, 4);
+    putLittleEndian(&contents[12], image->width, 4);
+    putLittleEndian(&contents[16], image->height, 4);
+    putLittleEndian(&contents[20], nLevels, 4);
+
+    const Image *level = image;
+    for (int i = 0; i < nLevels; i++) {
+        size_t offset = contents.size();
+
+        contents.resize(offset + levelSize(level->width, level->height,
+                                           format));
+        encodeLevel(level, format, &contents[offset]);
+        if (i < nLevels - 1) {
+            const Image *nextLevel = level->halved();
+
+            if (level != image)
+                delete level;
+            level = nextLevel;
+        }
+    }
+    if (level != image)
+        delete level;
+
+    mipmap->setLevels(&contents[0], contents.size());
+    return mipmap;
+}
+
+
+CompressedMipmap *CompressedMipmap::read(const string &fname)
+//
+// returns a new CompressedMipmap of the texture cache file `fname`, or
+// NULL (after reporting why on cerr) if it can't be read
+//
+{
+    CompressedMipmap *mipmap = new CompressedMipmap();
+
+#if defined(_WIN32)
+    ifstream in(fname.c_str(), ios::binary);
+
+    if (!in) {
+        cerr << "Unable to open texture cache file \"" << fname << "\"\n";
+        delete mipmap;
+        return NULL;
+    }
+    mipmap->contents.assign(istreambuf_iterator<char>(in),
+                            istreambuf_iterator<char>());
+    mipmap->mappingSize = mipmap->contents.size();
+    const unsigned char *bytes = mipmap->contents.empty()
+        ? NULL : &mipmap->contents[0];
+#else
+    int fd = open(fname.c_str(), O_RDONLY);
+    struct stat status;
+
+    if (fd < 0 || fstat(fd, &status) < 0) {
+        cerr << "Unable to open texture cache file \"" << fname << "\"\n";
+        if (fd >= 0)
+            close(fd);
+        delete mipmap;
+        return NULL;
+    }
+    mipmap->mappingSize = status.st_size;
+    if (mipmap->mappingSize > 0) {
+        void *address = mmap(NULL, mipmap->mappingSize, PROT_READ,
+                             MAP_PRIVATE, fd, 0);
+
+        if (address == MAP_FAILED) {
+            cerr << "Unable to map texture cache file \"" << fname << "\"\n";
+            close(fd);
+            delete mipmap;
+            return NULL;
+        }
+        mipmap->mapping = (unsigned char *) address;
+    }
+    close(fd); // (The mapping remains.)
+    const unsigned char *bytes = mipmap->mapping;
+#endif
+
+    if (!mipmap->setLevels(bytes, mipmap->mappingSize)) {
+        cerr << "Invalid texture cache file \"" << fname << "\"\n";
+        delete mipmap;
+        return NULL;
+    }
+    return mipmap;
+}
+
+
+CompressedMipmap *CompressedMipmap::readCache(const string &cacheFname,
+                                              const string &sourceFname)
+//
+// returns a new CompressedMipmap of the texture cache file `cacheFname`
+// if it's at least as new as the file it was made from, `sourceFname`,
+// or NULL if it isn't (or doesn't exist or can't be read)
+//
+{
+    struct stat cacheStatus, sourceStatus;
+
+    if (stat(cacheFname.c_str(), &cacheStatus) < 0
+            || (stat(sourceFname.c_str(), &sourceStatus) == 0
+                && cacheStatus.st_mtime < sourceStatus.st_mtime))
+        return NULL;
+    return read(cacheFname);
+}
+
+
+const bool CompressedMipmap::setLevels(const unsigned char *bytes,
+                                       const size_t size)
+//
+// helper: sets `format_` and `levels` from the texture cache contents
+// `bytes`, returning false if they're invalid
+//
+{
+    if (size < TEXTURE_CACHE_HEADER_SIZE
+            || littleEndian32(bytes) != TEXTURE_CACHE_MAGIC
+            || littleEndian32(bytes + 4) != TEXTURE_CACHE_VERSION)
+        return false;
+
+    unsigned int format = littleEndian32(bytes + 8);
+    unsigned int width = littleEndian32(bytes + 12);
+    unsigned int height = littleEndian32(bytes + 16);
+    unsigned int nLevels = littleEndian32(bytes + 20);
+
+    if (format > COMPRESSED_MIPMAP_BC3
+            || width == 0 || width > TEXTURE_CACHE_MAX_SIZE
+            || height == 0 || height > TEXTURE_CACHE_MAX_SIZE
+            || nLevels == 0 || nLevels > 17) // (log2(MAX_SIZE) + 1)
+        return false;
+    format_ = (CompressedMipmapFormat) format;
+
+    size_t offset = TEXTURE_CACHE_HEADER_SIZE;
+    levels.clear();
+    for (unsigned int i = 0; i < nLevels; i++) {
+        Level level;
+
+        if (i > 0 && levels.back().width == 1 && levels.back().height == 1)
+            return false; // (There's nothing smaller than 1 x 1.)
+        level.width = max(width >> i, 1u);
+        level.height = max(height >> i, 1u);
+        level.size = levelSize(level.width, level.height, format_);
+        if (level.size > size - offset)
+            return false; // (truncated)
+        level.blocks = bytes + offset;
+        offset += level.size;
+        levels.push_back(level);
+    }
+    return offset == size;
+}
+
+
+const bool CompressedMipmap::write(const string &fname) const
+//
+// writes this mipmap to the texture cache file `fname`, returning false
+// if it can't
+//
+// (If the file is only partly written, read() will reject it.)
+//
+{
+    const unsigned char *bytes = mapping ? mapping : &contents[0];
+    const size_t size = mapping ? mappingSize : contents.size();
+    FILE *f = fopen(fname.c_str(), "wb");
+
+    if (!f)
+        return false;
+    bool isOk = (fwrite(bytes, 1, size, f) == size);
+    return (fclose(f) == 0) && isOk;
+}
+
+
+#ifdef TEST
+//
+// encodes images in both formats, decodes them (as a GPU would) to
+// check their error, and writes, reads, and rejects texture cache
+// files
+//
+#if defined(_WIN32)
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
+#include "n_elem.h"
+
+static void decodeBlock(const unsigned char *block,
+                        const CompressedMipmapFormat format,
+                        unsigned char pixels[16][4])
+//
+// decodes a BC1 or BC3 `block` into 16 RGBA `pixels`
+//
+{
+    for (int i = 0; i < 16; i++)
+        pixels[i][3] = 255;
+    if (format == COMPRESSED_MIPMAP_BC3) {
+        int palette[8] = { block[0], block[1] };
+        unsigned long long indices = 0;
+
+        for (int j = 1; j <= 6; j++)
+            palette[j + 1] = ((7 - j) * block[0] + j * block[1]) / 7;
+        for (int b = 0; b < 6; b++)
+            indices |= (unsigned long long) block[2 + b] << (8 * b);
+        for (int i = 0; i < 16; i++)
+            pixels[i][3] = palette[(indices >> (3 * i)) & 0x7];
+        block += 8;
+    }
+
+    unsigned short color0 = block[0] | (block[1] << 8);
+    unsigned short color1 = block[2] | (block[3] << 8);
+    unsigned int indices = littleEndian32(block + 4);
+    int palette[4][3];
+
+    from565(color0, palette[0]);
+    from565(color1, palette[1]);
+    for (int k = 0; k < 3; k++) {
+        palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+        palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+    }
+    for (int i = 0; i < 16; i++)
+        for (int k = 0; k < 3; k++)
+            pixels[i][k] = palette[(indices >> (2 * i)) & 0x3][k];
+}
+
+
+static const double rmsError(const Image *image,
+                             const CompressedMipmap *mipmap)
+//
+// returns the RMS error (per component) of level 0 of `mipmap` as an
+// encoding of `image`
+//
+{
+    double sumSquares = 0.0;
+    const int nBlocksPerRow = (image->width + 3) / 4;
+
+    for (int y = 0; y < image->height; y++)
+        for (int x = 0; x < image->width; x++) {
+            unsigned char pixels[16][4];
+            int iBlock = (y / 4) * nBlocksPerRow + x / 4;
+
+            decodeBlock(mipmap->blocks(0)
+                        + iBlock * blockSize(mipmap->format()),
+                        mipmap->format(), pixels);
+            for (int k = 0; k < image->nBytesPerPixel; k++) {
+                int error = pixels[(y % 4) * 4 + x % 4][k]
+                    - image->data[(y * image->width + x)
+                                  * image->nBytesPerPixel + k];
+                sumSquares += error * error;
+            }
+        }
+    return sqrt(sumSquares
+                / (image->width * image->height * image->nBytesPerPixel));
+}
+
+
+static Image *testImage(const int width, const int height,
+                        const int nBytesPerPixel)
+//
+// returns an image of smooth gradients (what BC1 and BC3 are good at)
+// no more than 64 x 64
+//
+{
+    Image *image = new Image;
+    image->width = width;
+    image->height = height;
+    image->nBytesPerPixel = nBytesPerPixel;
+    image->format = (nBytesPerPixel == 4) ? GL_RGBA : GL_RGB;
+    image->data = new unsigned char[width * height * nBytesPerPixel];
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++) {
+            unsigned char *pixel = image->data
+                + (y * width + x) * nBytesPerPixel;
+
+            pixel[0] = 3 * x;
+            pixel[1] = 2 * y;
+            pixel[2] = 128 + 100 * sin(0.1 * (x + y));
+            if (nBytesPerPixel == 4)
+                pixel[3] = 2 * (x + y);
+        }
+    return image;
+}
+
+
+static int check(const string &name, const bool isOk)
+{
+    printf("%-40s %s\n", name.c_str(), isOk ? "ok" : "FAILED");
+    return !isOk;
+}
+
+
+int main(int argc, char **argv)
+{
+    int nFailures = 0;
+    const string fname = "compressed_mipmap_t.tmp";
+
+    const struct {
+        int width, height, nBytesPerPixel;
+        CompressedMipmapFormat format;
+        int nLevels;
+    } cases[] = {
+        { 64, 32, 3, COMPRESSED_MIPMAP_BC1, 7 },
+        { 64, 64, 4, COMPRESSED_MIPMAP_BC3, 7 },
+        { 6, 5, 3, COMPRESSED_MIPMAP_BC1, 3 }, // (partial blocks)
+    };
+    for (unsigned int i = 0; i < N_ELEM(cases); i++) {
+        char name[100];
+        Image *image = testImage(cases[i].width, cases[i].height,
+                                 cases[i].nBytesPerPixel);
+        CompressedMipmap *mipmap = CompressedMipmap::encode(image);
+        double error = rmsError(image, mipmap);
+
+        sprintf(name, "%d x %d x %d: format and levels", cases[i].width,
+                cases[i].height, cases[i].nBytesPerPixel);
+        nFailures += check(name, mipmap->format() == cases[i].format
+                           && mipmap->nLevels() == cases[i].nLevels
+                           && mipmap->width(mipmap->nLevels() - 1) == 1
+                           && mipmap->height(mipmap->nLevels() - 1) == 1);
+        sprintf(name, "%d x %d x %d: RMS error %.2f", cases[i].width,
+                cases[i].height, cases[i].nBytesPerPixel, error);
+        nFailures += check(name, error < 4.0);
+
+        // Writing and reading it back must give the same blocks.
+        mipmap->write(fname);
+        CompressedMipmap *readMipmap = CompressedMipmap::read(fname);
+        bool isSame = (readMipmap != NULL
+                       && readMipmap->nLevels() == mipmap->nLevels());
+        for (int j = 0; isSame && j < mipmap->nLevels(); j++)
+            isSame = (readMipmap->size(j) == mipmap->size(j)
+                      && memcmp(readMipmap->blocks(j), mipmap->blocks(j),
+                                mipmap->size(j)) == 0);
+        sprintf(name, "%d x %d x %d: write and read", cases[i].width,
+                cases[i].height, cases[i].nBytesPerPixel);
+        nFailures += check(name, isSame);
+
+        delete readMipmap;
+        delete mipmap;
+        delete image;
+    }
+
+    // A uniform block must be exact.
+    Image *image = testImage(8, 8, 3);
+    for (int j = 0; j < 8 * 8 * 3; j++)
+        image->data[j] = (j % 3 == 0) ? 255 : 0;
+    CompressedMipmap *mipmap = CompressedMipmap::encode(image);
+    nFailures += check("uniform red is exact", rmsError(image, mipmap) == 0.0);
+
+    // A cache must be newer than its source.
+    mipmap->write(fname);
+    CompressedMipmap *cached = CompressedMipmap::readCache(fname, fname);
+    nFailures += check("cache as new as its source is used", cached != NULL);
+    delete cached;
+    cached = CompressedMipmap::readCache(fname, "image.cpp");
+    nFailures += check("cache newer than its source is used",
+                       cached != NULL);
+    delete cached;
+
+    // (Backdate the cache to a minute before its "source".)
+    struct stat sourceStatus;
+    struct utimbuf times;
+    stat("image.cpp", &sourceStatus);
+    times.actime = times.modtime = sourceStatus.st_mtime - 60;
+    utime(fname.c_str(), &times);
+    cached = CompressedMipmap::readCache(fname, "image.cpp");
+    nFailures += check("cache older than its source is not used",
+                       cached == NULL);
+    delete cached;
+    cached = CompressedMipmap::readCache(fname + ".missing", fname);
+    nFailures += check("missing cache is not used", cached == NULL);
+    delete cached;
+
+    // These must be rejected.
+    FILE *f = fopen(fname.c_str(), "wb");
+    const unsigned char *bytes = mipmap->blocks(0) - TEXTURE_CACHE_HEADER_SIZE;
+    fwrite(bytes, 1, TEXTURE_CACHE_HEADER_SIZE + 20, f); // (truncated)
+    fclose(f);
+    cached = CompressedMipmap::read(fname);
+    nFailures += check("truncated cache is rejected", cached == NULL);
+    delete cached;
+
+    f = fopen(fname.c_str(), "wb");
+    fwrite("BCMP", 1, 4, f);
+    fwrite(bytes + 4, 1, 4, f);
+    putc(7, f); // (an invalid format)
+    fwrite(bytes + 9, 1, TEXTURE_CACHE_HEADER_SIZE - 9, f);
+    fclose(f);
+    cached = CompressedMipmap::read(fname);
+    nFailures += check("invalid format is rejected", cached == NULL);
+    delete cached;
+
+    remove(fname.c_str());
+    delete mipmap;
+    delete image;
+    return nFailures;
+}
+#endif // TEST
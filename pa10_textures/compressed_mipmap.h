@@ -0,0 +1,98 @@
+#ifndef INCLUDED_COMPRESSED_MIPMAP
+
+//
+// The "compressed_mipmap" module provides the CompressedMipmap class
+// (see below).
+//
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "image.h"
+
+using namespace std;
+
+// A texture cache file is named after its source file, plus this.
+#define TEXTURE_CACHE_SUFFIX ".bcm"
+
+enum CompressedMipmapFormat {
+    COMPRESSED_MIPMAP_BC1, // RGB, 8 bytes per 4 x 4 block (aka "DXT1")
+    COMPRESSED_MIPMAP_BC3, // RGBA, 16 bytes per 4 x 4 block (aka "DXT5")
+};
+
+
+class CompressedMipmap
+//
+// a mipmap whose levels are block-compressed (S3TC): each 4 x 4 block
+// of pixels is two endpoint colors and, for each pixel, an index into
+// a palette interpolated between them (plus, for BC3, a similar
+// encoding of alpha)
+//
+// BC1 is 1/6 the size of 8-bit RGB and BC3 is 1/4 the size of 8-bit
+// RGBA. OpenGL uses them as they are, so they take that much less
+// texture memory, too.
+//
+// Encoding is slow, so a CompressedMipmap can be written to a "texture
+// cache" file, which is memory-mapped when it's read back. The file is
+// a header of little-endian 32-bit words --
+//
+//   magic number, version, format, width, height, number of levels
+//
+// -- followed by the levels, largest first, with no padding.
+//
+{
+    struct Level {
+        int width, height;
+        const unsigned char *blocks; // (within `mapping` or `contents`)
+        size_t size;
+    };
+
+    CompressedMipmapFormat format_;
+    vector<Level> levels;
+
+    // the mapped file (or, if it was encoded or there's no mmap(), its
+    // contents)
+    unsigned char *mapping;
+    size_t mappingSize;
+    vector<unsigned char> contents;
+
+    CompressedMipmap(void);
+    const bool setLevels(const unsigned char *bytes, const size_t size);
+
+public:
+    static CompressedMipmap *encode(const Image *image);
+    static CompressedMipmap *read(const string &fname);
+    static CompressedMipmap *readCache(const string &cacheFname,
+                                       const string &sourceFname);
+    ~CompressedMipmap();
+
+    const unsigned char *blocks(const int iLevel) const
+    {
+        return levels[iLevel].blocks;
+    };
+    const CompressedMipmapFormat format(void) const
+    {
+        return format_;
+    };
+    const int height(const int iLevel) const
+    {
+        return levels[iLevel].height;
+    };
+    const int nLevels(void) const
+    {
+        return levels.size();
+    };
+    const size_t size(const int iLevel) const
+    {
+        return levels[iLevel].size;
+    };
+    const int width(const int iLevel) const
+    {
+        return levels[iLevel].width;
+    };
+    const bool write(const string &fname) const;
+};
+
+#define INCLUDED_COMPRESSED_MIPMAP
+#endif // INCLUDED_COMPRESSED_MIPMAP
@@ -38,6 +38,7 @@ enum {
     MENU_TOGGLE_FIRST_PERSON,
     MENU_TOGGLE_PERSPECTIVE,
     MENU_TOGGLE_TEXTURES,
+    MENU_CYCLE_TEXTURE_FILTER,
 };
 
 
@@ -92,6 +93,8 @@ void Controller::init()
                                              MENU_TOGGLE_STATS);
     framework.addMenuEntry("toggle [t]extures",
                                              MENU_TOGGLE_TEXTURES);
+    framework.addMenuEntry("cycle [T]exture filter",
+                                             MENU_CYCLE_TEXTURE_FILTER);
     framework.addMenuEntry("use [f]ace normals",
                                              MENU_USE_FACE_NORMALS);
     framework.addMenuEntry("use [v]ertex normals",
@@ -189,6 +192,10 @@ static void onKeyboardKey(unsigned char key, int, int)
         onMenuSelection(MENU_TOGGLE_TEXTURES);
         break;
 
+    case 'T':
+        onMenuSelection(MENU_CYCLE_TEXTURE_FILTER);
+        break;
+
     case 'v':
         onMenuSelection(MENU_USE_VERTEX_NORMALS);
         break;
@@ -379,6 +386,14 @@ static void onMenuSelection(int menuDescriptor)
         view.display();
         break;
 
+    case MENU_CYCLE_TEXTURE_FILTER:
+        controller.textureFilter = (TextureFilter)
+            ((controller.textureFilter + 1) % N_TEXTURE_FILTERS);
+        renderStats.resetTimeAveraging();
+        renderStats.reset();
+        view.display();
+        break;
+
     case MENU_TOGGLE_VIEW_HELP:
         controller.viewHelpEnabled = !controller.viewHelpEnabled;
         view.display();
@@ -6,6 +6,7 @@
 //
 
 #include "hedgehog.h"
+#include "texture.h"
 
 enum { LIGHT_HEDGEHOG_DISABLED = -1 };
 
@@ -27,6 +28,7 @@ public:
     bool normalHedgehogEnabled;
     bool specularReflectionEnabled;
     bool statsEnabled;
+    TextureFilter textureFilter;
     bool useFirstPerson;
     bool useGouraudShading;
     bool useOrthographic;
@@ -53,6 +55,7 @@ Controller()
     normalHedgehogEnabled(false),
     specularReflectionEnabled(true),
     statsEnabled(false),
+    textureFilter(TEXTURE_FILTER_ANISOTROPIC),
     useFirstPerson(false),
     useGouraudShading(false),
     useOrthographic(true),
@@ -87,6 +87,7 @@ void Ground::display(const Transform &viewProjectionTransform,
         scene->eadsShaderProgram->setWorldMatrix(worldTransform);
         scene->eadsShaderProgram->setNormalMatrix(
             worldTransform.getNormalTransform());
+        grassTexture->setFilter(controller.textureFilter);
         scene->eadsShaderProgram->setImageTexture(grassTexture);
         // We use textures for the ground based on the controller
         // selection.
@@ -111,8 +112,11 @@ Ground::Ground(const double extent)
     int nJ = 101;
     extent_ = extent;
 
-    // Read the texture image and set it for wrapping.
-    grassTexture = new Texture2D(Image::readRgb("grass.rgb"), true);
+    // Read the texture image and set it for wrapping. (It's repeated
+    // `extent_` times in each direction, so in the distance, it needs
+    // its mipmap.)
+    grassTexture = Texture2D::readRgb("grass.rgb", true,
+                                      controller.textureFilter);
     heightField = new HeightField(position, nI, nJ);
 }
 
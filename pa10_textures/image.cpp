@@ -7,224 +7,233 @@
 // Then it was converted to C++ and otherwise shamelessly hacked by
 // Bob Lewis for use as part of the "coaster" project.
 //
+// Now it decodes the whole file from memory, in parallel, instead of
+// seeking to and reading each row of each channel separately.
+//
 
+#include <algorithm>
 #include <cassert>
 #include <stdio.h> // for fopen()
+#include <cmath>
 #include <cstdlib>
 #include <cstring>
 
+#include <functional>
 #include <iostream>
+#include <thread>
+#include <vector>
 using namespace std;
 
 #include "image.h"
 #include "wrap_gl_inclusion.h"
 
-struct RgbImage {
-    unsigned short imagic;
-    unsigned short type;
-    unsigned short dim;
-    unsigned short sizeX, sizeY, sizeZ;
-    // The above entries are read directly from the file. Some of
-    // those below might be there as well, but if so they're not read.
-    unsigned long min, max;
-    unsigned long wasteBytes;
-    char name[80];
-    unsigned long colorMap;
-    // Below this point are entities definitely *not* in the file.
-    FILE *file;
-    unsigned char *tmp, *tmpR, *tmpG, *tmpB, *tmpA;
-    unsigned long rleEnd;
-    GLuint *rowStart;
-    GLint *rowSize;
+//
+// SGI image files are big-endian and begin with a 512-byte header. If
+// they're run-length encoded ("RLE"), a table of where each row (of
+// each channel) starts and another of how long it is follow the header.
+//
+enum {
+    RGB_MAGIC = 474,
+    RGB_HEADER_SIZE = 512,
+    RGB_RLE_STORAGE = 1,
 };
 
-static void swapShorts(unsigned short *array, long length)
+//
+// Each thread decoding an image gets at least this many rows (so small
+// images aren't worth starting threads for).
+//
+enum { MIN_RGB_ROWS_PER_THREAD = 64 };
+
+
+struct RgbFile
+//
+// the contents of an SGI image file, as decodeRgbRows() needs them
+//
 {
-    unsigned long b1, b2;
-    unsigned char *ptr;
-
-    ptr = (unsigned char *) array;
-    while (length--) {
-        b1 = *ptr++;
-        b2 = *ptr++;
-        *array++ = (unsigned short) ((b1 << 8) | (b2));
-    }
+    const unsigned char *bytes;
+    size_t size;
+    bool isRle;
+    int width, height, nChannels;
+};
+
+
+static const unsigned int bigEndian16(const unsigned char *bytes)
+{
+    return (bytes[0] << 8) | bytes[1];
 }
 
-static void swapGluints(GLuint *array, long length)
+
+static const unsigned int bigEndian32(const unsigned char *bytes)
 {
-    unsigned long b1, b2, b3, b4;
-    unsigned char *ptr;
-
-    ptr = (unsigned char *)array;
-    while (length--) {
-        b1 = *ptr++;
-        b2 = *ptr++;
-        b3 = *ptr++;
-        b4 = *ptr++;
-        *array++ = (b1 << 24) | (b2 << 16) | (b3 << 8) | (b4);
-    }
+    return (bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
 }
 
-static struct RgbImage *RgbImageOpen(const string fname)
+
+static const bool decodeRgbRow(const RgbFile &file, const int j, const int k,
+                               unsigned char *pixels)
+//
+// helper: decodes row `j` of channel `k` of `file` into every
+// `file.nChannels`-th byte of `pixels` (the row's interleaved pixels),
+// returning false if the file is corrupt
+//
 {
-    union {
-        int testWord;
-        char testByte[4];
-    } endianTest;
-    struct RgbImage *rgbImage;
-    GLenum swapFlag;
-
-    endianTest.testWord = 1;
-    if (endianTest.testByte[0] == 1) {
-        swapFlag = GL_TRUE;
-    } else {
-        swapFlag = GL_FALSE;
-    }
+    const size_t iRow = (size_t) k * file.height + j;
+    size_t start, length;
 
-    rgbImage = (struct RgbImage *) malloc(sizeof(struct RgbImage));
-    if (rgbImage == NULL) {
-        cerr << "Out of memory! -- exiting\n";
-        return NULL;
+    if (file.isRle) {
+        const unsigned char *tables = file.bytes + RGB_HEADER_SIZE;
+        const size_t tableSize = 4 * (size_t) file.height * file.nChannels;
+
+        start = bigEndian32(tables + 4 * iRow);
+        length = bigEndian32(tables + tableSize + 4 * iRow);
+    } else {
+        start = RGB_HEADER_SIZE + iRow * file.width;
+        length = file.width;
     }
-    if ((rgbImage->file = fopen(fname.c_str(), "rb")) == NULL) {
-        perror(fname.c_str());
-        return NULL;
+    // (This way, neither comparison can overflow.)
+    if (start > file.size || length > file.size - start)
+        return false;
+
+    const unsigned char *in = file.bytes + start;
+    const unsigned char *inEnd = in + length;
+    unsigned char *out = pixels + k;
+    const int nChannels = file.nChannels;
+
+    if (!file.isRle) {
+        for (int i = 0; i < file.width; i++, out += nChannels)
+            *out = in[i];
+        return true;
     }
 
     //
-    // Read the first 12 bytes of the file into an RgbImage struct.
+    // Each run starts with a count byte: if its high bit is set, the
+    // next (count & 0x7f) bytes are copied; otherwise, the next byte is
+    // repeated that many times. A count of 0 ends the row.
     //
-    fread(rgbImage, 1, 12, rgbImage->file);
-
-    if (swapFlag)
-        swapShorts(&rgbImage->imagic, 6);
-
-    rgbImage->tmp  = (unsigned char *) malloc(rgbImage->sizeX*256);
-    rgbImage->tmpR = (unsigned char *) malloc(rgbImage->sizeX*256);
-    rgbImage->tmpG = (unsigned char *) malloc(rgbImage->sizeX*256);
-    rgbImage->tmpB = (unsigned char *) malloc(rgbImage->sizeX*256);
-    if (rgbImage->sizeZ == 4)
-        rgbImage->tmpA = (unsigned char *) malloc(rgbImage->sizeX*256);
-    if (rgbImage->tmp == NULL || rgbImage->tmpR == NULL
-            || rgbImage->tmpG == NULL || rgbImage->tmpB == NULL) {
-        cerr << "Out of memory! -- exiting\n";
-        return NULL;
-    }
-
-    if ((rgbImage->type & 0xFF00) == 0x0100) {
-        int nBytesInRow = rgbImage->sizeY * rgbImage->sizeZ * sizeof(GLuint);
-        rgbImage->rowStart = (GLuint *) malloc(nBytesInRow);
-        rgbImage->rowSize = (GLint *) malloc(nBytesInRow);
-        if (rgbImage->rowStart == NULL || rgbImage->rowSize == NULL) {
-            cerr << "Out of memory! -- exiting\n";
-            return NULL;
-        }
-        rgbImage->rleEnd = 512 + (2 * nBytesInRow);
-        fseek(rgbImage->file, 512, SEEK_SET);
-        fread(rgbImage->rowStart, 1, nBytesInRow, rgbImage->file);
-        fread(rgbImage->rowSize, 1, nBytesInRow, rgbImage->file);
-        if (swapFlag) {
-            swapGluints(rgbImage->rowStart,
-                        (long) (nBytesInRow / sizeof(GLuint)));
-            swapGluints((GLuint *) rgbImage->rowSize,
-                        (long) (nBytesInRow / sizeof(GLint)));
+    int nRemaining = file.width;
+    while (in < inEnd) {
+        const unsigned char pixel = *in++;
+        const int count = pixel & 0x7f;
+
+        if (count == 0)
+            break;
+        if (count > nRemaining)
+            return false;
+        nRemaining -= count;
+        if (pixel & 0x80) {
+            if (inEnd - in < count)
+                return false;
+            for (int i = 0; i < count; i++, out += nChannels)
+                *out = *in++;
+        } else {
+            if (in == inEnd)
+                return false;
+            const unsigned char value = *in++;
+            for (int i = 0; i < count; i++, out += nChannels)
+                *out = value;
         }
     }
-    return rgbImage;
+    return nRemaining == 0;
 }
 
-static void RgbImageClose(struct RgbImage *rgbImage)
-{
-
-    fclose(rgbImage->file);
-    free(rgbImage->tmp);
-    free(rgbImage->tmpR);
-    free(rgbImage->tmpG);
-    free(rgbImage->tmpB);
-    if (rgbImage->sizeZ > 3)
-        free(rgbImage->tmpA);
-    free(rgbImage);
-}
 
-static void RgbImageGetRow(struct RgbImage *rgbImage, unsigned char *buf,
-                           int y, int z)
+static void decodeRgbRows(const RgbFile &file, const int jBegin,
+                          const int jEnd, unsigned char *data,
+                          char *isCorrupt)
+//
+// helper: decodes rows [`jBegin`, `jEnd`) of all channels of `file` into
+// interleaved `data` (the whole image), setting `*isCorrupt` if any of
+// them are
+//
 {
-    unsigned char *iPtr, *oPtr, pixel;
-    int count, done = 0;
-
-    if ((rgbImage->type & 0xFF00) == 0x0100) {
-        fseek(rgbImage->file,
-              (long) rgbImage->rowStart[y+z*rgbImage->sizeY], SEEK_SET);
-        fread(rgbImage->tmp, 1,
-              (unsigned int)rgbImage->rowSize[y+z*rgbImage->sizeY],
-              rgbImage->file);
-
-        iPtr = rgbImage->tmp;
-        oPtr = buf;
-        while (!done) {
-            pixel = *iPtr++;
-            count = (int)(pixel & 0x7F);
-            if (!count) {
-                done = 1;
+    const size_t rowSize = (size_t) file.width * file.nChannels;
+
+    for (int j = jBegin; j < jEnd; j++)
+        for (int k = 0; k < file.nChannels; k++)
+            if (!decodeRgbRow(file, j, k, data + j * rowSize)) {
+                *isCorrupt = true;
                 return;
             }
-            if (pixel & 0x80) {
-                while (count--)
-                    *oPtr++ = *iPtr++;
-            } else {
-                pixel = *iPtr++;
-                while (count--) {
-                    *oPtr++ = pixel;
-                }
-            }
-        }
-    } else {
-        fseek(rgbImage->file,
-              512 + (y*rgbImage->sizeX) + (z*rgbImage->sizeX*rgbImage->sizeY),
-              SEEK_SET);
-        fread(buf, 1, rgbImage->sizeX, rgbImage->file);
-    }
 }
 
 
-static void RgbImageGetData(struct RgbImage *rgbImage, unsigned char **data)
+static Image *decodeRgb(const unsigned char *bytes, const size_t size,
+                        string &error)
+//
+// helper: decodes the `size` bytes of an SGI image file at `bytes` into
+// a new Image, or returns NULL and sets `error` if it can't
+//
+// The rows are decoded in parallel, directly from `bytes`.
+//
 {
-    unsigned char *ptr;
-    int i, j;
-    int nBytes = 4 * (rgbImage->sizeX+1) * (rgbImage->sizeY+1);
+    if (size < RGB_HEADER_SIZE || bigEndian16(bytes) != RGB_MAGIC) {
+        error = "not an SGI image file";
+        return NULL;
+    }
 
-    (*data) = (unsigned char *) malloc(nBytes);
-    if ((*data) == NULL) {
-        cerr << "Out of memory! -- exiting\n";
-        exit(EXIT_FAILURE);
+    RgbFile file;
+    file.bytes = bytes;
+    file.size = size;
+    file.isRle = (bytes[2] == RGB_RLE_STORAGE);
+    file.width = bigEndian16(bytes + 6);
+    file.height = bigEndian16(bytes + 8);
+    file.nChannels = bigEndian16(bytes + 10);
+
+    if (bytes[3] != 1) {
+        error = "only 1-byte-per-channel images are implemented";
+        return NULL;
+    }
+    if (file.nChannels != 3 && file.nChannels != 4) {
+        error = "only 3- and 4-channel images are implemented";
+        return NULL;
+    }
+    if (file.width == 0 || file.height == 0) {
+        error = "image is empty";
+        return NULL;
+    }
+    if (file.isRle && (size - RGB_HEADER_SIZE) / 8
+            < (size_t) file.height * file.nChannels) {
+        error = "file is too short for its row tables";
+        return NULL;
     }
 
-    ptr = *data;
-    for (i = 0; i < (int)(rgbImage->sizeY); i++) {
-        RgbImageGetRow(rgbImage, rgbImage->tmpR, i, 0);
-        RgbImageGetRow(rgbImage, rgbImage->tmpG, i, 1);
-        RgbImageGetRow(rgbImage, rgbImage->tmpB, i, 2);
-        if (rgbImage->sizeZ > 3) {
-            RgbImageGetRow(rgbImage, rgbImage->tmpA, i, 3);
-        }
-        for (j = 0; j < (int)(rgbImage->sizeX); j++) {
-            *ptr++ = *(rgbImage->tmpR + j);
-            *ptr++ = *(rgbImage->tmpG + j);
-            *ptr++ = *(rgbImage->tmpB + j);
-            if (rgbImage->sizeZ > 3) {
-                *ptr++ = *(rgbImage->tmpA + j);
-            }
-        }
+    Image *image = new Image;
+    image->width = file.width;
+    image->height = file.height;
+    image->nBytesPerPixel = file.nChannels;
+    image->format = (file.nChannels == 4) ? GL_RGBA : GL_RGB;
+    image->data = new unsigned char[
+        (size_t) file.width * file.height * file.nChannels];
+
+    int nThreads = min((int) thread::hardware_concurrency(),
+                       file.height / MIN_RGB_ROWS_PER_THREAD);
+    nThreads = max(nThreads, 1);
+    vector<char> isCorrupt(nThreads, false);
+    vector<thread> threads;
+
+    for (int t = 1; t < nThreads; t++)
+        threads.push_back(thread(decodeRgbRows, cref(file),
+                                 t * file.height / nThreads,
+                                 (t + 1) * file.height / nThreads,
+                                 image->data, &isCorrupt[t]));
+    decodeRgbRows(file, 0, file.height / nThreads, image->data,
+                  &isCorrupt[0]); // (on this thread)
+    for (unsigned int t = 0; t < threads.size(); t++)
+        threads[t].join();
+
+    if (find(isCorrupt.begin(), isCorrupt.end(), true) != isCorrupt.end()) {
+        error = "file is corrupt (a row is outside the file or the image)";
+        delete image;
+        return NULL;
     }
-    assert(ptr - (*data) <= nBytes);
+    return image;
 }
 
 
 Image::~Image(void)
 {
     if (data)
-        delete data;
+        delete[] data;
 }
 
 
@@ -284,6 +293,93 @@ Image *Image::getSkyBoxFaceImage(unsigned int iFace,
 }
 
 
+static const double srgbToLinear(const unsigned char c)
+//
+// helper: returns the linear intensity of the sRGB-encoded component `c`
+//
+{
+    static double linears[256];
+    static bool isInitialized = false;
+
+    if (!isInitialized) {
+        for (int i = 0; i < 256; i++) {
+            double s = i / 255.0;
+            linears[i] = (s <= 0.04045)
+                ? s / 12.92 : pow((s + 0.055) / 1.055, 2.4);
+        }
+        isInitialized = true;
+    }
+    return linears[c];
+}
+
+
+static const unsigned char linearToSrgb(const double linear)
+//
+// helper: returns the (rounded) sRGB encoding of `linear` intensity
+//
+{
+    double s = (linear <= 0.0031308)
+        ? 12.92 * linear : 1.055 * pow(linear, 1 / 2.4) - 0.055;
+    return (unsigned char) (255.0 * s + 0.5);
+}
+
+
+Image *Image::halved(void) const
+//
+// returns the next (half-size) level of this image's mipmap
+//
+// Each pixel is the average of a 2 x 2 block of this image's pixels (a
+// box filter). Color components are averaged as linear intensities, not
+// as their sRGB encodings, or distant textures would look too dark.
+// Alpha is already linear. Where this image has an odd number of
+// columns or rows, the last one is left out.
+//
+{
+    Image *image = new Image;
+    image->width = max(width / 2, 1);
+    image->height = max(height / 2, 1);
+    image->nBytesPerPixel = nBytesPerPixel;
+    image->format = format;
+
+    int nBytes = image->nBytesPerPixel * image->width * image->height;
+    image->data = new unsigned char[nBytes];
+    unsigned char *newPixel = image->data;
+    for (int i = 0; i < image->height; i++) {
+        // (A 1-pixel wide or high image is averaged with itself.)
+        int iOld0 = min(2 * i, height - 1);
+        int iOld1 = min(2 * i + 1, height - 1);
+
+        for (int j = 0; j < image->width; j++) {
+            int jOld0 = min(2 * j, width - 1);
+            int jOld1 = min(2 * j + 1, width - 1);
+            const unsigned char *oldPixels[] = {
+                &data[nBytesPerPixel * (width * iOld0 + jOld0)],
+                &data[nBytesPerPixel * (width * iOld0 + jOld1)],
+                &data[nBytesPerPixel * (width * iOld1 + jOld0)],
+                &data[nBytesPerPixel * (width * iOld1 + jOld1)],
+            };
+
+            for (int k = 0; k < nBytesPerPixel; k++) {
+                double sum = 0.0;
+
+                if (k < 3) {
+                    for (int l = 0; l < 4; l++)
+                        sum += srgbToLinear(oldPixels[l][k]);
+                    *newPixel++ = linearToSrgb(sum / 4);
+                } else {
+                    for (int l = 0; l < 4; l++)
+                        sum += oldPixels[l][k];
+                    *newPixel++ = (unsigned char) (sum / 4 + 0.5);
+                }
+            }
+        }
+    }
+    assert(newPixel - image->data == nBytes); // sanity check
+
+    return image;
+}
+
+
 void Image::warp(const int warpTransform[2][3])
 {
     int nBytes = nBytesPerPixel * width * height;
@@ -303,7 +399,7 @@ void Image::warp(const int warpTransform[2][3])
             newData[ijNew+2] = data[ijOld+2];
         }
     }
-    delete data;
+    delete[] data;
     data = newData;
 }
 
@@ -312,30 +408,281 @@ Image *Image::readRgb(const string fname)
 //
 // reads an SGI .rgb file into an Image
 //
+// The file is read all at once and decoded in memory.
+//
 {
-    Image *image = new Image;
-    struct RgbImage *rgbImage;
-
-    rgbImage = RgbImageOpen(fname);
-    if (!rgbImage) {
+    FILE *file = fopen(fname.c_str(), "rb");
+    if (file == NULL) {
+        perror(fname.c_str());
         cerr << "File not found -- exiting\n";
         exit(EXIT_FAILURE);
     }
-    image->width = rgbImage->sizeX;
-    image->height = rgbImage->sizeY;
-    image->nBytesPerPixel = rgbImage->sizeZ;
-    RgbImageGetData(rgbImage, &image->data);
-    RgbImageClose(rgbImage);
-
-    if (image->nBytesPerPixel == 3)
-        image->format = GL_RGB;
-    else if (image->nBytesPerPixel == 4)
-        image->format = GL_RGBA;
-    else {
-        // not implemented
-        cerr << "Error in LoadRGBImage " << image->nBytesPerPixel
-             << "-component images not implemented" << endl;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    vector<unsigned char> bytes(max(size, 0L));
+    if (size < 0 || fread(bytes.data(), 1, size, file) != (size_t) size) {
+        cerr << "Unable to read \"" << fname << "\" -- exiting\n";
         exit(EXIT_FAILURE);
     }
+    fclose(file);
+
+    string error;
+    Image *image = decodeRgb(bytes.data(), bytes.size(), error);
+    if (!image) {
+        cerr << "Error reading \"" << fname << "\": " << error
+             << " -- exiting" << endl;
+        exit(EXIT_FAILURE);
+    }
+    return image;
+}
+
+
+#ifdef TEST
+//
+// checks the decoding of SGI image files (valid and corrupt) and the
+// mipmap reduction of a few small images
+//
+#include <cstdio>
+
+static Image *newImage(const int width, const int height,
+                       const int nBytesPerPixel, const unsigned char *data)
+{
+    Image *image = new Image;
+    image->width = width;
+    image->height = height;
+    image->nBytesPerPixel = nBytesPerPixel;
+    image->format = (nBytesPerPixel == 4) ? GL_RGBA : GL_RGB;
+    image->data = new unsigned char[width * height * nBytesPerPixel];
+    memcpy(image->data, data, width * height * nBytesPerPixel);
     return image;
 }
+
+
+static int check(const string &name, const Image *image,
+                 const int width, const int height,
+                 const unsigned char *expected)
+//
+// returns 1 (after reporting it) if `image` isn't `width` x `height`
+// with pixels `expected` (within 1), and 0 otherwise
+//
+{
+    bool isOk = (image->width == width && image->height == height);
+    for (int i = 0; isOk && i < width * height * image->nBytesPerPixel; i++)
+        isOk = (abs(image->data[i] - expected[i]) <= 1);
+    printf("%-32s %s\n", name.c_str(), isOk ? "ok" : "FAILED");
+    return !isOk;
+}
+
+
+static const unsigned char testPixel(const int i, const int j, const int k)
+//
+// component `k` of pixel (`i`, `j`) of the test SGI files: runs of
+// repeated values on even rows and distinct ones on odd rows
+//
+{
+    return (j % 2 == 0) ? (i / 3 + 5 * j + 50 * k) : (7 * i + j + k);
+}
+
+
+static void putBigEndian(vector<unsigned char> &bytes, const size_t offset,
+                         const unsigned int value, const int nBytes)
+{
+    for (int b = 0; b < nBytes; b++)
+        bytes[offset + b] = (value >> (8 * (nBytes - 1 - b))) & 0xff;
+}
+
+
+static const vector<unsigned char> rgbFile(const int width,
+                                           const int height,
+                                           const int nChannels,
+                                           const bool isRle)
+//
+// returns an SGI image file of testPixel()s
+//
+{
+    vector<unsigned char> bytes(RGB_HEADER_SIZE, 0);
+    putBigEndian(bytes, 0, RGB_MAGIC, 2);
+    bytes[2] = isRle ? RGB_RLE_STORAGE : 0;
+    bytes[3] = 1;
+    putBigEndian(bytes, 4, 3, 2);
+    putBigEndian(bytes, 6, width, 2);
+    putBigEndian(bytes, 8, height, 2);
+    putBigEndian(bytes, 10, nChannels, 2);
+
+    const size_t tableSize = 4 * height * nChannels;
+    if (isRle)
+        bytes.resize(RGB_HEADER_SIZE + 2 * tableSize);
+    for (int k = 0; k < nChannels; k++) {
+        for (int j = 0; j < height; j++) {
+            size_t start = bytes.size();
+
+            for (int i = 0; i < width; ) {
+                if (!isRle) {
+                    bytes.push_back(testPixel(i++, j, k));
+                    continue;
+                }
+                // Encode repeated values as runs and others literally.
+                int count = 1;
+                while (i + count < width && count < 0x7f
+                       && testPixel(i + count, j, k) == testPixel(i, j, k))
+                    count++;
+                if (count > 1) {
+                    bytes.push_back(count);
+                    bytes.push_back(testPixel(i, j, k));
+                } else {
+                    bytes.push_back(0x80 | 1);
+                    bytes.push_back(testPixel(i, j, k));
+                }
+                i += count;
+            }
+            if (isRle) {
+                bytes.push_back(0); // end of row
+                size_t iRow = (size_t) k * height + j;
+                putBigEndian(bytes, RGB_HEADER_SIZE + 4 * iRow, start, 4);
+                putBigEndian(bytes, RGB_HEADER_SIZE + tableSize + 4 * iRow,
+                             bytes.size() - start, 4);
+            }
+        }
+    }
+    return bytes;
+}
+
+
+static int checkDecoding(const string &name,
+                         const vector<unsigned char> &bytes,
+                         const int width, const int height,
+                         const int nChannels)
+//
+// returns 1 (after reporting it) if `bytes` doesn't decode to `width` x
+// `height` testPixel()s with `nChannels` channels (or, if `width` is 0,
+// if it doesn't fail to decode), and 0 otherwise
+//
+{
+    string error;
+    Image *image = decodeRgb(&bytes[0], bytes.size(), error);
+    bool isOk;
+
+    if (width == 0)
+        isOk = (image == NULL);
+    else {
+        isOk = (image != NULL && image->width == width
+                && image->height == height
+                && image->nBytesPerPixel == nChannels);
+        for (int j = 0; isOk && j < height; j++)
+            for (int i = 0; isOk && i < width; i++)
+                for (int k = 0; isOk && k < nChannels; k++)
+                    isOk = (image->data[(j * width + i) * nChannels + k]
+                            == testPixel(i, j, k));
+    }
+    printf("%-32s %s%s%s\n", name.c_str(), isOk ? "ok" : "FAILED",
+           error.empty() ? "" : " -- ", error.c_str());
+    delete image;
+    return !isOk;
+}
+
+
+int main(int argc, char **argv)
+{
+    int nFailures = 0;
+
+    nFailures += checkDecoding("verbatim RGB",
+                               rgbFile(9, 4, 3, false), 9, 4, 3);
+    // (This one has enough rows to be decoded in parallel.)
+    nFailures += checkDecoding("RLE RGBA",
+                               rgbFile(300, 200, 4, true), 300, 200, 4);
+
+    // These must be rejected.
+    vector<unsigned char> bytes = rgbFile(9, 4, 3, true);
+    bytes[0] = 0;
+    nFailures += checkDecoding("bad magic number", bytes, 0, 0, 0);
+
+    bytes = rgbFile(9, 4, 2, false);
+    nFailures += checkDecoding("2 channels", bytes, 0, 0, 0);
+
+    bytes = rgbFile(9, 4, 3, false);
+    bytes.resize(bytes.size() - 1);
+    nFailures += checkDecoding("truncated verbatim", bytes, 0, 0, 0);
+
+    bytes = rgbFile(9, 100, 3, true);
+    bytes.resize(RGB_HEADER_SIZE + 4 * 100 * 3);
+    nFailures += checkDecoding("truncated RLE tables", bytes, 0, 0, 0);
+
+    bytes = rgbFile(9, 4, 3, true);
+    putBigEndian(bytes, RGB_HEADER_SIZE + 4 * 5, bytes.size() - 2, 4);
+    nFailures += checkDecoding("row start past the end", bytes, 0, 0, 0);
+
+    bytes = rgbFile(9, 4, 3, true);
+    putBigEndian(bytes, RGB_HEADER_SIZE + 4 * 12, 0xfffffff0, 4);
+    nFailures += checkDecoding("huge row size", bytes, 0, 0, 0);
+
+    bytes = rgbFile(9, 4, 3, true);
+    bytes[RGB_HEADER_SIZE + 2 * 4 * 12] = 10; // (a run of 10 > width)
+    nFailures += checkDecoding("run past the row", bytes, 0, 0, 0);
+
+    bytes = rgbFile(9, 4, 3, true);
+    bytes[RGB_HEADER_SIZE + 2 * 4 * 12] = 0; // (an empty row)
+    nFailures += checkDecoding("short row", bytes, 0, 0, 0);
+
+    //
+    // Half black and half white is half as intense as white, which
+    // sRGB encodes as 188, not 128.
+    //
+    const unsigned char checker[] = {
+        0, 0, 0,       255, 255, 255,
+        255, 255, 255, 0, 0, 0,
+    };
+    const unsigned char gray[] = { 188, 188, 188 };
+    Image *image = newImage(2, 2, 3, checker);
+    Image *halved = image->halved();
+    nFailures += check("checkerboard is gamma-correct", halved, 1, 1, gray);
+    delete halved;
+    delete image;
+
+    // Alpha is linear.
+    const unsigned char rgba[] = {
+        10, 20, 30, 0,     10, 20, 30, 255,
+        10, 20, 30, 100,   10, 20, 30, 101,
+    };
+    const unsigned char rgbaHalved[] = { 10, 20, 30, 114 };
+    image = newImage(2, 2, 4, rgba);
+    halved = image->halved();
+    nFailures += check("RGBA (linear alpha)", halved, 1, 1, rgbaHalved);
+    delete halved;
+    delete image;
+
+    // An odd column is left out, and a single row averages with itself.
+    const unsigned char row[] = {
+        50, 50, 50,   50, 50, 50,   200, 200, 200,
+    };
+    const unsigned char rowHalved[] = { 50, 50, 50 };
+    image = newImage(3, 1, 3, row);
+    halved = image->halved();
+    nFailures += check("3 x 1 -> 1 x 1", halved, 1, 1, rowHalved);
+    delete halved;
+    delete image;
+
+    // A chain reaches 1 x 1 in log2(size) + 1 levels.
+    unsigned char *data = new unsigned char[8 * 2 * 3];
+    for (int i = 0; i < 8 * 2 * 3; i++)
+        data[i] = 77;
+    image = newImage(8, 2, 3, data);
+    int nLevels = 1;
+    while (image->width > 1 || image->height > 1) {
+        halved = image->halved();
+        delete image;
+        image = halved;
+        nLevels++;
+    }
+    nFailures += check("8 x 2 chain is uniform", image, 1, 1, data);
+    if (nLevels != 4) {
+        printf("8 x 2 chain has %d levels, not 4 FAILED\n", nLevels);
+        nFailures++;
+    }
+    delete image;
+    delete[] data;
+
+    return nFailures;
+}
+#endif // TEST
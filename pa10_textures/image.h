@@ -30,6 +30,7 @@ Image(void)
     ~Image(void);
 
     Image *getSkyBoxFaceImage(unsigned int i0, unsigned int j0) const;
+    Image *halved(void) const;
     static Image *readRgb(const string fname);
     void warp(const int warpTransform[2][3]);
 };
@@ -1,5 +1,7 @@
+#include <cstdio>
 #include <string>
 
+#include "compressed_mipmap.h"
 #include "geometry.h"
 #include "ground.h"
 #include "n_elem.h"
@@ -10,10 +12,10 @@
 #include "wall.h"
 
 
-SkyBox::SkyBox(const double extent, const string skyBoxFname)
+SkyBox::SkyBox(const double extent, const string skyBoxFname_)
+    : skyBoxFname(skyBoxFname_), skyBoxImage(NULL)
 {
     texturedShaderProgram = new TexturedShaderProgram();
-    skyBoxImage = Image::readRgb(skyBoxFname);
     extent_ = extent;
     addWalls();
 }
@@ -47,18 +49,58 @@ void SkyBox::addWalls(void)
     };
 
     for (unsigned int i = 0; i < N_ELEM(wallSpecs); i++) {
-        const Image *wallImage = skyBoxImage->getSkyBoxFaceImage(
+        Texture2D *wallTexture = readFaceTexture(
             wallSpecs[i].iFace, wallSpecs[i].jFace);
-        Wall *wall = new Wall(wallImage,
+        Wall *wall = new Wall(wallTexture,
                 wallSpecs[i].pLL, wallSpecs[i].pLR, wallSpecs[i].pUL,
                 2, 2, texturedShaderProgram);
         walls.push_back(wall);
-        // TBD: delete "wallImage"
     }
     // TBD: delete "image"
 }
 
 
+Texture2D *SkyBox::readFaceTexture(const int iFace, const int jFace)
+//
+// returns a new texture of face (`iFace`, `jFace`) of the sky box image
+//
+// As with Texture2D::readRgb(), the texture is compressed if the
+// hardware supports it, and each face has its own texture cache file.
+//
+{
+    // We turn off linear filtering for the walls, as that makes the
+    // black edges go away. TBD: Follow up on exactly why this is.
+    const TextureFilter filter = TEXTURE_FILTER_NEAREST;
+    const bool isCompressed = Texture2D::isCompressionSupported();
+    char faceSuffix[20];
+
+    sprintf(faceSuffix, ".%d%d", iFace, jFace);
+    const string cacheFname = skyBoxFname + faceSuffix + TEXTURE_CACHE_SUFFIX;
+    CompressedMipmap *mipmap = isCompressed
+        ? CompressedMipmap::readCache(cacheFname, skyBoxFname) : NULL;
+
+    if (!mipmap) {
+        if (!skyBoxImage)
+            skyBoxImage = Image::readRgb(skyBoxFname);
+        Image *faceImage = skyBoxImage->getSkyBoxFaceImage(iFace, jFace);
+
+        if (!isCompressed) {
+            Texture2D *texture = new Texture2D(faceImage, false, filter);
+
+            delete faceImage;
+            return texture;
+        }
+        mipmap = CompressedMipmap::encode(faceImage);
+        // (If the cache can't be written, the next run encodes it again.)
+        mipmap->write(cacheFname);
+        delete faceImage;
+    }
+    Texture2D *texture = new Texture2D(mipmap, false, filter);
+    delete mipmap;
+    return texture;
+}
+
+
 void SkyBox::display(const Transform &viewProjectionTransform,
                           Transform worldTransform)
 {
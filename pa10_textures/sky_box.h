@@ -31,12 +31,15 @@ private:
     double extent_;
 
     vector<Wall *> walls;
+    string skyBoxFname;
 
     void addWalls(void);
+    Texture2D *readFaceTexture(const int iFace, const int jFace);
 
 public:
     // This is the image used for wall textures. Each of the five
-    // walls uses a different part of it.
+    // walls uses a different part of it. (It's only read if some
+    // wall's texture isn't cached, so it may be NULL.)
     const Image *skyBoxImage;
 
     SkyBox(const double extent, const string skyBoxFname);
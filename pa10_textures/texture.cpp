@@ -1,9 +1,12 @@
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 #include <string>
 #include <iostream>
 using namespace std;
 
 #include "check_gl.h"
+#include "compressed_mipmap.h"
 #include "image.h"
 #include "n_elem.h"
 #include "controller.h"
@@ -24,58 +27,170 @@ static bool isPowerOf2(unsigned int i)
 }
 
 
-Texture2D::Texture2D(const Image *image, bool wrap)
+static const bool hasExtension(const char *name)
+//
+// helper: returns true iff the OpenGL implementation has extension `name`
+//
+{
+    GLint nExtensions = 0;
+
+    CHECK_GL(glGetIntegerv(GL_NUM_EXTENSIONS, &nExtensions));
+    for (int i = 0; i < nExtensions; i++)
+        if (strcmp((const char *) glGetStringi(GL_EXTENSIONS, i), name) == 0)
+            return true;
+    return false;
+}
+
+
+static const float maxAnisotropy(void)
+//
+// returns the anisotropy TEXTURE_FILTER_ANISOTROPIC uses: the lesser of
+// TEXTURE_MAX_ANISOTROPY and the most the hardware supports (or 1.0,
+// meaning none, if it doesn't support anisotropic filtering at all)
+//
+{
+    static float anisotropy = 0.0; // (0.0 until it's been queried)
+
+    if (anisotropy == 0.0) {
+        anisotropy = 1.0;
+        if (hasExtension("GL_EXT_texture_filter_anisotropic")
+                || hasExtension("GL_ARB_texture_filter_anisotropic")) {
+            GLfloat hardwareMax;
+
+            CHECK_GL(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT,
+                                 &hardwareMax));
+            anisotropy = min(TEXTURE_MAX_ANISOTROPY, hardwareMax);
+        }
+    }
+    return anisotropy;
+}
+
+
+Texture2D::Texture2D(const Image *image, bool wrap, TextureFilter filter_)
+//
+// creates a texture of `image` and its mipmap
+//
+{
+    vector<const Image *> levels;
+
+    levels.push_back(image);
+    while (levels.back()->width > 1 || levels.back()->height > 1)
+        levels.push_back(levels.back()->halved());
+
+    filter = filter_;
+    define(levels, wrap);
+
+    for (unsigned int i = 1; i < levels.size(); i++) // (not `image`)
+        delete levels[i];
+}
+
+
+Texture2D::Texture2D(const vector<const Image *> &levels, bool wrap,
+                     TextureFilter filter_)
+//
+// creates a texture of a precomputed mipmap, `levels`, where each level
+// is half the size (rounded down, but at least 1) of the previous
+// one
+//
+// The mipmap may stop short of 1 x 1, in which case the texture uses
+// only the levels it has.
+//
+{
+    if (levels.empty()) {
+        cerr << "a mipmap needs at least one level -- exiting" << endl;
+        exit(EXIT_FAILURE);
+    }
+    for (unsigned int i = 1; i < levels.size(); i++) {
+        if (levels[i]->width != max(levels[i - 1]->width / 2, 1)
+                || levels[i]->height != max(levels[i - 1]->height / 2, 1)
+                || levels[i]->format != levels[0]->format) {
+            cerr << "mipmap level " << i << " (" << levels[i]->width
+                 << " x " << levels[i]->height << ") does not match level "
+                 << i - 1 << " (" << levels[i - 1]->width << " x "
+                 << levels[i - 1]->height << ") -- exiting" << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    filter = filter_;
+    define(levels, wrap);
+}
+
+
+Texture2D::Texture2D(const CompressedMipmap *mipmap, bool wrap,
+                     TextureFilter filter_)
+//
+// creates a (compressed) texture of `mipmap`, which the hardware must
+// support (see isCompressionSupported())
+//
+{
+    GLenum internalFormat = (mipmap->format() == COMPRESSED_MIPMAP_BC3)
+        ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+    filter = filter_;
+    create(wrap);
+    for (int i = 0; i < mipmap->nLevels(); i++)
+        CHECK_GL(glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat,
+                                        mipmap->width(i), mipmap->height(i),
+                                        0, mipmap->size(i),
+                                        mipmap->blocks(i)));
+    finish(mipmap->nLevels());
+}
+
+
+Texture2D *Texture2D::readRgb(const string &fname, bool wrap,
+                              TextureFilter filter_)
+//
+// returns a new texture of the SGI image file `fname`
+//
+// Where the hardware supports it, the texture is compressed. It's only
+// compressed once: the compressed mipmap is written to a texture cache
+// file (`fname` + TEXTURE_CACHE_SUFFIX), which later runs map instead
+// of reading `fname` (until `fname` changes).
+//
+{
+    if (!isCompressionSupported()) {
+        Image *image = Image::readRgb(fname);
+        Texture2D *texture = new Texture2D(image, wrap, filter_);
+
+        delete image;
+        return texture;
+    }
+
+    const string cacheFname = fname + TEXTURE_CACHE_SUFFIX;
+    CompressedMipmap *mipmap = CompressedMipmap::readCache(cacheFname, fname);
+    if (!mipmap) {
+        Image *image = Image::readRgb(fname);
+
+        mipmap = CompressedMipmap::encode(image);
+        // (If the cache can't be written, the next run encodes it again.)
+        mipmap->write(cacheFname);
+        delete image;
+    }
+    Texture2D *texture = new Texture2D(mipmap, wrap, filter_);
+    delete mipmap;
+    return texture;
+}
+
+
+const bool Texture2D::isCompressionSupported(void)
+//
+// returns true iff the hardware supports compressed (S3TC) textures
+//
+{
+    static int isSupported = -1; // (-1 until it's been queried)
+
+    if (isSupported == -1)
+        isSupported = hasExtension("GL_EXT_texture_compression_s3tc");
+    return isSupported;
+}
+
+
+void Texture2D::create(bool wrap)
+//
+// helper: creates the (empty) texture object and sets its wrapping
+//
 {
-  //
-  // ASSIGNMENT (PA10)
-  //
-  // Initialize a 2D texture (GL_TEXTURE_2D) using `image`.  These are
-  // the steps:
-  //
-  // - (optional) Check to make sure that the image's width and height
-  //   are powers of two. (For portability, but even when OpenGL permits
-  //   otherwise, it's more efficient.) Exit with an error message if
-  //   they are not.
-  //
-  // - Call glGenTextures() to get a (texture) `id` (which is an
-  //   attribute of Texture).  (Observe type conventions.)
-  //
-  // - Call glBindTexture() to make the `id` the current
-  //   `GL_TEXTURE_2D`.
-  //
-  // - Make calls to glTexParameteri() to set necessary texture
-  //   parameters, depending on `wrap`:
-  //
-  //   + If `wrap` is true, set s and t wrapping to repeat.
-  //
-  //   + If `wrap` is false, set s and t wrapping to clamp at the
-  //     edge (GL_CLAMP_TO_EDGE). (You might try GL_CLAMP to see the
-  //     difference.)
-  //
-  // - Call glTexParameteri() to set the "pixel area < texel" and "pixel
-  //   area > texel" filters to linearly interpolate pixels. If you know
-  //   what a mipmap is, don't worry: You don't need to use one.
-  //
-  // - Call `glTexImage2D()` to define the texture `GL_TEXTURE_2D` from
-  //   the image data. The parameters should be:
-  //
-  //   + a mipmap level of 0 (suitable when there's no mipmap)
-  //
-  //   + internal format should be GL_RGB8
-  //
-  //   + image width and height
-  //
-  //   + a border of 0 (for modern OpenGL this is *always* what you
-  //     want)
-  //
-  //   + a pixel data format of GL_RGB
-  //
-  //   + a pixel data type of GL_UNSIGNED_BYTE
-  //
-  //   + the image data itself
-  //
-  // You'll want to pay special attention to OpenGL man pages here.
-  //
   CHECK_GL(glGenTextures(1, &id));
   CHECK_GL(glBindTexture(GL_TEXTURE_2D, id));
 
@@ -87,17 +202,95 @@ Texture2D::Texture2D(const Image *image, bool wrap)
     CHECK_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
     CHECK_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
   }
+}
+
+
+void Texture2D::define(const vector<const Image *> &levels, bool wrap)
+//
+// helper: creates the texture from `levels` (its mipmap)
+//
+{
+  //
+  // The levels (8-bit RGB or RGBA, as each's `format` says) become
+  // the texture's mipmap levels, largest (level 0) first, keeping alpha
+  // if they have it (as a compressed texture does). finish() then
+  // limits it to those levels and sets its filter.
+  //
+  create(wrap);
+
+  // Rows of the smaller levels aren't multiples of 4 bytes long.
+  CHECK_GL(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+  for (unsigned int i = 0; i < levels.size(); i++)
+    CHECK_GL(glTexImage2D(GL_TEXTURE_2D,
+                                    i,
+                                    (levels[i]->nBytesPerPixel == 4)
+                                        ? GL_RGBA : GL_RGB,
+                                    levels[i]->width,
+                                    levels[i]->height,
+                                    0,
+                                    levels[i]->format,
+                                    GL_UNSIGNED_BYTE,
+                                    levels[i]->data));
+  CHECK_GL(glPixelStorei(GL_UNPACK_ALIGNMENT, 4)); // (the default)
+  finish(levels.size());
+}
+
+
+void Texture2D::finish(const int nLevels)
+//
+// helper: limits the (bound) texture to the `nLevels` levels it has and
+// sets its filters
+//
+{
+    CHECK_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                             nLevels - 1));
+
+    TextureFilter filter_ = filter;
+    filter = N_TEXTURE_FILTERS; // (so setFilter() doesn't skip it)
+    setFilter(filter_);
+}
+
+
+void Texture2D::setFilter(TextureFilter filter_)
+//
+// sets the texture's minification and magnification filters to those
+// `filter_` specifies
+//
+{
+    if (filter_ == filter)
+        return;
+    filter = filter_;
+
+    GLint minFilter, magFilter;
+    float anisotropy = 1.0; // (none)
+
+    switch (filter) {
+
+    case TEXTURE_FILTER_NEAREST:
+        minFilter = magFilter = GL_NEAREST;
+        break;
+
+    case TEXTURE_FILTER_BILINEAR:
+        minFilter = magFilter = GL_LINEAR;
+        break;
+
+    case TEXTURE_FILTER_TRILINEAR:
+        minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        magFilter = GL_LINEAR;
+        break;
+
+    case TEXTURE_FILTER_ANISOTROPIC:
+    default:
+        minFilter = GL_LINEAR_MIPMAP_LINEAR;
+        magFilter = GL_LINEAR;
+        anisotropy = maxAnisotropy();
+        break;
+    }
 
-  CHECK_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
-  CHECK_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
-
-  CHECK_GL(glTexImage2D(GL_TEXTURE_2D,
-                                  0,
-                                  GL_RGB,
-                                  image->width,
-                                  image->height,
-                                  0,
-                                  GL_RGB,
-                                  GL_UNSIGNED_BYTE,
-                                  image->data));
+    CHECK_GL(glBindTexture(GL_TEXTURE_2D, id));
+    CHECK_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
+    CHECK_GL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter));
+    if (maxAnisotropy() > 1.0)
+        CHECK_GL(glTexParameterf(GL_TEXTURE_2D,
+                                 GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy));
 }
@@ -6,20 +6,57 @@
 //
 
 #include <string>
+#include <vector>
 
+#include "compressed_mipmap.h"
 #include "image.h"
 #include "wrap_gl_inclusion.h" // for GLenum
 
 
+enum TextureFilter {
+    TEXTURE_FILTER_NEAREST, // nearest texel, no mipmap
+    TEXTURE_FILTER_BILINEAR, // interpolated texels, no mipmap
+    TEXTURE_FILTER_TRILINEAR, // interpolated texels and mipmap levels
+    TEXTURE_FILTER_ANISOTROPIC, // trilinear, sampled along the footprint
+    N_TEXTURE_FILTERS
+};
+
+//
+// TEXTURE_FILTER_ANISOTROPIC takes up to this many samples (or fewer,
+// if that's all the hardware supports) along the longer axis of a
+// pixel's footprint in the texture.
+//
+const float TEXTURE_MAX_ANISOTROPY = 8.0;
+
+
 class Texture2D
 //
 // a 2-dimensional image texture
 //
+// Unless it's created from a precomputed mipmap, a Texture2D makes its
+// own (see Image::halved()), so any TextureFilter may be used with it.
+// It may also be compressed (see CompressedMipmap), if the hardware
+// supports that.
+//
 {
+    TextureFilter filter;
+
+    void create(bool wrap);
+    void define(const vector<const Image *> &levels, bool wrap);
+    void finish(const int nLevels);
+
 public:
     unsigned int id;
 
-    Texture2D(const Image *image, bool wrap);
+    Texture2D(const Image *image, bool wrap, TextureFilter filter_);
+    Texture2D(const vector<const Image *> &levels, bool wrap,
+              TextureFilter filter_);
+    Texture2D(const CompressedMipmap *mipmap, bool wrap,
+              TextureFilter filter_);
+    static const bool isCompressionSupported(void);
+    static Texture2D *readRgb(const string &fname, bool wrap,
+                              TextureFilter filter_);
+    void setFilter(TextureFilter filter_);
     bool useTextureVertices(void) const { return true; };
 };
 
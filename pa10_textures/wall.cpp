@@ -6,18 +6,16 @@
 #include "wall.h"
 
 
-Wall::Wall(const Image *image,
+Wall::Wall(Texture2D *texture_,
            const Point3 &pLL, const Point3 &pLR, const Point3 &pUL,
            int nI, int nJ,
            TexturedShaderProgram *texturedShaderProgram_)
     : SceneObject(),
-      texturedShaderProgram(texturedShaderProgram_)
+      texturedShaderProgram(texturedShaderProgram_),
+      texture(texture_)
 {
-    rectangle = new Rectangle(image, pLL, pLR - pLL, pUL - pLL, nI, nJ);
-
-    // We turn off linear filtering for the walls, as that makes the
-    // black edges go away. TBD: Follow up on exactly why this is.
-    texture = new Texture2D(image, false);
+    // (Rectangle doesn't use its image.)
+    rectangle = new Rectangle(NULL, pLL, pLR - pLL, pUL - pLL, nI, nJ);
 }
 
 
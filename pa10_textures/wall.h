@@ -23,7 +23,7 @@ private:
     Texture2D *texture;
 
 public:
-    Wall(const Image *image,
+    Wall(Texture2D *texture_,
          const Point3 &pLL_, const Point3 &pLR_, const Point3 &pUL_,
          int nI, int nJ,
          TexturedShaderProgram *texturedShaderProgram_);